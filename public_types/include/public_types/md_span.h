@@ -0,0 +1,259 @@
+#ifndef PUBLIC_TYPES_MD_SPAN_H
+#define PUBLIC_TYPES_MD_SPAN_H
+
+#include <public_types/strided_span.h>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace qle {
+
+/**
+ * @brief Memory layout of a multi-dimensional view
+ */
+enum class Layout {
+  ROW_MAJOR,  ///< Last index is contiguous (C order)
+  COL_MAJOR,  ///< First index is contiguous (Fortran order)
+};
+
+/**
+ * @brief MdSpan is a non-owning multi-dimensional view, modelled after mdspan
+ *
+ * The view is described by a pointer, one extent per dimension and one stride
+ * per dimension, so that element (i0, i1, ...) lives at
+ * Data()[i0 * Stride(0) + i1 * Stride(1) + ...]. Slicing and sub-blocks only
+ * adjust the pointer, extents and strides; no element is copied. E.g. samples
+ * of 8 interleaved channels decoded into a flat buffer are an
+ * MdSpan<T, 2>(buffer, {samples, 8}), and col(c) is channel c.
+ *
+ * @tparam T
+ * @tparam Rank Number of dimensions
+ */
+template <typename T, std::size_t Rank>
+class MdSpan {
+  static_assert(Rank >= 1, "MdSpan needs at least one dimension");
+
+ public:
+  using Extents = std::array<std::size_t, Rank>;     ///< Extents type
+  using Strides = std::array<std::ptrdiff_t, Rank>;  ///< Strides type
+
+  /**
+   * @brief Construct an empty MdSpan object
+   */
+  MdSpan() noexcept : extents_{}, strides_{} {}
+
+  /**
+   * @brief Construct a new MdSpan object over a dense buffer
+   *
+   * @param ptr Data
+   * @param extents Extent of each dimension
+   * @param layout Memory layout
+   */
+  explicit MdSpan(T *ptr, const Extents &extents,
+                  Layout layout = Layout::ROW_MAJOR) noexcept
+      : data_(ptr), extents_(extents) {
+    std::ptrdiff_t stride{1};
+    for (std::size_t i = 0; i < Rank; i++) {
+      const std::size_t dim = (layout == Layout::ROW_MAJOR) ? Rank - 1 - i : i;
+      strides_[dim] = stride;
+      stride *= static_cast<std::ptrdiff_t>(extents_[dim]);
+    }
+  }
+
+  /**
+   * @brief Construct a new MdSpan object with explicit strides
+   *
+   * @param ptr Data
+   * @param extents Extent of each dimension
+   * @param strides Stride of each dimension, in elements
+   */
+  explicit MdSpan(T *ptr, const Extents &extents,
+                  const Strides &strides) noexcept
+      : data_(ptr), extents_(extents), strides_(strides) {}
+
+  /**
+   * @brief Element access
+   *
+   * @tparam Indices
+   * @param indices One index per dimension
+   * @return T&
+   */
+  template <typename... Indices>
+  T &operator()(Indices... indices) const noexcept {
+    static_assert(sizeof...(Indices) == Rank, "One index per dimension");
+    const std::size_t index[Rank] = {static_cast<std::size_t>(indices)...};
+    std::ptrdiff_t offset{0};
+    for (std::size_t dim = 0; dim < Rank; dim++) {
+      assert(index[dim] < extents_[dim]);
+      offset += static_cast<std::ptrdiff_t>(index[dim]) * strides_[dim];
+    }
+    return data_[offset];
+  }
+
+  /**
+   * @brief Get extent of dimension \p dim
+   *
+   * @param dim Dimension
+   * @return std::size_t
+   */
+  std::size_t Extent(std::size_t dim) const noexcept { return extents_[dim]; }
+
+  /**
+   * @brief Get stride of dimension \p dim, in elements
+   *
+   * @param dim Dimension
+   * @return std::ptrdiff_t
+   */
+  std::ptrdiff_t Stride(std::size_t dim) const noexcept {
+    return strides_[dim];
+  }
+
+  /**
+   * @brief Get total number of elements
+   *
+   * @return std::size_t
+   */
+  std::size_t Size() const noexcept {
+    std::size_t size{1};
+    for (auto extent : extents_) {
+      size *= extent;
+    }
+    return size;
+  }
+
+  /**
+   * @brief Get data
+   *
+   * @return T*
+   */
+  T *Data() const noexcept { return data_; }
+
+  /**
+   * @brief Fix dimension Dim at \p index and drop it
+   *
+   * E.g. slice<0>(i) of a 3-D view is the 2-D plane i.
+   *
+   * @tparam Dim Dimension to fix
+   * @param index Index in dimension Dim
+   * @return MdSpan<T, Rank - 1>
+   */
+  template <std::size_t Dim, std::size_t R = Rank,
+            typename = std::enable_if_t<(R >= 2)>>
+  MdSpan<T, Rank - 1> slice(std::size_t index) const noexcept {
+    static_assert(Dim < Rank, "Dimension out of range");
+    assert(index < extents_[Dim]);
+    std::array<std::size_t, Rank - 1> extents{};
+    std::array<std::ptrdiff_t, Rank - 1> strides{};
+    for (std::size_t dim = 0, out = 0; dim < Rank; dim++) {
+      if (dim != Dim) {
+        extents[out] = extents_[dim];
+        strides[out] = strides_[dim];
+        out++;
+      }
+    }
+    return MdSpan<T, Rank - 1>(
+        data_ + static_cast<std::ptrdiff_t>(index) * strides_[Dim], extents,
+        strides);
+  }
+
+  /**
+   * @brief Get the 1-D line along dimension Dim through \p origin
+   *
+   * The index of dimension Dim in \p origin is the start of the line.
+   *
+   * @tparam Dim Dimension the line runs along
+   * @param origin Index of the first element
+   * @return StridedSpan<T>
+   */
+  template <std::size_t Dim>
+  StridedSpan<T> line(const Extents &origin) const noexcept {
+    static_assert(Dim < Rank, "Dimension out of range");
+    std::ptrdiff_t offset{0};
+    for (std::size_t dim = 0; dim < Rank; dim++) {
+      assert(origin[dim] <= extents_[dim]);
+      offset += static_cast<std::ptrdiff_t>(origin[dim]) * strides_[dim];
+    }
+    return StridedSpan<T>(data_ + offset, extents_[Dim] - origin[Dim],
+                          strides_[Dim]);
+  }
+
+  /**
+   * @brief Get row \p index of a 2-D view
+   *
+   * @param index Row index
+   * @return StridedSpan<T>
+   */
+  template <std::size_t R = Rank, typename = std::enable_if_t<R == 2>>
+  StridedSpan<T> row(std::size_t index) const noexcept {
+    return line<1>({index, 0});
+  }
+
+  /**
+   * @brief Get column \p index of a 2-D view
+   *
+   * @param index Column index
+   * @return StridedSpan<T>
+   */
+  template <std::size_t R = Rank, typename = std::enable_if_t<R == 2>>
+  StridedSpan<T> col(std::size_t index) const noexcept {
+    return line<0>({0, index});
+  }
+
+  /**
+   * @brief Get the sub-block of \p extents elements starting at \p offsets
+   *
+   * @param offsets First index of each dimension
+   * @param extents Extent of each dimension
+   * @return MdSpan
+   */
+  MdSpan block(const Extents &offsets, const Extents &extents) const noexcept {
+    std::ptrdiff_t offset{0};
+    for (std::size_t dim = 0; dim < Rank; dim++) {
+      assert(offsets[dim] + extents[dim] <= extents_[dim]);
+      offset += static_cast<std::ptrdiff_t>(offsets[dim]) * strides_[dim];
+    }
+    return MdSpan(data_ + offset, extents, strides_);
+  }
+
+  /**
+   * @brief Call \p func on every element, last index varying fastest
+   *
+   * @tparam Func
+   * @param func Function taking T&
+   */
+  template <typename Func>
+  void for_each(Func &&func) const {
+    for_each_dim(data_, func, std::integral_constant<std::size_t, 0>{});
+  }
+
+ private:
+  /**
+   * @brief Visit dimension Dim, recursing into the next one
+   */
+  template <typename Func, std::size_t Dim>
+  void for_each_dim(T *base, Func &func,
+                    std::integral_constant<std::size_t, Dim>) const {
+    for (std::size_t i = 0; i < extents_[Dim]; i++) {
+      for_each_dim(base + static_cast<std::ptrdiff_t>(i) * strides_[Dim], func,
+                   std::integral_constant<std::size_t, Dim + 1>{});
+    }
+  }
+
+  /**
+   * @brief All dimensions fixed, visit the element
+   */
+  template <typename Func>
+  void for_each_dim(T *base, Func &func,
+                    std::integral_constant<std::size_t, Rank>) const {
+    func(*base);
+  }
+
+  T *data_{nullptr};  ///< Data
+  Extents extents_;   ///< Extent of each dimension
+  Strides strides_;   ///< Stride of each dimension, in elements
+};
+
+}  // namespace qle
+
+#endif  // PUBLIC_TYPES_MD_SPAN_H
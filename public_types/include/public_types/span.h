@@ -1,60 +1,177 @@
 #ifndef PUBLIC_TYPES_SPAN_H
 #define PUBLIC_TYPES_SPAN_H
 
+#include <cassert>
 #include <cstddef>
+#include <type_traits>
 
 namespace qle {
 
 /**
- * @brief Span library
+ * @brief Extent of a span whose size is only known at runtime
+ */
+static constexpr std::size_t cDynamicExtent{static_cast<std::size_t>(-1)};
+
+template <typename T, std::size_t Extent = cDynamicExtent>
+class Span;
+
+namespace detail {
+
+/**
+ * @brief Size storage of a span with compile-time extent
  *
- * @tparam T
+ * Empty, so a static-extent span is a single pointer.
+ *
+ * @tparam Extent
  */
-template <typename T>
-class Span {
+template <std::size_t Extent>
+class SpanExtent {
  public:
   /**
-   * @brief Construct a new Span object
+   * @brief Construct a new SpanExtent object
+   *
+   * @param count Size, must be equal to Extent
+   */
+  constexpr explicit SpanExtent(std::size_t count) noexcept {
+    assert(count == Extent);
+    (void)count;
+  }
+
+  /**
+   * @brief Get size
+   *
+   * @return std::size_t
+   */
+  constexpr std::size_t extent_size() const noexcept { return Extent; }
+};
+
+/**
+ * @brief Size storage of a span with runtime extent
+ */
+template <>
+class SpanExtent<cDynamicExtent> {
+ public:
+  /**
+   * @brief Construct a new SpanExtent object
    *
-   * @param ptr Data
    * @param count Size
    */
-  explicit Span(T *ptr, std::size_t count) : data(ptr), size(count) {}
+  constexpr explicit SpanExtent(std::size_t count) noexcept : size_(count) {}
+
+  /**
+   * @brief Get size
+   *
+   * @return std::size_t
+   */
+  constexpr std::size_t extent_size() const noexcept { return size_; }
+
+ protected:
+  std::size_t size_;  ///< Span size
+};
+
+/**
+ * @brief Extent of a subspan with compile-time offset and count
+ */
+template <std::size_t Extent, std::size_t Offset, std::size_t Count>
+struct SubspanExtent {
+  static constexpr std::size_t value =
+      (Count != cDynamicExtent)
+          ? Count
+          : ((Extent != cDynamicExtent) ? Extent - Offset : cDynamicExtent);
+};
+
+}  // namespace detail
+
+/**
+ * @brief Span library
+ *
+ * A non-owning view over a contiguous sequence, modelled after std::span.
+ * Span is trivially copyable and cheap to pass by value: a pointer and a size,
+ * or only a pointer when the extent is known at compile time. Slicing with
+ * compile-time arguments on a static-extent span is checked with
+ * static_assert; runtime slicing is checked with assert() in debug builds.
+ *
+ * @tparam T
+ * @tparam Extent Number of elements, or cDynamicExtent
+ */
+template <typename T, std::size_t Extent>
+class Span : private detail::SpanExtent<Extent> {
+  using ExtentBase = detail::SpanExtent<Extent>;
+
+ public:
+  using element_type = T;                          ///< Element type
+  using value_type = std::remove_cv_t<T>;          ///< Value type
+  using size_type = std::size_t;                   ///< Size type
+  using pointer = T *;                             ///< Pointer type
+  using reference = T &;                           ///< Reference type
+  using iterator = T *;                            ///< Iterator type
+  static constexpr std::size_t extent = Extent;    ///< Static extent
 
   /**
-   * @brief Default constructor deleted
+   * @brief Construct an empty Span object
+   *
+   * Only available for dynamic or zero extent.
    */
-  Span() = delete;
+  template <std::size_t E = Extent,
+            typename = std::enable_if_t<(E == cDynamicExtent) || (E == 0)>>
+  constexpr Span() noexcept : ExtentBase(0), data(nullptr) {}
 
   /**
-   * @brief Copy constructor deleted
+   * @brief Construct a new Span object
+   *
+   * @param ptr Data
+   * @param count Size
    */
-  Span(const Span &) = delete;
+  constexpr explicit Span(T *ptr, std::size_t count) noexcept
+      : ExtentBase(count), data(ptr) {}
 
   /**
-   * @brief Move constructor deleted
+   * @brief Construct a new Span object from an array
+   *
+   * @tparam N Array size
+   * @param arr Array
    */
-  Span(Span &&) = delete;
+  template <std::size_t N, typename = std::enable_if_t<
+                               (Extent == cDynamicExtent) || (N == Extent)>>
+  constexpr Span(T (&arr)[N]) noexcept  // NOLINT(runtime/explicit)
+      : ExtentBase(N), data(arr) {}
 
   /**
-   * @brief Copy assignment deleted
+   * @brief Construct a new Span object from another span
+   *
+   * Allows adding const and converting a static extent to a dynamic one.
+   *
+   * @tparam U Element type of other span
+   * @tparam N Extent of other span
+   * @param other Other span
    */
-  Span &operator=(const Span &) = delete;
+  template <typename U, std::size_t N,
+            typename = std::enable_if_t<
+                std::is_convertible<U (*)[], T (*)[]>::value &&
+                ((Extent == cDynamicExtent) || (N == Extent))>>
+  constexpr Span(const Span<U, N> &other) noexcept  // NOLINT
+      : ExtentBase(other.Size()), data(other.Data()) {}
 
   /**
-   * @brief Move assignment deleted
+   * @brief Default copy constructor
    */
-  Span &operator=(Span &&) = delete;
+  constexpr Span(const Span &) noexcept = default;
 
   /**
-   * @brief Destroy the Span object
+   * @brief Default copy assignment
    */
-  ~Span() { reset(); }
+  Span &operator=(const Span &) noexcept = default;
 
   /**
    * @brief Reset span object
+   *
+   * Only available for dynamic extent.
    */
-  void reset() { size = 0; }
+  template <std::size_t E = Extent,
+            typename = std::enable_if_t<E == cDynamicExtent>>
+  void reset() noexcept {
+    this->size_ = 0;
+  }
 
   /**
    * @brief Element access
@@ -62,7 +179,7 @@ class Span {
    * @param index Index
    * @return T&
    */
-  T &operator[](std::size_t index) const { return data[index]; }
+  constexpr T &operator[](std::size_t index) const { return data[index]; }
 
   /**
    * @brief Element access
@@ -70,34 +187,152 @@ class Span {
    * @param index Index
    * @return T&
    */
-  T &at(std::size_t index) const { return data[index]; }
+  constexpr T &at(std::size_t index) const { return data[index]; }
 
   /**
    * @brief Get span size
    *
    * @return std::size_t
    */
-  std::size_t Size() const { return size; }
+  constexpr std::size_t Size() const noexcept { return this->extent_size(); }
+
+  /**
+   * @brief Get span size in bytes
+   *
+   * @return std::size_t
+   */
+  constexpr std::size_t SizeBytes() const noexcept {
+    return Size() * sizeof(T);
+  }
+
+  /**
+   * @brief Check if span is empty
+   *
+   * @return true/false
+   */
+  constexpr bool Empty() const noexcept { return Size() == 0; }
 
   /**
    * @brief Get data
    *
    * @return T*
    */
-  T *Data() const { return data; }
+  constexpr T *Data() const noexcept { return data; }
 
- private:
   /**
-   * @brief Span data
+   * @brief Get iterator to the first element
+   *
+   * @return iterator
    */
-  T *data;
+  constexpr iterator begin() const noexcept { return data; }
+
+  /**
+   * @brief Get iterator past the last element
+   *
+   * @return iterator
+   */
+  constexpr iterator end() const noexcept { return data + Size(); }
+
+  /**
+   * @brief Get span over the first Count elements
+   *
+   * @tparam Count
+   * @return Span<T, Count>
+   */
+  template <std::size_t Count>
+  constexpr Span<T, Count> first() const {
+    static_assert((Extent == cDynamicExtent) || (Count <= Extent),
+                  "Count out of range");
+    assert(Count <= Size());
+    return Span<T, Count>(data, Count);
+  }
+
+  /**
+   * @brief Get span over the first \p count elements
+   *
+   * @param count Number of elements
+   * @return Span<T>
+   */
+  constexpr Span<T> first(std::size_t count) const {
+    assert(count <= Size());
+    return Span<T>(data, count);
+  }
+
+  /**
+   * @brief Get span over the last Count elements
+   *
+   * @tparam Count
+   * @return Span<T, Count>
+   */
+  template <std::size_t Count>
+  constexpr Span<T, Count> last() const {
+    static_assert((Extent == cDynamicExtent) || (Count <= Extent),
+                  "Count out of range");
+    assert(Count <= Size());
+    return Span<T, Count>(data + (Size() - Count), Count);
+  }
 
   /**
-   * @brief Span size
+   * @brief Get span over the last \p count elements
+   *
+   * @param count Number of elements
+   * @return Span<T>
+   */
+  constexpr Span<T> last(std::size_t count) const {
+    assert(count <= Size());
+    return Span<T>(data + (Size() - count), count);
+  }
+
+  /**
+   * @brief Get span over Count elements starting at Offset
+   *
+   * Count defaults to the rest of the span.
+   *
+   * @tparam Offset
+   * @tparam Count
+   * @return Span
    */
-  std::size_t size;
+  template <std::size_t Offset, std::size_t Count = cDynamicExtent>
+  constexpr Span<T, detail::SubspanExtent<Extent, Offset, Count>::value>
+  subspan() const {
+    static_assert((Extent == cDynamicExtent) || (Offset <= Extent),
+                  "Offset out of range");
+    static_assert((Extent == cDynamicExtent) || (Count == cDynamicExtent) ||
+                      (Count <= Extent - Offset),
+                  "Count out of range");
+    assert(Offset <= Size());
+    assert((Count == cDynamicExtent) || (Count <= Size() - Offset));
+    return Span<T, detail::SubspanExtent<Extent, Offset, Count>::value>(
+        data + Offset, (Count == cDynamicExtent) ? Size() - Offset : Count);
+  }
+
+  /**
+   * @brief Get span over \p count elements starting at \p offset
+   *
+   * \p count defaults to the rest of the span.
+   *
+   * @param offset Offset
+   * @param count Number of elements
+   * @return Span<T>
+   */
+  constexpr Span<T> subspan(std::size_t offset,
+                            std::size_t count = cDynamicExtent) const {
+    assert(offset <= Size());
+    assert((count == cDynamicExtent) || (count <= Size() - offset));
+    return Span<T>(data + offset,
+                   (count == cDynamicExtent) ? Size() - offset : count);
+  }
+
+ private:
+  /**
+   * @brief Span data
+   */
+  T *data;
 };
 
+template <typename T, std::size_t Extent>
+constexpr std::size_t Span<T, Extent>::extent;
+
 }  // namespace qle
 
 #endif  // PUBLIC_TYPES_SPAN_H
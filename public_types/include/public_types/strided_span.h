@@ -0,0 +1,296 @@
+#ifndef PUBLIC_TYPES_STRIDED_SPAN_H
+#define PUBLIC_TYPES_STRIDED_SPAN_H
+
+#include <public_types/span.h>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+namespace qle {
+
+/**
+ * @brief Iterator over elements separated by a fixed stride
+ *
+ * Holds the first element and an index rather than a pointer to the
+ * current element, so that the end iterator of a channel other than the
+ * last does not point outside the buffer.
+ *
+ * @tparam T
+ */
+template <typename T>
+class StridedIterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;  ///< Category
+  using value_type = std::remove_cv_t<T>;                      ///< Value type
+  using difference_type = std::ptrdiff_t;                      ///< Difference
+  using pointer = T *;                                         ///< Pointer
+  using reference = T &;                                       ///< Reference
+
+  /**
+   * @brief Construct a singular StridedIterator object
+   */
+  constexpr StridedIterator() noexcept = default;
+
+  /**
+   * @brief Construct a new StridedIterator object
+   *
+   * @param data First element of the view
+   * @param index Index of the current element
+   * @param stride Distance between elements, in elements
+   */
+  constexpr StridedIterator(T *data, std::ptrdiff_t index,
+                            std::ptrdiff_t stride) noexcept
+      : data_(data), index_(index), stride_(stride) {}
+
+  /// Dereference
+  constexpr T &operator*() const noexcept { return data_[index_ * stride_]; }
+  /// Member access
+  constexpr T *operator->() const noexcept {
+    return &data_[index_ * stride_];
+  }
+  /// Element access relative to the iterator
+  constexpr T &operator[](std::ptrdiff_t n) const noexcept {
+    return data_[(index_ + n) * stride_];
+  }
+
+  /// Pre-increment
+  StridedIterator &operator++() noexcept {
+    ++index_;
+    return *this;
+  }
+  /// Post-increment
+  StridedIterator operator++(int) noexcept {
+    StridedIterator tmp(*this);
+    ++index_;
+    return tmp;
+  }
+  /// Pre-decrement
+  StridedIterator &operator--() noexcept {
+    --index_;
+    return *this;
+  }
+  /// Post-decrement
+  StridedIterator operator--(int) noexcept {
+    StridedIterator tmp(*this);
+    --index_;
+    return tmp;
+  }
+  /// Advance by \p n elements
+  StridedIterator &operator+=(std::ptrdiff_t n) noexcept {
+    index_ += n;
+    return *this;
+  }
+  /// Go back by \p n elements
+  StridedIterator &operator-=(std::ptrdiff_t n) noexcept {
+    index_ -= n;
+    return *this;
+  }
+  /// Iterator \p n elements ahead
+  constexpr StridedIterator operator+(std::ptrdiff_t n) const noexcept {
+    return StridedIterator(data_, index_ + n, stride_);
+  }
+  /// Iterator \p n elements ahead of \p it
+  friend constexpr StridedIterator operator+(
+      std::ptrdiff_t n, const StridedIterator &it) noexcept {
+    return it + n;
+  }
+  /// Iterator \p n elements behind
+  constexpr StridedIterator operator-(std::ptrdiff_t n) const noexcept {
+    return StridedIterator(data_, index_ - n, stride_);
+  }
+  /// Distance in elements
+  constexpr std::ptrdiff_t operator-(const StridedIterator &other) const
+      noexcept {
+    return index_ - other.index_;
+  }
+
+  /// Equality
+  constexpr bool operator==(const StridedIterator &other) const noexcept {
+    return (data_ == other.data_) && (index_ == other.index_);
+  }
+  /// Inequality
+  constexpr bool operator!=(const StridedIterator &other) const noexcept {
+    return !(*this == other);
+  }
+  /// Ordering
+  constexpr bool operator<(const StridedIterator &other) const noexcept {
+    return index_ < other.index_;
+  }
+  /// Ordering
+  constexpr bool operator>(const StridedIterator &other) const noexcept {
+    return index_ > other.index_;
+  }
+  /// Ordering
+  constexpr bool operator<=(const StridedIterator &other) const noexcept {
+    return index_ <= other.index_;
+  }
+  /// Ordering
+  constexpr bool operator>=(const StridedIterator &other) const noexcept {
+    return index_ >= other.index_;
+  }
+
+ private:
+  T *data_{nullptr};          ///< First element of the view
+  std::ptrdiff_t index_{0};   ///< Index of the current element
+  std::ptrdiff_t stride_{1};  ///< Distance between elements
+};
+
+/**
+ * @brief StridedSpan is a non-owning view over equally spaced elements
+ *
+ * E.g. one channel of interleaved samples: element i lives at
+ * Data()[i * Stride()]. Like Span it is trivially copyable and indexing is
+ * plain pointer arithmetic.
+ *
+ * @tparam T
+ */
+template <typename T>
+class StridedSpan {
+ public:
+  using iterator = StridedIterator<T>;  ///< Iterator type
+
+  /**
+   * @brief Construct an empty StridedSpan object
+   */
+  constexpr StridedSpan() noexcept = default;
+
+  /**
+   * @brief Construct a new StridedSpan object
+   *
+   * @param ptr First element
+   * @param count Number of elements
+   * @param stride Distance between elements, in elements, not 0
+   */
+  constexpr explicit StridedSpan(T *ptr, std::size_t count,
+                                 std::ptrdiff_t stride) noexcept
+      : data_(ptr), size_(count), stride_(stride) {
+    assert(stride != 0);
+  }
+
+  /**
+   * @brief Construct a new StridedSpan object over a contiguous span
+   *
+   * @param span Span
+   */
+  template <std::size_t N>
+  constexpr StridedSpan(Span<T, N> span) noexcept  // NOLINT
+      : data_(span.Data()), size_(span.Size()), stride_(1) {}
+
+  /**
+   * @brief Element access
+   *
+   * @param index Index
+   * @return T&
+   */
+  constexpr T &operator[](std::size_t index) const noexcept {
+    return data_[static_cast<std::ptrdiff_t>(index) * stride_];
+  }
+
+  /**
+   * @brief Get number of elements
+   *
+   * @return std::size_t
+   */
+  constexpr std::size_t Size() const noexcept { return size_; }
+
+  /**
+   * @brief Get distance between elements, in elements
+   *
+   * @return std::ptrdiff_t
+   */
+  constexpr std::ptrdiff_t Stride() const noexcept { return stride_; }
+
+  /**
+   * @brief Get first element
+   *
+   * @return T*
+   */
+  constexpr T *Data() const noexcept { return data_; }
+
+  /**
+   * @brief Check if the view is empty
+   *
+   * @return true/false
+   */
+  constexpr bool Empty() const noexcept { return size_ == 0; }
+
+  /**
+   * @brief Check if elements are adjacent in memory
+   *
+   * @return true/false
+   */
+  constexpr bool IsContiguous() const noexcept {
+    return (stride_ == 1) || (size_ <= 1);
+  }
+
+  /**
+   * @brief Get iterator to the first element
+   *
+   * @return iterator
+   */
+  constexpr iterator begin() const noexcept {
+    return iterator(data_, 0, stride_);
+  }
+
+  /**
+   * @brief Get iterator past the last element
+   *
+   * @return iterator
+   */
+  constexpr iterator end() const noexcept {
+    return iterator(data_, static_cast<std::ptrdiff_t>(size_), stride_);
+  }
+
+  /**
+   * @brief Get view over \p count elements starting at \p offset
+   *
+   * @param offset Offset
+   * @param count Number of elements, defaults to the rest of the view
+   * @return StridedSpan
+   */
+  constexpr StridedSpan subspan(std::size_t offset,
+                                std::size_t count = cDynamicExtent) const {
+    assert(offset <= size_);
+    assert((count == cDynamicExtent) || (count <= size_ - offset));
+    // An empty tail keeps data_, as data_ + size_ * stride_ may lie past
+    // the end of the buffer
+    return StridedSpan(
+        (offset == size_)
+            ? data_
+            : data_ + static_cast<std::ptrdiff_t>(offset) * stride_,
+        (count == cDynamicExtent) ? size_ - offset : count, stride_);
+  }
+
+  /**
+   * @brief Get view over every \p step-th element
+   *
+   * @param step Step, greater than 0
+   * @return StridedSpan
+   */
+  constexpr StridedSpan every(std::size_t step) const {
+    assert(step > 0);
+    return StridedSpan(data_, (size_ + step - 1) / step,
+                       stride_ * static_cast<std::ptrdiff_t>(step));
+  }
+
+  /**
+   * @brief Get contiguous span over the elements
+   *
+   * Only valid if IsContiguous() is true.
+   *
+   * @return Span<T>
+   */
+  constexpr Span<T> contiguous() const {
+    assert(IsContiguous());
+    return Span<T>(data_, size_);
+  }
+
+ private:
+  T *data_{nullptr};          ///< First element
+  std::size_t size_{0};       ///< Number of elements
+  std::ptrdiff_t stride_{1};  ///< Distance between elements
+};
+
+}  // namespace qle
+
+#endif  // PUBLIC_TYPES_STRIDED_SPAN_H
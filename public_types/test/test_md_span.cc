@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <public_types/md_span.h>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+class TestMdSpan : public ::testing::Test {};
+
+TEST_F(TestMdSpan, TestRowMajor) {
+  // 3 rows x 4 columns
+  int buffer[12]{};
+  std::iota(std::begin(buffer), std::end(buffer), 0);
+  qle::MdSpan<int, 2> view(buffer, {3, 4});
+
+  ASSERT_EQ(view.Size(), 12U);
+  ASSERT_EQ(view.Extent(0), 3U);
+  ASSERT_EQ(view.Extent(1), 4U);
+  ASSERT_EQ(view.Stride(0), 4);
+  ASSERT_EQ(view.Stride(1), 1);
+  ASSERT_EQ(view(1, 2), 6);
+  ASSERT_EQ(&view(2, 3), &buffer[11]);
+
+  auto row = view.row(1);
+  ASSERT_EQ(row.Size(), 4U);
+  ASSERT_TRUE(row.IsContiguous());
+  ASSERT_EQ(row[0], 4);
+
+  auto col = view.col(2);
+  ASSERT_EQ(col.Size(), 3U);
+  ASSERT_EQ(col.Stride(), 4);
+  ASSERT_EQ(col[2], 10);
+}
+
+TEST_F(TestMdSpan, TestColMajor) {
+  int buffer[6]{0, 1, 2, 3, 4, 5};
+  qle::MdSpan<int, 2> view(buffer, {2, 3}, qle::Layout::COL_MAJOR);
+
+  ASSERT_EQ(view.Stride(0), 1);
+  ASSERT_EQ(view.Stride(1), 2);
+  ASSERT_EQ(view(1, 0), 1);
+  ASSERT_EQ(view(0, 1), 2);
+  ASSERT_EQ(view(1, 2), 5);
+}
+
+TEST_F(TestMdSpan, TestDeinterleave) {
+  // 8 interleaved channels x 16 samples, value = sample * 100 + channel
+  constexpr size_t cChannels{8};
+  constexpr size_t cSamples{16};
+  std::vector<int> decoded(cChannels * cSamples);
+  for (size_t s = 0; s < cSamples; s++) {
+    for (size_t c = 0; c < cChannels; c++) {
+      decoded[s * cChannels + c] = static_cast<int>(s * 100 + c);
+    }
+  }
+
+  qle::MdSpan<int, 2> frames(decoded.data(), {cSamples, cChannels});
+  for (size_t c = 0; c < cChannels; c++) {
+    auto channel = frames.col(c);
+    ASSERT_EQ(channel.Size(), cSamples);
+    size_t s = 0;
+    for (auto value : channel) {
+      ASSERT_EQ(value, static_cast<int>(s * 100 + c));
+      s++;
+    }
+  }
+}
+
+TEST_F(TestMdSpan, TestRank3) {
+  // 2 planes x 3 rows x 4 columns
+  int buffer[24]{};
+  std::iota(std::begin(buffer), std::end(buffer), 0);
+  qle::MdSpan<int, 3> cube(buffer, {2, 3, 4});
+  ASSERT_EQ(cube(1, 2, 3), 23);
+
+  auto plane = cube.slice<0>(1);
+  ASSERT_EQ(plane.Extent(0), 3U);
+  ASSERT_EQ(plane.Extent(1), 4U);
+  ASSERT_EQ(plane(0, 0), 12);
+
+  auto fixed_col = cube.slice<2>(3);
+  ASSERT_EQ(fixed_col.Extent(0), 2U);
+  ASSERT_EQ(fixed_col.Extent(1), 3U);
+  ASSERT_EQ(fixed_col(1, 1), 12 + 4 + 3);
+
+  auto depth = cube.line<0>({0, 1, 2});
+  ASSERT_EQ(depth.Size(), 2U);
+  ASSERT_EQ(depth[1], 12 + 4 + 2);
+}
+
+TEST_F(TestMdSpan, TestBlockAndForEach) {
+  int buffer[16]{};
+  std::iota(std::begin(buffer), std::end(buffer), 0);
+  qle::MdSpan<int, 2> view(buffer, {4, 4});
+
+  // Center 2x2 block: 5, 6, 9, 10
+  auto center = view.block({1, 1}, {2, 2});
+  ASSERT_EQ(center.Size(), 4U);
+  std::vector<int> visited;
+  center.for_each([&](int &value) { visited.push_back(value); });
+  ASSERT_EQ(visited, (std::vector<int>{5, 6, 9, 10}));
+
+  center.for_each([](int &value) { value = 0; });
+  ASSERT_EQ(buffer[5], 0);
+  ASSERT_EQ(buffer[10], 0);
+  ASSERT_EQ(buffer[4], 4);
+}
+
+}  // namespace
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <public_types/span.h>
+#include <type_traits>
 
 namespace {
 
@@ -66,4 +67,87 @@ TEST_F(TestSpan, TestVariousTypes) {
   test_span_type<double>();
 }
 
+TEST_F(TestSpan, TestValueSemantics) {
+  static_assert(std::is_trivially_copyable<qle::Span<uint8_t>>::value, "");
+  static_assert(std::is_trivially_copyable<qle::Span<uint8_t, 4>>::value, "");
+  static_assert(sizeof(qle::Span<uint8_t>) == 2 * sizeof(void *), "");
+  static_assert(sizeof(qle::Span<uint8_t, 4>) == sizeof(void *), "");
+
+  uint8_t buffer[4]{1, 2, 3, 4};
+  qle::Span<uint8_t> span(buffer);
+  qle::Span<uint8_t> copy = span;
+  ASSERT_EQ(copy.Data(), span.Data());
+  ASSERT_EQ(copy.Size(), span.Size());
+
+  // Static extent converts to dynamic extent and adds const
+  qle::Span<uint8_t, 4> fixed(buffer);
+  qle::Span<const uint8_t> view = fixed;
+  ASSERT_EQ(view.Size(), 4U);
+  ASSERT_EQ(view.Data(), buffer);
+
+  qle::Span<uint8_t> empty;
+  ASSERT_TRUE(empty.Empty());
+  ASSERT_EQ(empty.Data(), nullptr);
+}
+
+TEST_F(TestSpan, TestConstexpr) {
+  static constexpr int cValues[]{10, 20, 30, 40};
+  constexpr qle::Span<const int, 4> span(cValues);
+  static_assert(span.Size() == 4, "");
+  static_assert(span[1] == 20, "");
+  static_assert(span.SizeBytes() == sizeof(cValues), "");
+  static_assert(span.first<2>().Size() == 2, "");
+  static_assert(span.last<1>()[0] == 40, "");
+  static_assert(span.subspan<1, 2>()[1] == 30, "");
+  static_assert(decltype(span.subspan<1>())::extent == 3, "");
+  static_assert(decltype(span.subspan(1))::extent == qle::cDynamicExtent, "");
+}
+
+TEST_F(TestSpan, TestIterators) {
+  uint16_t buffer[5]{1, 2, 3, 4, 5};
+  qle::Span<uint16_t> span(buffer, 5);
+
+  uint32_t sum{0};
+  for (auto value : span) {
+    sum += value;
+  }
+  ASSERT_EQ(sum, 15U);
+  ASSERT_EQ(span.end() - span.begin(), 5);
+
+  for (auto &value : span) {
+    value = static_cast<uint16_t>(value * 2);
+  }
+  ASSERT_EQ(buffer[4], 10);
+}
+
+TEST_F(TestSpan, TestSlicing) {
+  uint8_t buffer[10]{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  qle::Span<uint8_t> span(buffer, 10);
+
+  auto head = span.first(3);
+  ASSERT_EQ(head.Size(), 3U);
+  ASSERT_EQ(head.Data(), &buffer[0]);
+
+  auto tail = span.last(4);
+  ASSERT_EQ(tail.Size(), 4U);
+  ASSERT_EQ(tail[0], 6);
+
+  auto middle = span.subspan(2, 5);
+  ASSERT_EQ(middle.Size(), 5U);
+  ASSERT_EQ(middle[0], 2);
+  ASSERT_EQ(middle.subspan(1)[0], 3);
+  ASSERT_EQ(middle.subspan(1).Size(), 4U);
+
+  auto rest = span.subspan(10);
+  ASSERT_TRUE(rest.Empty());
+
+  auto fixed_head = span.first<4>();
+  static_assert(decltype(fixed_head)::extent == 4, "");
+  ASSERT_EQ(fixed_head[3], 3);
+
+  auto fixed_tail = fixed_head.last<2>();
+  static_assert(decltype(fixed_tail)::extent == 2, "");
+  ASSERT_EQ(fixed_tail[0], 2);
+}
+
 }  // namespace
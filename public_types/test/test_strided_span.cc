@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <public_types/strided_span.h>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+
+namespace {
+
+class TestStridedSpan : public ::testing::Test {};
+
+TEST_F(TestStridedSpan, TestBasic) {
+  static_assert(std::is_trivially_copyable<qle::StridedSpan<int>>::value, "");
+
+  int buffer[12]{};
+  std::iota(std::begin(buffer), std::end(buffer), 0);
+
+  // Every third element starting at 1: 1, 4, 7, 10
+  qle::StridedSpan<int> span(&buffer[1], 4, 3);
+  ASSERT_EQ(span.Size(), 4U);
+  ASSERT_EQ(span.Stride(), 3);
+  ASSERT_EQ(span.Data(), &buffer[1]);
+  ASSERT_FALSE(span.IsContiguous());
+  for (size_t i = 0; i < span.Size(); i++) {
+    ASSERT_EQ(span[i], static_cast<int>(1 + 3 * i));
+  }
+
+  span[2] = 100;
+  ASSERT_EQ(buffer[7], 100);
+
+  qle::StridedSpan<int> empty;
+  ASSERT_TRUE(empty.Empty());
+}
+
+TEST_F(TestStridedSpan, TestIterators) {
+  int buffer[8]{0, 1, 2, 3, 4, 5, 6, 7};
+  qle::StridedSpan<int> evens(buffer, 4, 2);
+
+  int sum{0};
+  for (auto value : evens) {
+    sum += value;
+  }
+  ASSERT_EQ(sum, 0 + 2 + 4 + 6);
+  ASSERT_EQ(evens.end() - evens.begin(), 4);
+  ASSERT_EQ(*std::max_element(evens.begin(), evens.end()), 6);
+  ASSERT_EQ(evens.begin()[3], 6);
+
+  std::fill(evens.begin(), evens.end(), -1);
+  ASSERT_EQ(buffer[6], -1);
+  ASSERT_EQ(buffer[7], 7);
+}
+
+TEST_F(TestStridedSpan, TestRandomAccess) {
+  // Channel 0 of 3 interleaved channels: its end is not formed as a pointer
+  int buffer[9]{0, 1, 2, 3, 4, 5, 6, 7, 8};
+  qle::StridedSpan<int> channel(buffer, 3, 3);
+
+  decltype(channel.begin()) it;
+  it = channel.begin();
+  const auto end = channel.end();
+  ASSERT_TRUE(it <= end);
+  ASSERT_TRUE(end >= it);
+  ASSERT_TRUE(end > it);
+  ASSERT_FALSE(it >= end);
+  ASSERT_EQ(*(1 + it), 3);
+  ASSERT_EQ(*(end - 1), 6);
+  ASSERT_EQ(end - it, 3);
+  ASSERT_EQ(it - end, -3);
+
+  std::sort(channel.begin(), channel.end(), std::greater<int>());
+  ASSERT_EQ(buffer[0], 6);
+  ASSERT_EQ(buffer[3], 3);
+  ASSERT_EQ(buffer[6], 0);
+  ASSERT_EQ(buffer[1], 1);
+
+  // An empty tail starts at the first element
+  ASSERT_EQ(channel.subspan(3).Data(), buffer);
+  ASSERT_TRUE(channel.subspan(3).Empty());
+}
+
+TEST_F(TestStridedSpan, TestSlicing) {
+  int buffer[10]{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+  // Contiguous span converts with stride 1
+  qle::StridedSpan<int> all = qle::Span<int>(buffer);
+  ASSERT_TRUE(all.IsContiguous());
+  ASSERT_EQ(all.contiguous().Size(), 10U);
+
+  auto odds = all.subspan(1).every(2);
+  ASSERT_EQ(odds.Size(), 5U);
+  ASSERT_EQ(odds[4], 9);
+
+  auto middle = odds.subspan(1, 3);
+  ASSERT_EQ(middle.Size(), 3U);
+  ASSERT_EQ(middle[0], 3);
+  ASSERT_EQ(middle[2], 7);
+
+  ASSERT_EQ(all.every(3).Size(), 4U);  // 0, 3, 6, 9
+}
+
+}  // namespace
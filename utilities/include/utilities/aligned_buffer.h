@@ -0,0 +1,156 @@
+#ifndef UTILITIES_ALIGNED_BUFFER_H
+#define UTILITIES_ALIGNED_BUFFER_H
+
+#include <public_types/span.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace qle {
+
+/**
+ * @brief Constant cache line size in bytes
+ */
+static constexpr size_t cCacheLineSize{64};
+
+/**
+ * @brief Constant page size in bytes
+ */
+static constexpr size_t cPageSize{4096};
+
+/**
+ * @brief Constant huge page size in bytes
+ */
+static constexpr size_t cHugePageSize{2 * 1024 * 1024};
+
+/**
+ * @brief Backing memory of an AlignedBuffer
+ */
+enum class PageBacking {
+  DEFAULT,           ///< Heap memory
+  TRANSPARENT_HUGE,  ///< Anonymous mapping advised for transparent huge pages
+  HUGETLB,           ///< Anonymous mapping from the hugetlbfs pool
+};
+
+/**
+ * @brief AlignedBuffer owns a block of memory with a guaranteed alignment
+ *
+ * Huge page backings round the size up to whole huge pages. HUGETLB falls back
+ * to TRANSPARENT_HUGE when no huge page is reserved on the system; backing()
+ * reports what was actually obtained. Allocation failure leaves the buffer
+ * invalid rather than throwing.
+ */
+class AlignedBuffer {
+ public:
+  /**
+   * @brief Construct an empty AlignedBuffer object
+   */
+  AlignedBuffer() noexcept = default;
+
+  /**
+   * @brief Construct a new AlignedBuffer object
+   *
+   * @param size Size in bytes
+   * @param alignment Alignment in bytes, a power of 2
+   * @param backing Backing memory
+   */
+  explicit AlignedBuffer(size_t size, size_t alignment = cCacheLineSize,
+                         PageBacking backing = PageBacking::DEFAULT) noexcept;
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  AlignedBuffer(const AlignedBuffer &) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  AlignedBuffer &operator=(const AlignedBuffer &) = delete;
+
+  /**
+   * @brief Move constructor
+   *
+   * @param other Buffer to take ownership from
+   */
+  AlignedBuffer(AlignedBuffer &&other) noexcept;
+
+  /**
+   * @brief Move assignment
+   *
+   * @param other Buffer to take ownership from
+   * @return AlignedBuffer&
+   */
+  AlignedBuffer &operator=(AlignedBuffer &&other) noexcept;
+
+  /**
+   * @brief Destroy the AlignedBuffer object
+   */
+  ~AlignedBuffer() noexcept { reset(); }
+
+  /**
+   * @brief Release the memory
+   */
+  void reset() noexcept;
+
+  /**
+   * @brief Check if the buffer holds memory
+   *
+   * @return true/false
+   */
+  bool valid() const noexcept { return data_ != nullptr; }
+
+  /**
+   * @brief Get data
+   *
+   * @return uint8_t*
+   */
+  uint8_t *Data() const noexcept { return data_; }
+
+  /**
+   * @brief Get usable size in bytes
+   *
+   * @return size_t
+   */
+  size_t Size() const noexcept { return size_; }
+
+  /**
+   * @brief Get alignment in bytes
+   *
+   * @return size_t
+   */
+  size_t alignment() const noexcept { return alignment_; }
+
+  /**
+   * @brief Get backing memory
+   *
+   * @return PageBacking
+   */
+  PageBacking backing() const noexcept { return backing_; }
+
+  /**
+   * @brief Get span over the whole buffer
+   *
+   * @return Span<uint8_t>
+   */
+  Span<uint8_t> span() const noexcept { return Span<uint8_t>(data_, size_); }
+
+ private:
+  /**
+   * @brief Allocate an anonymous mapping
+   *
+   * @param size Size in bytes
+   * @param backing Huge page backing
+   * @return true/false
+   */
+  bool map(size_t size, PageBacking backing) noexcept;
+
+  uint8_t *data_{nullptr};                     ///< Aligned data
+  size_t size_{0};                             ///< Usable size
+  size_t alignment_{0};                        ///< Alignment
+  PageBacking backing_{PageBacking::DEFAULT};  ///< Backing memory
+  void *mapping_{nullptr};                     ///< Start of mapping
+  size_t mapping_size_{0};                     ///< Size of mapping
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_ALIGNED_BUFFER_H
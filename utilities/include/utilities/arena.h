@@ -0,0 +1,266 @@
+#ifndef UTILITIES_ARENA_H
+#define UTILITIES_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#if (__cplusplus >= 201703L) && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define QLE_ARENA_HAS_PMR 1
+#endif
+#endif
+
+namespace qle {
+
+/**
+ * @brief Arena is a bump-pointer allocator for short-lived objects
+ *
+ * Allocation moves a pointer forward inside the current block; deallocation
+ * does nothing. All memory is reclaimed at once by reset(), typically after a
+ * message or a batch of messages is processed. When a block is exhausted the
+ * arena chains a new one; blocks are kept across resets so that a warm arena
+ * does not call malloc. Allocations larger than the block size get a
+ * dedicated block that is freed on reset. An Arena is not thread-safe; use
+ * one per thread, e.g. thread_local_instance().
+ */
+class Arena {
+ public:
+  /**
+   * @brief Default block size in bytes
+   */
+  static constexpr size_t cDefaultBlockSize{64 * 1024};
+
+  /**
+   * @brief Construct a new Arena object
+   *
+   * @param block_size Size of each chained block in bytes
+   */
+  explicit Arena(size_t block_size = cDefaultBlockSize) noexcept
+      : block_size_(block_size) {}
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  Arena(const Arena &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  Arena(Arena &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  Arena &operator=(const Arena &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  Arena &operator=(Arena &&) = delete;
+
+  /**
+   * @brief Destroy the Arena object
+   */
+  ~Arena() noexcept;
+
+  /**
+   * @brief Get the arena of the calling thread
+   *
+   * @return Arena&
+   */
+  static Arena &thread_local_instance() noexcept;
+
+  /**
+   * @brief Allocate \p size bytes
+   *
+   * @param size Size in bytes
+   * @param alignment Alignment in bytes, a power of 2
+   * @return void* nullptr if out of memory
+   */
+  void *allocate(size_t size,
+                 size_t alignment = alignof(std::max_align_t)) noexcept {
+    const uintptr_t aligned = (cursor_ + alignment - 1) & ~(alignment - 1);
+    if ((cursor_ != 0) && (aligned + size <= end_)) {
+      cursor_ = aligned + size;
+      allocated_bytes_ += size;
+      return reinterpret_cast<void *>(aligned);
+    }
+    return allocate_slow(size, alignment);
+  }
+
+  /**
+   * @brief Release all allocations
+   *
+   * Objects allocated from the arena are not destroyed; only trivially
+   * destructible objects, or objects already destroyed, may be left behind.
+   */
+  void reset() noexcept;
+
+  /**
+   * @brief Get number of bytes handed out since the last reset
+   *
+   * @return size_t
+   */
+  size_t allocated_bytes() const noexcept { return allocated_bytes_; }
+
+  /**
+   * @brief Get number of blocks owned by the arena
+   *
+   * @return size_t
+   */
+  size_t block_count() const noexcept {
+    return blocks_.size() + large_blocks_.size();
+  }
+
+ private:
+  /**
+   * @brief Allocate from the next block
+   *
+   * @param size Size in bytes
+   * @param alignment Alignment in bytes
+   * @return void*
+   */
+  void *allocate_slow(size_t size, size_t alignment) noexcept;
+
+  /**
+   * @brief Make block \p index the current block
+   *
+   * @param index Block index
+   */
+  void use_block(size_t index) noexcept;
+
+  size_t block_size_;                 ///< Size of chained blocks
+  std::vector<void *> blocks_;        ///< Chained blocks, kept across resets
+  std::vector<void *> large_blocks_;  ///< Dedicated blocks, freed on reset
+  size_t current_block_{0};           ///< Index of current block
+  uintptr_t cursor_{0};               ///< Next free byte in current block
+  uintptr_t end_{0};                  ///< End of current block
+  size_t allocated_bytes_{0};         ///< Bytes handed out since last reset
+};
+
+/**
+ * @brief ArenaAllocator adapts an Arena to the standard Allocator interface
+ *
+ * Lets standard containers allocate from an arena, e.g.
+ * std::vector<int, ArenaAllocator<int>> v(ArenaAllocator<int>(arena)).
+ *
+ * @tparam T
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;  ///< Value type
+
+  /**
+   * @brief Construct an allocator using the calling thread's arena
+   */
+  ArenaAllocator() noexcept : arena_(&Arena::thread_local_instance()) {}
+
+  /**
+   * @brief Construct a new ArenaAllocator object
+   *
+   * @param arena Arena
+   */
+  explicit ArenaAllocator(Arena &arena) noexcept : arena_(&arena) {}
+
+  /**
+   * @brief Construct from an allocator of another type
+   *
+   * @tparam U
+   * @param other Other allocator
+   */
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) noexcept  // NOLINT
+      : arena_(other.arena()) {}
+
+  /**
+   * @brief Allocate \p count objects
+   *
+   * @param count Number of objects
+   * @return T*
+   */
+  T *allocate(size_t count) {
+    void *ptr = arena_->allocate(count * sizeof(T), alignof(T));
+    if (!ptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(ptr);
+  }
+
+  /**
+   * @brief Deallocation is a no-op, memory is reclaimed by Arena::reset()
+   */
+  void deallocate(T *, size_t) noexcept {}
+
+  /**
+   * @brief Get arena
+   *
+   * @return Arena*
+   */
+  Arena *arena() const noexcept { return arena_; }
+
+ private:
+  Arena *arena_;  ///< Arena
+};
+
+/**
+ * @brief Allocators are equal if they share an arena
+ */
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &lhs,
+                const ArenaAllocator<U> &rhs) noexcept {
+  return lhs.arena() == rhs.arena();
+}
+
+/**
+ * @brief Allocators are different if they use different arenas
+ */
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &lhs,
+                const ArenaAllocator<U> &rhs) noexcept {
+  return lhs.arena() != rhs.arena();
+}
+
+#if defined(QLE_ARENA_HAS_PMR)
+
+/**
+ * @brief ArenaResource exposes an Arena as a std::pmr::memory_resource
+ *
+ * Only available when compiling as C++17 or later.
+ */
+class ArenaResource : public std::pmr::memory_resource {
+ public:
+  /**
+   * @brief Construct a new ArenaResource object
+   *
+   * @param arena Arena
+   */
+  explicit ArenaResource(Arena &arena) noexcept : arena_(arena) {}
+
+ private:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    void *ptr = arena_.allocate(bytes, alignment);
+    if (!ptr) {
+      throw std::bad_alloc();
+    }
+    return ptr;
+  }
+
+  void do_deallocate(void *, size_t, size_t) override {}
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override {
+    return this == &other;
+  }
+
+  Arena &arena_;  ///< Arena
+};
+
+#endif  // QLE_ARENA_HAS_PMR
+
+}  // namespace qle
+
+#endif  // UTILITIES_ARENA_H
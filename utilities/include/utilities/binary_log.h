@@ -0,0 +1,603 @@
+#ifndef UTILITIES_BINARY_LOG_H
+#define UTILITIES_BINARY_LOG_H
+
+#include <fmt/core.h>
+#include <utilities/byte_reader.h>
+#include <utilities/bytestream.h>
+#include <utilities/log_config.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace qle {
+
+/**
+ * @brief Magic number at the start of a binary log file, "QLEBLOG1"
+ */
+static constexpr uint64_t cBinaryLogMagic{0x31474F4C42454C51ULL};
+
+/**
+ * @brief Version of the binary log format
+ */
+static constexpr uint32_t cBinaryLogVersion{1};
+
+/**
+ * @brief Magic number at the start of each block, "QBLK"
+ */
+static constexpr uint32_t cBinaryBlockMagic{0x4B4C4251U};
+
+/**
+ * @brief Size of the file header: magic, version, reserved
+ */
+static constexpr size_t cBinaryFileHeaderSize{16};
+
+/**
+ * @brief Size of a block header
+ */
+static constexpr size_t cBinaryBlockHeaderSize{40};
+
+/**
+ * @brief Format of records whose message was formatted before writing
+ */
+static constexpr const char *cBinaryTextFormat{"{}"};
+
+/**
+ * @brief Type tag of an encoded argument
+ */
+enum class BinaryArgType : uint8_t {
+  INT = 1,  ///< int64_t
+  UINT,     ///< uint64_t
+  DOUBLE,   ///< double
+  BOOL,     ///< bool
+  CHAR,     ///< char
+  STRING,   ///< uint32_t length, then bytes
+  POINTER,  ///< uint64_t address
+};
+
+/**
+ * @brief Kind of an entry in a block
+ */
+enum class BinaryEntryType : uint8_t {
+  RECORD = 0,  ///< Log record
+  LOGGER,      ///< Logger name definition
+  FORMAT,      ///< Format string definition
+};
+
+namespace detail {
+
+/**
+ * @brief Store the \p size low bytes of \p value little-endian at \p out
+ *
+ * @return uint8_t* Byte after the value
+ */
+inline uint8_t *store_le(uint8_t *out, uint64_t value, size_t size) noexcept {
+  for (size_t i = 0; i < size; i++) {
+    out[i] = static_cast<uint8_t>(value >> (cByteSize * i));
+  }
+  return out + size;
+}
+
+/**
+ * @brief Encoding of one binary log argument, a type tag and a value
+ *
+ * Only specialised types are encoded; records with other arguments are
+ * formatted first and stored as text.
+ *
+ * @tparam T Argument type
+ */
+template <typename T, typename = void>
+struct BinaryArg {
+  static constexpr bool cSupported{false};  ///< Type can be encoded
+};
+
+/**
+ * @brief Fixed-size values are stored in 1 or 8 bytes
+ */
+template <BinaryArgType Type, size_t Size>
+struct BinaryFixedArg {
+  static constexpr bool cSupported{true};  ///< Type can be encoded
+
+  /**
+   * @brief Get encoded size
+   */
+  template <typename T>
+  static constexpr size_t size(const T &) noexcept {
+    return 1 + Size;
+  }
+
+  /**
+   * @brief Encode \p bits at \p out
+   */
+  static uint8_t *encode_bits(uint8_t *out, uint64_t bits) noexcept {
+    *out = static_cast<uint8_t>(Type);
+    return store_le(out + 1, bits, Size);
+  }
+};
+
+/**
+ * @brief bool
+ */
+template <>
+struct BinaryArg<bool> : BinaryFixedArg<BinaryArgType::BOOL, 1> {
+  /**
+   * @brief Encode \p value at \p out
+   */
+  static uint8_t *encode(uint8_t *out, bool value) noexcept {
+    return encode_bits(out, value ? 1 : 0);
+  }
+};
+
+/**
+ * @brief char
+ */
+template <>
+struct BinaryArg<char> : BinaryFixedArg<BinaryArgType::CHAR, 1> {
+  /**
+   * @brief Encode \p value at \p out
+   */
+  static uint8_t *encode(uint8_t *out, char value) noexcept {
+    return encode_bits(out, static_cast<uint8_t>(value));
+  }
+};
+
+/**
+ * @brief Signed integers are widened to int64_t
+ */
+template <typename T>
+struct BinaryArg<
+    T, std::enable_if_t<std::is_integral<T>::value &&
+                        std::is_signed<T>::value &&
+                        !std::is_same<T, char>::value>>
+    : BinaryFixedArg<BinaryArgType::INT, 8> {
+  /**
+   * @brief Encode \p value at \p out
+   */
+  static uint8_t *encode(uint8_t *out, T value) noexcept {
+    return encode_bits(out,
+                       static_cast<uint64_t>(static_cast<int64_t>(value)));
+  }
+};
+
+/**
+ * @brief Unsigned integers are widened to uint64_t
+ */
+template <typename T>
+struct BinaryArg<
+    T, std::enable_if_t<std::is_integral<T>::value &&
+                        std::is_unsigned<T>::value &&
+                        !std::is_same<T, bool>::value &&
+                        !std::is_same<T, char>::value>>
+    : BinaryFixedArg<BinaryArgType::UINT, 8> {
+  /**
+   * @brief Encode \p value at \p out
+   */
+  static uint8_t *encode(uint8_t *out, T value) noexcept {
+    return encode_bits(out, static_cast<uint64_t>(value));
+  }
+};
+
+/**
+ * @brief Floating point values are widened to double
+ */
+template <typename T>
+struct BinaryArg<T, std::enable_if_t<std::is_floating_point<T>::value>>
+    : BinaryFixedArg<BinaryArgType::DOUBLE, 8> {
+  /**
+   * @brief Encode \p value at \p out
+   */
+  static uint8_t *encode(uint8_t *out, T value) noexcept {
+    const auto widened = static_cast<double>(value);
+    uint64_t bits{0};
+    memcpy(&bits, &widened, sizeof(bits));
+    return encode_bits(out, bits);
+  }
+};
+
+/**
+ * @brief Pointers other than C strings are stored as addresses
+ */
+template <typename T>
+struct BinaryArg<
+    T, std::enable_if_t<std::is_pointer<T>::value &&
+                        !std::is_same<T, const char *>::value &&
+                        !std::is_same<T, char *>::value>>
+    : BinaryFixedArg<BinaryArgType::POINTER, 8> {
+  /**
+   * @brief Encode \p value at \p out
+   */
+  static uint8_t *encode(uint8_t *out, T value) noexcept {
+    return encode_bits(out, reinterpret_cast<uintptr_t>(value));
+  }
+};
+
+/**
+ * @brief Strings are stored as a length followed by their bytes
+ */
+struct BinaryStringArg {
+  static constexpr bool cSupported{true};  ///< Type can be encoded
+
+  /**
+   * @brief Get encoded size
+   */
+  static constexpr size_t size_of(size_t length) noexcept {
+    return 1 + sizeof(uint32_t) + length;
+  }
+
+  /**
+   * @brief Encode tag and length of a string at \p out
+   *
+   * @return uint8_t* Where the bytes of the string go
+   */
+  static uint8_t *encode_header(uint8_t *out, size_t length) noexcept {
+    *out = static_cast<uint8_t>(BinaryArgType::STRING);
+    return store_le(out + 1, length, sizeof(uint32_t));
+  }
+
+  /**
+   * @brief Encode string at \p out
+   */
+  static uint8_t *encode_string(uint8_t *out, const char *str,
+                                size_t length) noexcept {
+    out = encode_header(out, length);
+    memcpy(out, str, length);
+    return out + length;
+  }
+};
+
+/**
+ * @brief C strings, nullptr is stored as "(null)"
+ */
+template <typename T>
+struct BinaryArg<T, std::enable_if_t<std::is_same<T, const char *>::value ||
+                                     std::is_same<T, char *>::value>>
+    : BinaryStringArg {
+  /**
+   * @brief Get encoded size
+   */
+  static size_t size(const char *str) noexcept {
+    return size_of(str ? strlen(str) : 6);
+  }
+
+  /**
+   * @brief Encode \p str at \p out
+   */
+  static uint8_t *encode(uint8_t *out, const char *str) noexcept {
+    return str ? encode_string(out, str, strlen(str))
+               : encode_string(out, "(null)", 6);
+  }
+};
+
+/**
+ * @brief std::string
+ */
+template <>
+struct BinaryArg<std::string> : BinaryStringArg {
+  /**
+   * @brief Get encoded size
+   */
+  static size_t size(const std::string &str) noexcept {
+    return size_of(str.size());
+  }
+
+  /**
+   * @brief Encode \p str at \p out
+   */
+  static uint8_t *encode(uint8_t *out, const std::string &str) noexcept {
+    return encode_string(out, str.data(), str.size());
+  }
+};
+
+/**
+ * @brief Check if all of Args can be encoded
+ */
+template <typename... Args>
+struct AllBinary : std::true_type {};
+
+/**
+ * @brief Check if all of Arg, Rest can be encoded
+ */
+template <typename Arg, typename... Rest>
+struct AllBinary<Arg, Rest...>
+    : std::integral_constant<bool, BinaryArg<std::decay_t<Arg>>::cSupported &&
+                                       AllBinary<Rest...>::value> {};
+
+/**
+ * @brief Sum of encoded argument sizes
+ */
+inline size_t binary_size() noexcept { return 0; }
+
+/**
+ * @brief Sum of encoded argument sizes
+ */
+template <typename Arg, typename... Rest>
+size_t binary_size(const Arg &arg, const Rest &...rest) noexcept {
+  return BinaryArg<std::decay_t<Arg>>::size(arg) + binary_size(rest...);
+}
+
+/**
+ * @brief Encode arguments one after another
+ */
+inline uint8_t *binary_encode(uint8_t *out) noexcept { return out; }
+
+/**
+ * @brief Encode arguments one after another
+ */
+template <typename Arg, typename... Rest>
+uint8_t *binary_encode(uint8_t *out, const Arg &arg,
+                       const Rest &...rest) noexcept {
+  return binary_encode(BinaryArg<std::decay_t<Arg>>::encode(out, arg),
+                       rest...);
+}
+
+/**
+ * @brief FNV-1a hash of a text
+ */
+struct BinaryTextHash {
+  size_t operator()(fmt::string_view text) const noexcept {
+    uint64_t hash{0xCBF29CE484222325ULL};
+    for (const char c : text) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ULL;
+    }
+    return static_cast<size_t>(hash);
+  }
+};
+
+/**
+ * @brief Ids of the logger names or formats defined in a file, keyed by
+ * content so that a reused buffer never maps to a stale definition
+ */
+struct BinaryTextIds {
+  std::deque<std::string> texts;  ///< Defined texts, by id
+  std::unordered_map<fmt::string_view, uint32_t, BinaryTextHash>
+      ids;  ///< Id of each text, viewing texts
+};
+
+}  // namespace detail
+
+/**
+ * @brief BinaryLogWriter writes log records in the compact binary format
+ *
+ * A file starts with a 16-byte header (magic, version) followed by blocks.
+ * Each block has a header indexing its records by time range and levels,
+ * then entries: logger name and format string definitions, written the
+ * first time a name or format text is seen, and records of timestamp, level,
+ * logger id, format id and type-tagged arguments. Integers are stored
+ * little-endian. Readers can skip whole blocks by their header.
+ */
+class BinaryLogWriter {
+ public:
+  /**
+   * @brief Construct a new BinaryLogWriter object
+   *
+   * @param block_size Size at which a block is written
+   */
+  explicit BinaryLogWriter(
+      size_t block_size = cDefaultBinaryLogBlockSize) noexcept
+      : block_size_(block_size) {}
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  BinaryLogWriter(const BinaryLogWriter &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  BinaryLogWriter(BinaryLogWriter &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  BinaryLogWriter &operator=(const BinaryLogWriter &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  BinaryLogWriter &operator=(BinaryLogWriter &&) = delete;
+
+  /**
+   * @brief Write the last block and close the file
+   */
+  ~BinaryLogWriter() { close(); }
+
+  /**
+   * @brief Create \p path and write the file header
+   *
+   * @param path File path
+   * @return bool false on I/O error
+   */
+  bool open(const char *path) noexcept;
+
+  /**
+   * @brief Write the last block and close the file
+   */
+  void close() noexcept;
+
+  /**
+   * @brief Append a record
+   *
+   * @param level Log level
+   * @param name Logger name
+   * @param format Format string
+   * @param args Arguments encoded by detail::binary_encode
+   * @param size Size of encoded arguments
+   * @return bool false if the file is not open
+   */
+  bool write(LogLevel::Level level, const char *name, const char *format,
+             const uint8_t *args, size_t size) noexcept;
+
+  /**
+   * @brief Write the current block, even if not full, and flush the file
+   */
+  void flush() noexcept;
+
+ private:
+  /**
+   * @brief Id of \p text, appending its definition the first time
+   *
+   * @param ids Known ids
+   * @param type LOGGER or FORMAT
+   * @param text Logger name or format string
+   * @return uint32_t
+   */
+  uint32_t define(detail::BinaryTextIds &ids, BinaryEntryType type,
+                  const char *text);
+
+  /**
+   * @brief Grow the block by \p size bytes
+   *
+   * @param size Size in bytes
+   * @return uint8_t* First new byte
+   */
+  uint8_t *extend(size_t size);
+
+  /**
+   * @brief Write the current block, with the mutex held
+   */
+  void write_block() noexcept;
+
+  std::mutex mtx_;                     ///< Writer mutex
+  FILE *file_{nullptr};                ///< File
+  size_t block_size_;                  ///< Size at which a block is written
+  std::vector<uint8_t> block_;         ///< Entries of the current block
+  uint32_t record_count_{0};           ///< Records in the block
+  uint32_t definition_count_{0};       ///< Definitions in the block
+  uint32_t level_mask_{0};             ///< Levels of the records
+  uint64_t min_timestamp_{UINT64_MAX};  ///< Earliest record
+  uint64_t max_timestamp_{0};           ///< Latest record
+  detail::BinaryTextIds loggers_;      ///< Logger ids
+  detail::BinaryTextIds formats_;      ///< Format ids
+};
+
+/**
+ * @brief Which records a BinaryLogReader returns
+ */
+struct BinaryLogFilter {
+  uint64_t from{0};                           ///< Earliest timestamp
+  uint64_t to{UINT64_MAX};                    ///< Latest timestamp
+  LogLevel::Level min_level{LogLevel::TRACE};  ///< Lowest level
+};
+
+/**
+ * @brief Decoded binary log record
+ */
+struct BinaryLogRecord {
+  uint64_t timestamp{0};                    ///< Nanoseconds since epoch
+  LogLevel::Level level{LogLevel::TRACE};  ///< Log level
+  std::string logger;                      ///< Logger name
+  std::string message;                     ///< Formatted message
+};
+
+/**
+ * @brief BinaryLogReader decodes a binary log file
+ *
+ * Blocks whose index does not match the filter are skipped without reading
+ * their records; only their definitions, if any, are read.
+ */
+class BinaryLogReader {
+ public:
+  /**
+   * @brief Construct a new BinaryLogReader object
+   *
+   * @param filter Records to return
+   */
+  explicit BinaryLogReader(const BinaryLogFilter &filter = {}) noexcept
+      : filter_(filter) {}
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  BinaryLogReader(const BinaryLogReader &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  BinaryLogReader(BinaryLogReader &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  BinaryLogReader &operator=(const BinaryLogReader &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  BinaryLogReader &operator=(BinaryLogReader &&) = delete;
+
+  /**
+   * @brief Close the file
+   */
+  ~BinaryLogReader();
+
+  /**
+   * @brief Open \p path and check its header
+   *
+   * @param path File path
+   * @return bool false if not a binary log file
+   */
+  bool open(const char *path) noexcept;
+
+  /**
+   * @brief Decode the next record matching the filter
+   *
+   * @param record Output record
+   * @return bool false at the end of the file or on corrupt data
+   */
+  bool next(BinaryLogRecord &record);
+
+  /**
+   * @brief Get number of blocks whose records were read
+   *
+   * @return size_t
+   */
+  size_t blocks_read() const noexcept { return blocks_read_; }
+
+  /**
+   * @brief Get number of blocks skipped by their index
+   *
+   * @return size_t
+   */
+  size_t blocks_skipped() const noexcept { return blocks_skipped_; }
+
+  /**
+   * @brief Format encoded arguments
+   *
+   * Supports the replacement fields "{}", "{:spec}" and "{n:spec}", as well
+   * as "{{" and "}}".
+   *
+   * @param format Format string
+   * @param args Encoded arguments
+   * @return std::string
+   */
+  static std::string render(const std::string &format,
+                            ByteReader<Endianess::LITTLE_END> args);
+
+ private:
+  /**
+   * @brief Load the next block
+   *
+   * @return bool false at the end of the file or on corrupt data
+   */
+  bool next_block();
+
+  BinaryLogFilter filter_;      ///< Records to return
+  FILE *file_{nullptr};         ///< File
+  std::vector<uint8_t> block_;  ///< Entries of the current block
+  ByteReader<Endianess::LITTLE_END> entries_;  ///< Unread entries
+  bool definitions_only_{false};  ///< Block does not match the filter
+  std::unordered_map<uint32_t, std::string> loggers_;  ///< Logger names
+  std::unordered_map<uint32_t, std::string> formats_;  ///< Format strings
+  size_t blocks_read_{0};                              ///< Blocks read
+  size_t blocks_skipped_{0};                           ///< Blocks skipped
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_BINARY_LOG_H
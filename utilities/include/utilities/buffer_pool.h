@@ -0,0 +1,241 @@
+#ifndef UTILITIES_BUFFER_POOL_H
+#define UTILITIES_BUFFER_POOL_H
+
+#include <public_types/span.h>
+#include <utilities/aligned_buffer.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace qle {
+
+class BufferPool;
+
+/**
+ * @brief PooledBuffer is a buffer borrowed from a BufferPool
+ *
+ * The buffer goes back to its pool when the PooledBuffer is destroyed or
+ * released. A PooledBuffer must not outlive its pool.
+ */
+class PooledBuffer {
+ public:
+  /**
+   * @brief Construct an empty PooledBuffer object
+   */
+  PooledBuffer() noexcept = default;
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  PooledBuffer(const PooledBuffer &) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  PooledBuffer &operator=(const PooledBuffer &) = delete;
+
+  /**
+   * @brief Move constructor
+   *
+   * @param other Buffer to take over
+   */
+  PooledBuffer(PooledBuffer &&other) noexcept { *this = std::move(other); }
+
+  /**
+   * @brief Move assignment
+   *
+   * @param other Buffer to take over
+   * @return PooledBuffer&
+   */
+  PooledBuffer &operator=(PooledBuffer &&other) noexcept;
+
+  /**
+   * @brief Destroy the PooledBuffer object
+   */
+  ~PooledBuffer() noexcept { release(); }
+
+  /**
+   * @brief Give the buffer back to the pool
+   */
+  void release() noexcept;
+
+  /**
+   * @brief Check if a buffer is held
+   *
+   * @return true/false
+   */
+  bool valid() const noexcept { return buffer_ != nullptr; }
+
+  /**
+   * @brief Get data
+   *
+   * @return uint8_t*
+   */
+  uint8_t *Data() const noexcept { return buffer_ ? buffer_->Data() : nullptr; }
+
+  /**
+   * @brief Get requested size in bytes
+   *
+   * @return size_t
+   */
+  size_t Size() const noexcept { return size_; }
+
+  /**
+   * @brief Get size of the underlying buffer in bytes
+   *
+   * @return size_t
+   */
+  size_t Capacity() const noexcept { return buffer_ ? buffer_->Size() : 0; }
+
+  /**
+   * @brief Get span over the requested size
+   *
+   * @return Span<uint8_t>
+   */
+  Span<uint8_t> span() const noexcept { return Span<uint8_t>(Data(), size_); }
+
+ private:
+  friend class BufferPool;
+
+  /**
+   * @brief Construct a new PooledBuffer object
+   *
+   * @param pool Owning pool
+   * @param buffer Buffer
+   * @param size Requested size
+   * @param size_class Size class index in the pool
+   */
+  PooledBuffer(BufferPool *pool, std::unique_ptr<AlignedBuffer> buffer,
+               size_t size, size_t size_class) noexcept
+      : pool_(pool),
+        buffer_(std::move(buffer)),
+        size_(size),
+        size_class_(size_class) {}
+
+  BufferPool *pool_{nullptr};              ///< Owning pool
+  std::unique_ptr<AlignedBuffer> buffer_;  ///< Buffer
+  size_t size_{0};                         ///< Requested size
+  size_t size_class_{0};                   ///< Size class index
+};
+
+/**
+ * @brief BufferPool recycles aligned buffers in power-of-2 size classes
+ *
+ * Buffers released to the pool are kept and handed out again to requests of
+ * the same size class, so a steady stream of frames allocates nothing once
+ * the pool is warm. Requests larger than the biggest size class are served
+ * with a dedicated buffer that is freed on release.
+ */
+class BufferPool {
+ public:
+  /**
+   * @brief Construct a new BufferPool object
+   *
+   * @param min_size Smallest size class in bytes
+   * @param max_size Biggest size class in bytes
+   * @param alignment Alignment of every buffer
+   * @param backing Backing memory of every buffer
+   */
+  explicit BufferPool(size_t min_size, size_t max_size,
+                      size_t alignment = cCacheLineSize,
+                      PageBacking backing = PageBacking::DEFAULT) noexcept;
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  BufferPool(const BufferPool &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  BufferPool(BufferPool &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  BufferPool &operator=(const BufferPool &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  BufferPool &operator=(BufferPool &&) = delete;
+
+  /**
+   * @brief Destroy the BufferPool object
+   */
+  ~BufferPool() = default;
+
+  /**
+   * @brief Borrow a buffer of at least \p size bytes
+   *
+   * @param size Size in bytes
+   * @return PooledBuffer Invalid if allocation failed
+   */
+  PooledBuffer acquire(size_t size) noexcept;
+
+  /**
+   * @brief Pre-allocate \p count buffers for requests of \p size bytes
+   *
+   * @param size Size in bytes
+   * @param count Number of buffers
+   */
+  void reserve(size_t size, size_t count) noexcept;
+
+  /**
+   * @brief Get number of buffers allocated by the pool
+   *
+   * @return size_t
+   */
+  size_t allocation_count() const noexcept;
+
+  /**
+   * @brief Get number of requests served from recycled buffers
+   *
+   * @return size_t
+   */
+  size_t reuse_count() const noexcept;
+
+  /**
+   * @brief Get number of idle buffers held by the pool
+   *
+   * @return size_t
+   */
+  size_t idle_count() const noexcept;
+
+ private:
+  friend class PooledBuffer;
+
+  /**
+   * @brief Index of size class for \p size, or number of classes if too big
+   *
+   * @param size Size in bytes
+   * @return size_t
+   */
+  size_t size_class(size_t size) const noexcept;
+
+  /**
+   * @brief Take back a buffer
+   *
+   * @param buffer Buffer
+   * @param size_class Size class index
+   */
+  void recycle(std::unique_ptr<AlignedBuffer> buffer,
+               size_t size_class) noexcept;
+
+  size_t min_size_;      ///< Smallest size class
+  size_t alignment_;     ///< Alignment of every buffer
+  PageBacking backing_;  ///< Backing memory of every buffer
+
+  mutable std::mutex mtx_;  ///< Free list mutex
+  std::vector<std::vector<std::unique_ptr<AlignedBuffer>>>
+      free_lists_;              ///< Idle buffers per size class
+  size_t allocation_count_{0};  ///< Number of allocated buffers
+  size_t reuse_count_{0};       ///< Number of recycled requests
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_BUFFER_POOL_H
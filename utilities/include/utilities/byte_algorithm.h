@@ -0,0 +1,133 @@
+#ifndef UTILITIES_BYTE_ALGORITHM_H
+#define UTILITIES_BYTE_ALGORITHM_H
+
+#include <public_types/span.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace qle {
+
+/**
+ * @brief SIMD instruction set used by an algorithm
+ */
+enum class SimdLevel {
+  SCALAR,  ///< Portable scalar code
+  SSE42,   ///< 16-byte SSE4.2 code
+  AVX2,    ///< 32-byte AVX2 code
+};
+
+/**
+ * @brief Byte scanning algorithms over spans
+ *
+ * Every algorithm dispatches at runtime to the widest instruction set the CPU
+ * supports. The overloads taking a SimdLevel force a specific implementation,
+ * clamped to what the CPU supports; they exist for testing and benchmarking.
+ * Search functions return the index of the match, or the size of the searched
+ * span when nothing matches.
+ */
+class ByteAlgorithm {
+ public:
+  /**
+   * @brief Get the widest instruction set supported by the CPU
+   *
+   * @return SimdLevel
+   */
+  static SimdLevel best_simd_level() noexcept;
+
+  /**
+   * @brief Find first occurrence of \p value
+   *
+   * @param span Byte span
+   * @param value Byte to find
+   * @return size_t Index of the byte, or span size if not found
+   */
+  static size_t find_byte(Span<const uint8_t> span, uint8_t value) noexcept {
+    return find_byte(span, value, best_simd_level());
+  }
+
+  /**
+   * @brief Find first occurrence of \p value with a given instruction set
+   */
+  static size_t find_byte(Span<const uint8_t> span, uint8_t value,
+                          SimdLevel level) noexcept;
+
+  /**
+   * @brief Find first occurrence of a multi-byte pattern, e.g. a sync word
+   *
+   * @param span Byte span
+   * @param pattern Pattern to find
+   * @return size_t Index of the pattern, or span size if not found
+   */
+  static size_t find_pattern(Span<const uint8_t> span,
+                             Span<const uint8_t> pattern) noexcept {
+    return find_pattern(span, pattern, best_simd_level());
+  }
+
+  /**
+   * @brief Find first occurrence of a pattern with a given instruction set
+   */
+  static size_t find_pattern(Span<const uint8_t> span,
+                             Span<const uint8_t> pattern,
+                             SimdLevel level) noexcept;
+
+  /**
+   * @brief Count occurrences of \p value
+   *
+   * @param span Byte span
+   * @param value Byte to count
+   * @return size_t
+   */
+  static size_t count(Span<const uint8_t> span, uint8_t value) noexcept {
+    return count(span, value, best_simd_level());
+  }
+
+  /**
+   * @brief Count occurrences of \p value with a given instruction set
+   */
+  static size_t count(Span<const uint8_t> span, uint8_t value,
+                      SimdLevel level) noexcept;
+
+  /**
+   * @brief Find first index where two spans differ
+   *
+   * @param lhs First span
+   * @param rhs Second span
+   * @return size_t Index of first difference, or the smaller size if the
+   * common prefix is equal
+   */
+  static size_t mismatch(Span<const uint8_t> lhs,
+                         Span<const uint8_t> rhs) noexcept {
+    return mismatch(lhs, rhs, best_simd_level());
+  }
+
+  /**
+   * @brief Find first index where two spans differ with a given instruction
+   * set
+   */
+  static size_t mismatch(Span<const uint8_t> lhs, Span<const uint8_t> rhs,
+                         SimdLevel level) noexcept;
+
+  /**
+   * @brief Check if two spans have equal size and content
+   *
+   * @param lhs First span
+   * @param rhs Second span
+   * @return true/false
+   */
+  static bool equal(Span<const uint8_t> lhs, Span<const uint8_t> rhs) noexcept {
+    return equal(lhs, rhs, best_simd_level());
+  }
+
+  /**
+   * @brief Check if two spans are equal with a given instruction set
+   */
+  static bool equal(Span<const uint8_t> lhs, Span<const uint8_t> rhs,
+                    SimdLevel level) noexcept {
+    return (lhs.Size() == rhs.Size()) &&
+           (mismatch(lhs, rhs, level) == lhs.Size());
+  }
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_BYTE_ALGORITHM_H
@@ -0,0 +1,215 @@
+#ifndef UTILITIES_BYTE_READER_H
+#define UTILITIES_BYTE_READER_H
+
+#include <utilities/bytestream.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace qle {
+
+/**
+ * @brief ByteReader is a copyable read cursor over an immutable byte buffer
+ *
+ * Unlike Bytestream, a ByteReader is a plain value of two pointers: it can be
+ * passed by value, stored in containers and forked to look ahead without
+ * touching the original. The endianess is part of the type so that the
+ * reader stays two words wide and is passed in registers. The reader never
+ * writes to the buffer, so any number of threads can read the same buffer
+ * through their own readers.
+ *
+ * @tparam E Endianess
+ */
+template <Endianess E = Endianess::BIG_END>
+class ByteReader {
+ public:
+  /**
+   * @brief Construct an empty ByteReader object
+   */
+  constexpr ByteReader() noexcept = default;
+
+  /**
+   * @brief Construct a new ByteReader object
+   *
+   * @param buffer Byte buffer
+   * @param size Length of buffer
+   */
+  constexpr ByteReader(const uint8_t *buffer, size_t size) noexcept
+      : cursor_(buffer), end_(buffer + size) {}
+
+  /**
+   * @brief Construct a new ByteReader object from a span
+   *
+   * @param span Byte span
+   */
+  constexpr explicit ByteReader(Span<const uint8_t> span) noexcept
+      : cursor_(span.Data()), end_(span.Data() + span.Size()) {}
+
+  /**
+   * @brief Fork the reader
+   *
+   * The fork reads independently from the current position, e.g. for
+   * speculative parsing. Commit by assigning it back to the original.
+   *
+   * @return ByteReader
+   */
+  constexpr ByteReader fork() const noexcept { return *this; }
+
+  /**
+   * @brief Get number of remaining bytes
+   *
+   * @return size_t
+   */
+  constexpr size_t remaining() const noexcept {
+    return static_cast<size_t>(end_ - cursor_);
+  }
+
+  /**
+   * @brief Check if there is no byte left
+   *
+   * @return true/false
+   */
+  constexpr bool empty() const noexcept { return cursor_ == end_; }
+
+  /**
+   * @brief Get span over the remaining bytes
+   *
+   * @return Span<const uint8_t>
+   */
+  constexpr Span<const uint8_t> span() const noexcept {
+    return Span<const uint8_t>(cursor_, remaining());
+  }
+
+  /**
+   * @brief Get pointer to the current position
+   *
+   * @return const uint8_t*
+   */
+  constexpr const uint8_t *data() const noexcept { return cursor_; }
+
+  /**
+   * @brief Check if buffer is overflowed when increasing \p size bytes
+   *
+   * @param size Increasing size
+   * @return bool
+   */
+  constexpr bool is_overflow(size_t size) const noexcept {
+    return size > remaining();
+  }
+
+  /**
+   * @brief Skip \p size bytes
+   *
+   * @param size Number of bytes
+   * @return bool
+   */
+  bool skip(size_t size) noexcept {
+    if (is_overflow(size)) {
+      return false;
+    }
+    cursor_ += size;
+    return true;
+  }
+
+  /**
+   * @brief Get data type T from reader
+   *
+   * @tparam T
+   * @param data Output data
+   * @param data_len Output data length
+   * @return bool
+   */
+  template <typename T>
+  typename std::enable_if_t<std::is_integral<T>::value, bool> get(
+      T &data, size_t data_len = sizeof(T)) noexcept {
+    if ((data_len > sizeof(uint64_t)) || is_overflow(data_len)) {
+      return false;
+    }
+    data = static_cast<T>(load(data_len));
+    cursor_ += data_len;
+    return true;
+  }
+
+  /**
+   * @brief Get data type T from reader
+   *
+   * @tparam T
+   * @param data Output data
+   * @return bool
+   */
+  template <typename T>
+  typename std::enable_if_t<std::is_floating_point<T>::value, bool> get(
+      T &data) noexcept {
+    if (is_overflow(sizeof(T))) {
+      return false;
+    }
+    const uint64_t dest = load(sizeof(T));
+    memcpy(&data, &dest, sizeof(T));
+    cursor_ += sizeof(T);
+    return true;
+  }
+
+  /**
+   * @brief Get a view of \p size raw bytes without copying
+   *
+   * @param data Output pointer to the first byte
+   * @param size Number of bytes
+   * @return bool
+   */
+  bool get_bytes(const uint8_t *&data, size_t size) noexcept {
+    if (is_overflow(size)) {
+      return false;
+    }
+    data = cursor_;
+    cursor_ += size;
+    return true;
+  }
+
+  /**
+   * @brief Split off a reader over the next \p size bytes
+   *
+   * @param reader Output reader bounded to the next \p size bytes
+   * @param size Number of bytes
+   * @return bool
+   */
+  bool take(ByteReader &reader, size_t size) noexcept {
+    if (is_overflow(size)) {
+      return false;
+    }
+    reader = ByteReader(cursor_, size);
+    cursor_ += size;
+    return true;
+  }
+
+ private:
+  /**
+   * @brief Load \p data_len bytes at the cursor into an integer
+   *
+   * @param data_len Data length, at most 8
+   * @return uint64_t
+   */
+  uint64_t load(size_t data_len) const noexcept {
+    uint64_t dest{0};
+    for (size_t i = 0; i < data_len; i++) {
+      if (E == Endianess::BIG_END) {
+        dest = (dest << cByteSize) | cursor_[i];
+      } else {
+        dest |= (static_cast<uint64_t>(cursor_[i]) << (cByteSize * i));
+      }
+    }
+    return dest;
+  }
+
+  const uint8_t *cursor_{nullptr};  ///< Current position
+  const uint8_t *end_{nullptr};     ///< End of buffer
+};
+
+static_assert(std::is_trivially_copyable<ByteReader<>>::value,
+              "ByteReader must be trivially copyable");
+static_assert(sizeof(ByteReader<>) == 2 * sizeof(const uint8_t *),
+              "ByteReader must stay two pointers wide");
+
+}  // namespace qle
+
+#endif  // UTILITIES_BYTE_READER_H
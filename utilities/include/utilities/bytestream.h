@@ -145,6 +145,43 @@ class Bytestream {
     return true;
   }
 
+  /**
+   * @brief Get a view of \p size raw bytes from bytestream without copying
+   *
+   * The returned pointer refers to the underlying buffer and stays valid as
+   * long as that buffer does.
+   *
+   * @param data Output pointer to the first byte
+   * @param size Number of bytes
+   * @return bool
+   */
+  bool get_bytes(const uint8_t *&data, size_t size) noexcept {
+    if (is_overflow(size)) {
+      return false;
+    }
+
+    data = span_.Data() + cursor_;
+    cursor_ += size;
+    return true;
+  }
+
+  /**
+   * @brief Get a view of \p size raw bytes from bytestream without copying
+   *
+   * @param data Output span over the bytes
+   * @param size Number of bytes
+   * @return bool
+   */
+  bool get_bytes(Span<const uint8_t> &data, size_t size) noexcept {
+    if (is_overflow(size)) {
+      return false;
+    }
+
+    data = span_.subspan(cursor_, size);
+    cursor_ += size;
+    return true;
+  }
+
  private:
   /**
    * @brief Generic get data from bytestream
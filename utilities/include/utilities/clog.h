@@ -1,18 +1,105 @@
 #ifndef UTILITIES_CLOG_H
 #define UTILITIES_CLOG_H
 
+#include <fmt/compile.h>
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <cstdarg>
 #include <cstdio>
+#include <iterator>
 #include <mutex>
+#include <type_traits>
+#include <utility>
 
+#include <utilities/binary_log.h>
+#include <utilities/deferred_log.h>
+#include <utilities/flight_recorder.h>
 #include <utilities/log_config.h>
 
+/**
+ * @brief Compile-time format string of a CLogger call
+ *
+ * The format is checked against the arguments when the call is built, and
+ * with C++17 and fmt 8 or later it is also turned into specialized
+ * formatting code, e.g. logger.info(QLE_FMT("id {}"), id). With an older
+ * fmt the string is passed as is.
+ */
+#if FMT_VERSION >= 80000
+#define QLE_FMT(s) FMT_COMPILE(s)
+#else
+#define QLE_FMT(s) s
+#endif
+
 namespace qle {
 
+namespace detail {
+
+/**
+ * @brief Check if \p S is a format built by QLE_FMT()
+ */
+template <typename S>
+struct IsCompileFormat
+#if FMT_VERSION >= 80000
+    : std::integral_constant<bool,
+                             fmt::detail::is_compile_string<S>::value ||
+                                 fmt::detail::is_compiled_string<S>::value> {
+};
+#else
+    : std::false_type {
+};
+#endif
+
+/**
+ * @brief Get the format string of a runtime format
+ *
+ * @param format Format
+ * @return const char*
+ */
+inline const char *format_c_str(const char *format) noexcept { return format; }
+
+/**
+ * @brief Get the string literal of a format built by QLE_FMT()
+ *
+ * @param format Format
+ * @return const char* Literal, with static storage
+ */
+template <typename S, std::enable_if_t<IsCompileFormat<S>::value, int> = 0>
+const char *format_c_str(const S &format) noexcept {
+  return fmt::string_view(format).data();
+}
+
+/**
+ * @brief Check if a call with format \p S and \p Args can be deferred:
+ * only QLE_FMT() formats are literals that outlive the call
+ */
+template <typename S, typename... Args>
+struct CanDefer
+    : std::integral_constant<bool, IsCompileFormat<S>::value &&
+                                       AllDeferrable<Args...>::value> {};
+
+/**
+ * @brief Check if a call with format \p S and \p Args can be written with
+ * encoded arguments: only QLE_FMT() formats are kept as definitions, so
+ * that runtime formats do not grow the binary log file's format table
+ */
+template <typename S, typename... Args>
+struct CanEncode : std::integral_constant<bool, IsCompileFormat<S>::value &&
+                                                    AllBinary<Args...>::value> {
+};
+
+}  // namespace detail
+
 /**
  * @brief CLogger class
+ *
+ * While DeferredLog is active, QLE_FMT() calls whose arguments are all
+ * strings or trivially copyable are formatted on a background thread; the
+ * logger name must then have static storage. Calls with a runtime format
+ * are formatted on the calling thread. The same holds while a binary log
+ * file is open, which stores the arguments of QLE_FMT() calls unformatted.
+ *
+ * Each call takes a runtime format or a QLE_FMT() format; the latter is
+ * checked at compile time and, with C++17, formatted without parsing.
  */
 class CLogger {
  public:
@@ -47,8 +134,8 @@ class CLogger {
    * @param logger_name CLogger name
    */
   explicit CLogger(const char *logger_name) noexcept
-      : logger_name_(logger_name) {
-    logger_config_ = LoggerConfig::create();
+      : logger_name_(logger_name), threshold_(logger_name) {
+    LoggerConfig::create();
   }
 
   /**
@@ -56,15 +143,33 @@ class CLogger {
    */
   ~CLogger() = default;
 
+  /**
+   * @brief Check if a line of \p level would be logged by this logger
+   *
+   * @param level Log level
+   * @return true/false
+   */
+  bool is_enabled(LogLevel::Level level) const noexcept {
+    return threshold_.is_enabled(level);
+  }
+
   /**
    * @brief Log trace to stdout
    *
    * @param format Format
    * @param args Follow-up arguments
    */
-  template <typename... Args>
-  void trace(const char *format, Args... args) noexcept {
-    log(LogLevel::TRACE, format, args...);
+  template <typename S, typename... Args>
+  void trace(const S &format, Args &&...args) noexcept {
+    if (QLE_UNLIKELY(FlightRecorder::active())) {
+      FlightRecorder::record(detail::CanDefer<S, Args...>{}, LogLevel::TRACE,
+                             logger_name_, detail::format_c_str(format),
+                             args...);
+    }
+    if (QLE_UNLIKELY(!threshold_.is_enabled(LogLevel::TRACE))) {
+      return;
+    }
+    log(LogLevel::TRACE, format, std::forward<Args>(args)...);
   }
 
   /**
@@ -73,9 +178,17 @@ class CLogger {
    * @param format Format
    * @param args Follow-up arguments
    */
-  template <typename... Args>
-  void debug(const char *format, Args... args) noexcept {
-    log(LogLevel::DEBUG, format, args...);
+  template <typename S, typename... Args>
+  void debug(const S &format, Args &&...args) noexcept {
+    if (QLE_UNLIKELY(FlightRecorder::active())) {
+      FlightRecorder::record(detail::CanDefer<S, Args...>{}, LogLevel::DEBUG,
+                             logger_name_, detail::format_c_str(format),
+                             args...);
+    }
+    if (QLE_UNLIKELY(!threshold_.is_enabled(LogLevel::DEBUG))) {
+      return;
+    }
+    log(LogLevel::DEBUG, format, std::forward<Args>(args)...);
   }
 
   /**
@@ -84,9 +197,12 @@ class CLogger {
    * @param format Format
    * @param args Follow-up arguments
    */
-  template <typename... Args>
-  void info(const char *format, Args... args) noexcept {
-    log(LogLevel::INFO, format, args...);
+  template <typename S, typename... Args>
+  void info(const S &format, Args &&...args) noexcept {
+    if (QLE_UNLIKELY(!threshold_.is_enabled(LogLevel::INFO))) {
+      return;
+    }
+    log(LogLevel::INFO, format, std::forward<Args>(args)...);
   }
 
   /**
@@ -95,9 +211,12 @@ class CLogger {
    * @param format Format
    * @param args Follow-up arguments
    */
-  template <typename... Args>
-  void warn(const char *format, Args... args) noexcept {
-    log(LogLevel::WARNING, format, args...);
+  template <typename S, typename... Args>
+  void warn(const S &format, Args &&...args) noexcept {
+    if (QLE_UNLIKELY(!threshold_.is_enabled(LogLevel::WARNING))) {
+      return;
+    }
+    log(LogLevel::WARNING, format, std::forward<Args>(args)...);
   }
 
   /**
@@ -106,9 +225,29 @@ class CLogger {
    * @param format Format
    * @param args Follow-up arguments
    */
-  template <typename... Args>
-  void error(const char *format, Args... args) noexcept {
-    log(LogLevel::ERROR, format, args...);
+  template <typename S, typename... Args>
+  void error(const S &format, Args &&...args) noexcept {
+    if (QLE_UNLIKELY(!threshold_.is_enabled(LogLevel::ERROR))) {
+      return;
+    }
+    log(LogLevel::ERROR, format, std::forward<Args>(args)...);
+    if (QLE_UNLIKELY(FlightRecorder::active())) {
+      FlightRecorder::on_error();
+    }
+  }
+
+  /**
+   * @brief Log at \p level whatever the logger level
+   *
+   * Used by the statements enabled through LogSiteRegistry.
+   *
+   * @param level Log level
+   * @param format Format
+   * @param args Follow-up arguments
+   */
+  template <typename S, typename... Args>
+  void emit(LogLevel::Level level, const S &format, Args &&...args) noexcept {
+    log(level, format, std::forward<Args>(args)...);
   }
 
  private:
@@ -119,45 +258,120 @@ class CLogger {
    * @param format Format
    * @param args Follow-up arguments
    */
-  template <typename... Args>
-  void log(LogLevel::Level level, const char *format, Args... args) noexcept {
+  template <typename S, typename... Args>
+  void log(LogLevel::Level level, const S &format, Args &&...args) noexcept {
     if (!LogLevel::is_valid_log_level(level)) {
       return;
     }
 
-    if (level < logger_config_->loglevel()) {
+    if (QLE_UNLIKELY(LoggerConfig::binary_active())) {
+      log_binary(detail::CanEncode<S, Args...>{}, level,
+                 detail::format_c_str(format), args...);
       return;
     }
 
-    std::string full_log_msg =
-        fmt::format("[{}] {}: {}", LogLevel::log_level_to_string(level),
-                    logger_name_, fmt::format(format, args...));
-
-    std::lock_guard<std::mutex> guard(logger_config_->logmutex);
-    if (logger_config_->logfile()) {
-      if (level != LogLevel::DISABLED) {
-        fprintf(logger_config_->logfile(), "%s\n", full_log_msg.c_str());
-      }
+    if (DeferredLog::active() &&
+        defer(detail::CanDefer<S, Args...>{}, level,
+              detail::format_c_str(format), args...)) {
       return;
     }
-    switch (level) {
-      case LogLevel::TRACE:
-      case LogLevel::DEBUG:
-      case LogLevel::INFO:
-        std::cout << full_log_msg << std::endl;
-        break;
-      case LogLevel::WARNING:
-      case LogLevel::ERROR:
-        std::cerr << full_log_msg << std::endl;
-        break;
-      case LogLevel::DISABLED:
-      default:
-        return;
-    }
+
+    // Prefix and message go into one reused buffer, written in one call;
+    // the prefix is copied, not formatted
+    fmt::memory_buffer &buffer = line_buffer();
+    buffer.clear();
+    buffer.push_back('[');
+    buffer.append(fmt::string_view(LogLevel::log_level_to_string(level)));
+    buffer.append(fmt::string_view("] "));
+    buffer.append(fmt::string_view(logger_name_));
+    buffer.append(fmt::string_view(": "));
+    fmt::format_to(std::back_inserter(buffer), format,
+                   std::forward<Args>(args)...);
+    LoggerConfig::write(level, buffer.data(), buffer.size());
+  }
+
+  /**
+   * @brief Get the line buffer of the calling thread
+   *
+   * It keeps its capacity between calls, so formatting a line only
+   * allocates when it is longer than any line before on this thread.
+   *
+   * @return fmt::memory_buffer&
+   */
+  static fmt::memory_buffer &line_buffer() noexcept {
+    static thread_local fmt::memory_buffer buffer;
+    return buffer;
+  }
+
+  /**
+   * @brief Write a record with encoded arguments to the binary log file
+   *
+   * @param level Log level
+   * @param format Format
+   * @param args Follow-up arguments
+   */
+  template <typename... Args>
+  void log_binary(std::true_type, LogLevel::Level level, const char *format,
+                  const Args &...args) noexcept {
+    fmt::memory_buffer &buffer = line_buffer();
+    buffer.resize(detail::binary_size(args...));
+    auto *data = reinterpret_cast<uint8_t *>(buffer.data());
+    detail::binary_encode(data, args...);
+    LoggerConfig::write_binary(level, logger_name_, format, data,
+                               buffer.size());
+  }
+
+  /**
+   * @brief Runtime formats and arguments that cannot be encoded are
+   * formatted into one string argument
+   *
+   * @param level Log level
+   * @param format Format
+   * @param args Follow-up arguments
+   */
+  template <typename... Args>
+  void log_binary(std::false_type, LogLevel::Level level, const char *format,
+                  const Args &...args) noexcept {
+    static constexpr size_t cHeaderSize{detail::BinaryStringArg::size_of(0)};
+    fmt::memory_buffer &buffer = line_buffer();
+    buffer.resize(cHeaderSize);
+    fmt::format_to(std::back_inserter(buffer), format, args...);
+    auto *data = reinterpret_cast<uint8_t *>(buffer.data());
+    detail::BinaryStringArg::encode_header(data, buffer.size() - cHeaderSize);
+    LoggerConfig::write_binary(level, logger_name_, cBinaryTextFormat, data,
+                               buffer.size());
+  }
+
+  /**
+   * @brief Hand a record to DeferredLog
+   *
+   * @param level Log level
+   * @param format Format
+   * @param args Follow-up arguments
+   * @return bool true
+   */
+  template <typename... Args>
+  bool defer(std::true_type, LogLevel::Level level, const char *format,
+             const Args &...args) noexcept {
+    // Formatted here if DeferredLog stopped meanwhile
+    return DeferredLog::log(level, logger_name_, format, args...) ||
+           DeferredLog::active();
+  }
+
+  /**
+   * @brief Runtime formats and arguments that cannot be deferred are
+   * formatted immediately
+   *
+   * @return bool false
+   */
+  template <typename... Args>
+  bool defer(std::false_type, LogLevel::Level, const char *,
+             const Args &...) noexcept {
+    return false;
   }
 
-  const char *logger_name_;               ///< Logger name
-  LoggerConfig *logger_config_{nullptr};  ///< Logger config
+  const char *logger_name_;  ///< Logger name
+  LogThreshold threshold_;   ///< Resolved log level
 };
 
 }  // namespace qle
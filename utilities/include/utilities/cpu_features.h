@@ -0,0 +1,38 @@
+#ifndef UTILITIES_CPU_FEATURES_H
+#define UTILITIES_CPU_FEATURES_H
+
+namespace qle {
+
+/**
+ * @brief Runtime detection of CPU instruction set extensions
+ *
+ * Results are queried once and cached. On non-x86 targets every query
+ * returns false, so callers fall back to their scalar implementation.
+ */
+class CpuFeatures {
+ public:
+  /**
+   * @brief Check if AVX2 is supported
+   *
+   * @return true/false
+   */
+  static bool has_avx2() noexcept;
+
+  /**
+   * @brief Check if SSE4.2 is supported
+   *
+   * @return true/false
+   */
+  static bool has_sse42() noexcept;
+
+  /**
+   * @brief Check if the TSC runs at a constant rate in all power states
+   *
+   * @return true/false
+   */
+  static bool has_invariant_tsc() noexcept;
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_CPU_FEATURES_H
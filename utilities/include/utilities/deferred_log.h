@@ -0,0 +1,596 @@
+#ifndef UTILITIES_DEFERRED_LOG_H
+#define UTILITIES_DEFERRED_LOG_H
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <utilities/aligned_buffer.h>
+#include <utilities/log_config.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace qle {
+
+namespace detail {
+
+/**
+ * @brief Encoding of one deferred log argument
+ *
+ * Only specialised types can be deferred; others are formatted on the
+ * calling thread.
+ *
+ * @tparam T Argument type
+ */
+template <typename T, typename = void>
+struct DeferredArg {
+  static constexpr bool cSupported{false};  ///< Type can be deferred
+};
+
+/**
+ * @brief Strings are copied as a length followed by their bytes
+ */
+struct DeferredStringArg {
+  static constexpr bool cSupported{true};  ///< Type can be deferred
+
+  using Decoded = fmt::string_view;  ///< Type handed to fmt
+
+  /**
+   * @brief Get encoded size
+   */
+  static size_t size(const char *str, size_t length) noexcept {
+    (void)str;
+    return sizeof(uint32_t) + length;
+  }
+
+  /**
+   * @brief Encode string at \p out
+   */
+  static uint8_t *encode(uint8_t *out, const char *str,
+                         size_t length) noexcept {
+    const auto len = static_cast<uint32_t>(length);
+    memcpy(out, &len, sizeof(len));
+    memcpy(out + sizeof(len), str, length);
+    return out + sizeof(len) + length;
+  }
+
+  /**
+   * @brief Decode string at \p in and advance \p in
+   */
+  static Decoded decode(const uint8_t *&in) noexcept {
+    uint32_t len{0};
+    memcpy(&len, in, sizeof(len));
+    const auto *str = reinterpret_cast<const char *>(in + sizeof(len));
+    in += sizeof(len) + len;
+    return Decoded(str, len);
+  }
+};
+
+/**
+ * @brief C strings are copied, nullptr is encoded as "(null)"
+ */
+template <typename T>
+struct DeferredArg<
+    T, std::enable_if_t<std::is_same<T, const char *>::value ||
+                        std::is_same<T, char *>::value>>
+    : DeferredStringArg {
+  /**
+   * @brief Get encoded size
+   */
+  static size_t size(const char *str) noexcept {
+    return DeferredStringArg::size(str, str ? strlen(str) : 6);
+  }
+
+  /**
+   * @brief Encode \p str at \p out
+   */
+  static uint8_t *encode(uint8_t *out, const char *str) noexcept {
+    return str ? DeferredStringArg::encode(out, str, strlen(str))
+               : DeferredStringArg::encode(out, "(null)", 6);
+  }
+};
+
+/**
+ * @brief std::string is copied
+ */
+template <>
+struct DeferredArg<std::string> : DeferredStringArg {
+  /**
+   * @brief Get encoded size
+   */
+  static size_t size(const std::string &str) noexcept {
+    return DeferredStringArg::size(str.data(), str.size());
+  }
+
+  /**
+   * @brief Encode \p str at \p out
+   */
+  static uint8_t *encode(uint8_t *out, const std::string &str) noexcept {
+    return DeferredStringArg::encode(out, str.data(), str.size());
+  }
+};
+
+/**
+ * @brief fmt::string_view is copied, as the viewed string may change
+ */
+template <>
+struct DeferredArg<fmt::string_view> : DeferredStringArg {
+  /**
+   * @brief Get encoded size
+   */
+  static size_t size(fmt::string_view str) noexcept {
+    return DeferredStringArg::size(str.data(), str.size());
+  }
+
+  /**
+   * @brief Encode \p str at \p out
+   */
+  static uint8_t *encode(uint8_t *out, fmt::string_view str) noexcept {
+    return DeferredStringArg::encode(out, str.data(), str.size());
+  }
+};
+
+/**
+ * @brief Other trivially copyable types are copied by value
+ */
+template <typename T>
+struct DeferredArg<
+    T, std::enable_if_t<std::is_trivially_copyable<T>::value &&
+                        !std::is_same<T, const char *>::value &&
+                        !std::is_same<T, char *>::value &&
+                        !std::is_same<T, fmt::string_view>::value>> {
+  static constexpr bool cSupported{true};  ///< Type can be deferred
+
+  using Decoded = T;  ///< Type handed to fmt
+
+  /**
+   * @brief Get encoded size
+   */
+  static constexpr size_t size(const T &) noexcept { return sizeof(T); }
+
+  /**
+   * @brief Encode \p value at \p out
+   */
+  static uint8_t *encode(uint8_t *out, const T &value) noexcept {
+    memcpy(out, &value, sizeof(T));
+    return out + sizeof(T);
+  }
+
+  /**
+   * @brief Decode value at \p in and advance \p in
+   */
+  static T decode(const uint8_t *&in) noexcept {
+    T value;
+    memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return value;
+  }
+};
+
+/**
+ * @brief Check if all of Args can be deferred
+ */
+template <typename... Args>
+struct AllDeferrable : std::true_type {};
+
+/**
+ * @brief Check if all of Arg, Rest can be deferred
+ */
+template <typename Arg, typename... Rest>
+struct AllDeferrable<Arg, Rest...>
+    : std::integral_constant<bool, DeferredArg<std::decay_t<Arg>>::cSupported &&
+                                       AllDeferrable<Rest...>::value> {};
+
+/**
+ * @brief Sum of encoded argument sizes
+ */
+inline size_t deferred_size() noexcept { return 0; }
+
+/**
+ * @brief Sum of encoded argument sizes
+ */
+template <typename Arg, typename... Rest>
+size_t deferred_size(const Arg &arg, const Rest &...rest) noexcept {
+  return DeferredArg<std::decay_t<Arg>>::size(arg) + deferred_size(rest...);
+}
+
+/**
+ * @brief Encode arguments one after another
+ */
+inline uint8_t *deferred_encode(uint8_t *out) noexcept { return out; }
+
+/**
+ * @brief Encode arguments one after another
+ */
+template <typename Arg, typename... Rest>
+uint8_t *deferred_encode(uint8_t *out, const Arg &arg,
+                         const Rest &...rest) noexcept {
+  return deferred_encode(DeferredArg<std::decay_t<Arg>>::encode(out, arg),
+                         rest...);
+}
+
+/**
+ * @brief Format decoded arguments
+ */
+template <typename Tuple, size_t... I>
+std::string deferred_format(const char *format, const Tuple &values,
+                            std::index_sequence<I...>) {
+  return fmt::vformat(format, fmt::make_format_args(std::get<I>(values)...));
+}
+
+}  // namespace detail
+
+/**
+ * @brief Formats the message of a deferred record
+ *
+ * @param format Format string
+ * @param args Encoded arguments
+ * @return std::string
+ */
+using DeferredDecodeFn = std::string (*)(const char *format,
+                                         const uint8_t *args);
+
+/**
+ * @brief Flag of the size of a wrap-around padding record
+ */
+static constexpr uint32_t cDeferredPaddingFlag{0x80000000U};
+
+/**
+ * @brief Header of a deferred record, followed by the encoded arguments
+ *
+ * Wrap-around padding only has the size field, with cDeferredPaddingFlag.
+ */
+struct DeferredRecordHeader {
+  uint32_t size;            ///< Record size including header and padding
+  LogLevel::Level level;    ///< Log level
+  uint64_t ticks;           ///< LogClock time, 0 for no timestamp
+  const char *name;         ///< Logger name, static storage
+  const char *format;       ///< Format string, static storage
+  DeferredDecodeFn decode;  ///< Decoder
+};
+
+/**
+ * @brief DeferredLogBuffer is a single-producer single-consumer byte ring
+ *
+ * Each logging thread owns one; the formatter thread consumes it.
+ */
+class DeferredLogBuffer {
+ public:
+  /**
+   * @brief Construct a new DeferredLogBuffer object
+   *
+   * @param capacity Size in bytes, a power of 2
+   */
+  explicit DeferredLogBuffer(size_t capacity) noexcept
+      : buffer_(capacity), mask_(capacity - 1) {}
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  DeferredLogBuffer(const DeferredLogBuffer &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  DeferredLogBuffer(DeferredLogBuffer &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  DeferredLogBuffer &operator=(const DeferredLogBuffer &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  DeferredLogBuffer &operator=(DeferredLogBuffer &&) = delete;
+
+  /**
+   * @brief Destroy the DeferredLogBuffer object
+   */
+  ~DeferredLogBuffer() noexcept = default;
+
+  /**
+   * @brief Reserve \p size contiguous bytes, producer side
+   *
+   * @param size Record size, a multiple of 8
+   * @return uint8_t* nullptr if the buffer is full
+   */
+  uint8_t *reserve(size_t size) noexcept {
+    const size_t capacity = mask_ + 1;
+    const size_t offset = tail_ & mask_;
+    const size_t padding = (offset + size > capacity) ? capacity - offset : 0;
+    if (size + padding > capacity - (tail_ - head_cache_)) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (size + padding > capacity - (tail_ - head_cache_)) {
+        return nullptr;
+      }
+    }
+    if (padding != 0) {
+      const auto marker = static_cast<uint32_t>(padding) | cDeferredPaddingFlag;
+      memcpy(data() + offset, &marker, sizeof(marker));
+      tail_ += padding;
+    }
+    return data() + (tail_ & mask_);
+  }
+
+  /**
+   * @brief Publish the record written at the reserved bytes
+   *
+   * @param size Record size
+   */
+  void commit(size_t size) noexcept {
+    tail_ += size;
+    published_.store(tail_, std::memory_order_release);
+  }
+
+  /**
+   * @brief Hand every published record to \p consume, consumer side
+   *
+   * @tparam Func void(const DeferredRecordHeader &)
+   * @param consume Record consumer
+   * @return size_t Number of records consumed
+   */
+  template <typename Func>
+  size_t consume(Func &&consume) noexcept {
+    const size_t published = published_.load(std::memory_order_acquire);
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t count{0};
+    while (head != published) {
+      const auto *header = reinterpret_cast<const DeferredRecordHeader *>(
+          data() + (head & mask_));
+      if (header->size & cDeferredPaddingFlag) {
+        head += header->size & ~cDeferredPaddingFlag;
+        continue;
+      }
+      consume(*header);
+      count++;
+      head += header->size;
+    }
+    head_.store(head, std::memory_order_release);
+    return count;
+  }
+
+  /**
+   * @brief Check if the buffer was allocated
+   *
+   * @return true/false
+   */
+  bool valid() const noexcept { return buffer_.valid(); }
+
+  /**
+   * @brief Get capacity in bytes
+   *
+   * @return size_t
+   */
+  size_t capacity() const noexcept { return mask_ + 1; }
+
+  /**
+   * @brief Mark the producer as storing a record or done, producer side
+   *
+   * @param writing true before checking DeferredLog::active(), false once
+   * the record is committed or dropped
+   */
+  void set_writing(bool writing) noexcept {
+    writing_.store(writing, std::memory_order_release);
+  }
+
+  /**
+   * @brief Check if the producer is storing a record
+   *
+   * @return true/false
+   */
+  bool writing() const noexcept {
+    return writing_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get producer position
+   *
+   * @return size_t
+   */
+  size_t published() const noexcept {
+    return published_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get consumer position
+   *
+   * @return size_t
+   */
+  size_t consumed() const noexcept {
+    return head_.load(std::memory_order_acquire);
+  }
+
+ private:
+  /**
+   * @brief Get ring memory
+   *
+   * @return uint8_t*
+   */
+  uint8_t *data() const noexcept { return buffer_.Data(); }
+
+  AlignedBuffer buffer_;  ///< Ring memory
+  size_t mask_;           ///< Capacity - 1
+
+  size_t tail_{0};                    ///< Producer position
+  size_t head_cache_{0};              ///< Producer copy of head_
+  std::atomic<bool> writing_{false};  ///< Producer is storing a record
+  char pad0_[cCacheLineSize];         ///< Padding
+  std::atomic<size_t> published_{0};  ///< Published producer position
+  char pad1_[cCacheLineSize];         ///< Padding
+  std::atomic<size_t> head_{0};       ///< Consumer position
+};
+
+/**
+ * @brief DeferredLog moves formatting off the logging threads
+ *
+ * While active, CLogger calls with a QLE_FMT() format whose arguments are
+ * all strings or trivially copyable only store the level, logger name and
+ * format pointers, a decoder and the raw argument bytes in a per-thread
+ * ring; strings and string views are copied, other arguments are copied
+ * by value. A background thread decodes and formats the records and hands
+ * the lines to LoggerConfig::write(). Logger names and format strings must
+ * have static storage, e.g. string literals, since only their addresses
+ * are kept; CLogger formats runtime formats on the calling thread.
+ */
+class DeferredLog {
+ public:
+  /**
+   * @brief Default size of per-thread buffers in bytes
+   */
+  static constexpr size_t cDefaultBufferSize{256 * 1024};
+
+  /**
+   * @brief Start the formatter thread
+   *
+   * @param buffer_size Size of buffers of threads logging for the first
+   * time, rounded up to a power of 2
+   * @param policy BLOCK or DROP_NEWEST when a buffer is full
+   * @return bool false if already started
+   */
+  static bool start(size_t buffer_size = cDefaultBufferSize,
+                    LogOverflowPolicy policy = LogOverflowPolicy::BLOCK);
+
+  /**
+   * @brief Format what is left and stop the formatter thread
+   */
+  static void stop() noexcept;
+
+  /**
+   * @brief Check if deferred formatting is active
+   *
+   * @return true/false
+   */
+  static bool active() noexcept {
+    return active_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Wait until records logged so far are formatted and written
+   */
+  static void flush() noexcept;
+
+  /**
+   * @brief Get number of records dropped because a buffer was full
+   *
+   * @return uint64_t
+   */
+  static uint64_t dropped_count() noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Store a record in the calling thread's buffer
+   *
+   * @tparam Args Strings or trivially copyable types
+   * @param level Log level
+   * @param name Logger name
+   * @param format Format string
+   * @param args Arguments
+   * @return bool false if the record was dropped, or not stored because
+   * DeferredLog is not active
+   */
+  template <typename... Args>
+  static bool log(LogLevel::Level level, const char *name, const char *format,
+                  const Args &...args) noexcept {
+    static_assert(detail::AllDeferrable<Args...>::value,
+                  "Argument cannot be deferred");
+    const size_t size = (sizeof(DeferredRecordHeader) +
+                         detail::deferred_size(args...) + 7) &
+                        ~static_cast<size_t>(7);
+    DeferredLogBuffer *buffer = thread_buffer();
+    if (!buffer || (size > buffer->capacity())) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    // Pairs with the fence of stop(): either stop() sees the flag and waits
+    // for the commit, or this thread sees DeferredLog inactive
+    buffer->set_writing(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!active()) {
+      buffer->set_writing(false);
+      return false;
+    }
+    uint8_t *record{nullptr};
+    while (!(record = buffer->reserve(size))) {
+      if (policy_.load(std::memory_order_relaxed) != LogOverflowPolicy::BLOCK) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        buffer->set_writing(false);
+        return false;
+      }
+      if (!active()) {
+        // Stopped while waiting, the caller writes the line
+        buffer->set_writing(false);
+        return false;
+      }
+      wait_for_space();
+    }
+
+    auto *header = reinterpret_cast<DeferredRecordHeader *>(record);
+    header->size = static_cast<uint32_t>(size);
+    header->level = level;
+    header->ticks = LoggerConfig::timestamps() ? LogClock::now() : 0;
+    header->name = name;
+    header->format = format;
+    header->decode = &decode<std::decay_t<Args>...>;
+    detail::deferred_encode(record + sizeof(DeferredRecordHeader), args...);
+    buffer->commit(size);
+    buffer->set_writing(false);
+    return true;
+  }
+
+  /**
+   * @brief Format a record to a full log line
+   *
+   * @param header Record
+   * @return std::string
+   */
+  static std::string format(const DeferredRecordHeader &header);
+
+ private:
+  friend class FlightRecorder;
+
+  /**
+   * @brief Decode and format the arguments of a record
+   *
+   * @tparam Args
+   * @param format Format string
+   * @param args Encoded arguments
+   * @return std::string
+   */
+  template <typename... Args>
+  static std::string decode(const char *format, const uint8_t *args) {
+    // Braced initialisation decodes the arguments left to right
+    const std::tuple<typename detail::DeferredArg<Args>::Decoded...> values{
+        detail::DeferredArg<Args>::decode(args)...};
+    (void)args;
+    return detail::deferred_format(format, values,
+                                   std::index_sequence_for<Args...>{});
+  }
+
+  /**
+   * @brief Get the buffer of the calling thread, created on first use
+   *
+   * @return DeferredLogBuffer* nullptr if it could not be allocated
+   */
+  static DeferredLogBuffer *thread_buffer() noexcept;
+
+  /**
+   * @brief Wait for the formatter to free space
+   */
+  static void wait_for_space() noexcept;
+
+  static std::atomic<bool> active_;               ///< Formatter running
+  static std::atomic<uint64_t> dropped_;          ///< Dropped records
+  static std::atomic<LogOverflowPolicy> policy_;  ///< Overflow policy
+  static std::atomic<size_t> buffer_size_;        ///< Size of new buffers
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_DEFERRED_LOG_H
@@ -0,0 +1,241 @@
+#ifndef UTILITIES_FLIGHT_RECORDER_H
+#define UTILITIES_FLIGHT_RECORDER_H
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+
+#include <utilities/deferred_log.h>
+#include <utilities/log_clock.h>
+#include <utilities/log_config.h>
+
+namespace qle {
+
+/**
+ * @brief Size of the encoded arguments of a flight record
+ */
+static constexpr size_t cFlightRecordArgsSize{80};
+
+/**
+ * @brief Default number of records kept per thread
+ */
+static constexpr size_t cDefaultFlightRecorderSlots{1024};
+
+/**
+ * @brief Maximum number of rings, i.e. threads recording at the same time
+ */
+static constexpr size_t cMaxFlightRecorderThreads{256};
+
+/**
+ * @brief FlightRecord is one slot of a per-thread flight recorder ring
+ *
+ * The slot is guarded by its own sequence: odd while being written, even
+ * once complete, so a dump running on another thread or in a signal
+ * handler skips the slot being overwritten.
+ */
+struct FlightRecord {
+  std::atomic<uint64_t> sequence;       ///< 2 * index + 2, odd if writing
+  uint64_t ticks;                       ///< LogClock time
+  const char *name;                     ///< Logger name, static storage
+  const char *format;                   ///< Format, nullptr if args is text
+  DeferredDecodeFn decode;              ///< Decoder of args
+  LogLevel::Level level;                ///< Log level
+  uint32_t size;                        ///< Size of args used
+  uint8_t args[cFlightRecordArgsSize];  ///< Encoded arguments or text
+};
+
+/**
+ * @brief FlightRecorder keeps the last trace and debug calls of each thread
+ * in memory, whatever the log level
+ *
+ * While active, CLogger and Logger trace and debug calls also store their
+ * logger name, format pointer and encoded arguments, as DeferredLog does,
+ * in a fixed ring of the calling thread; nothing is formatted or written.
+ * Calls with a runtime format, printf-style Logger calls and arguments
+ * that cannot be encoded are stored as text, truncated to
+ * cFlightRecordArgsSize. The rings are
+ * decoded and dumped, in time order, on dump(), when an error is logged,
+ * or, for the records stored as text, on a fatal signal once
+ * install_signal_handlers() is called. Logger
+ * names must have static storage.
+ */
+class FlightRecorder {
+ public:
+  /**
+   * @brief Start recording
+   *
+   * A ring is taken on the first record of each thread and released when
+   * the thread exits, for reuse by a later thread with the records it
+   * holds. Rings are only allocated when none is free and are never freed,
+   * so a ring keeps the size it was created with.
+   *
+   * @param slots Records kept per thread, rounded up to a power of 2
+   * @param dump_on_error Dump to the log output when an error is logged
+   */
+  static void start(size_t slots = cDefaultFlightRecorderSlots,
+                    bool dump_on_error = true) noexcept;
+
+  /**
+   * @brief Stop recording; recorded calls are kept
+   */
+  static void stop() noexcept;
+
+  /**
+   * @brief Check if recording
+   *
+   * @return true/false
+   */
+  static bool active() noexcept {
+    return active_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Check if calls of \p level are recorded
+   *
+   * @param level Log level
+   * @return true/false
+   */
+  static bool records(LogLevel::Level level) noexcept {
+    return (level <= LogLevel::DEBUG) && active();
+  }
+
+  /**
+   * @brief Record a fmt-style call with a format literal and encodable
+   * arguments, e.g. if detail::CanDefer holds: the format pointer and the
+   * encoded arguments are stored
+   *
+   * @param level Log level
+   * @param name Logger name
+   * @param format Format, static storage
+   * @param args Arguments
+   */
+  template <typename... Args>
+  static void record(std::true_type, LogLevel::Level level, const char *name,
+                     const char *format, const Args &...args) noexcept {
+    const size_t size = detail::deferred_size(args...);
+    if (size > cFlightRecordArgsSize) {
+      record(std::false_type{}, level, name, format, args...);
+      return;
+    }
+    FlightRecord *slot = begin_record(level, name);
+    if (!slot) {
+      return;
+    }
+    slot->format = format;
+    slot->decode = &DeferredLog::decode<std::decay_t<Args>...>;
+    slot->size = static_cast<uint32_t>(size);
+    detail::deferred_encode(slot->args, args...);
+    end_record(slot);
+  }
+
+  /**
+   * @brief Record a fmt-style call as text
+   *
+   * @param level Log level
+   * @param name Logger name
+   * @param format Format
+   * @param args Arguments
+   */
+  template <typename... Args>
+  static void record(std::false_type, LogLevel::Level level, const char *name,
+                     const char *format, const Args &...args) noexcept {
+    FlightRecord *slot = begin_record(level, name);
+    if (!slot) {
+      return;
+    }
+    try {
+      const auto result =
+          fmt::format_to_n(reinterpret_cast<char *>(slot->args),
+                           sizeof(slot->args), format, args...);
+      slot->size =
+          static_cast<uint32_t>(std::min(result.size, sizeof(slot->args)));
+    } catch (const fmt::format_error &) {
+      slot->size = 0;
+    }
+    slot->format = nullptr;
+    slot->decode = nullptr;
+    end_record(slot);
+  }
+
+  /**
+   * @brief Record a printf-style call as text
+   *
+   * @param level Log level
+   * @param name Logger name
+   * @param format Format
+   * @param args Arguments
+   */
+  static void record_printf(LogLevel::Level level, const char *name,
+                            const char *format, va_list args) noexcept;
+
+  /**
+   * @brief Dump if an error is logged and dump_on_error is set
+   */
+  static void on_error() noexcept;
+
+  /**
+   * @brief Write the records not dumped yet to \p stream, oldest first
+   *
+   * @param stream Output stream
+   * @return size_t Number of records written
+   */
+  static size_t dump(FILE *stream) noexcept;
+
+  /**
+   * @brief Write the records not dumped yet through LoggerConfig::write(),
+   * oldest first
+   *
+   * @return size_t Number of records written
+   */
+  static size_t dump_to_log() noexcept;
+
+  /**
+   * @brief Forget the records recorded so far
+   */
+  static void clear() noexcept;
+
+  /**
+   * @brief Dump to stderr on SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT,
+   * then die of the signal
+   *
+   * The handler only makes async-signal-safe calls: it writes the records
+   * stored as text with write(2) and counts the records with encoded
+   * arguments, whose decoding is not async-signal-safe, without writing
+   * them.
+   *
+   * @return bool false if a handler could not be installed
+   */
+  static bool install_signal_handlers() noexcept;
+
+ private:
+  /**
+   * @brief Claim the next slot of the calling thread's ring
+   *
+   * @param level Log level
+   * @param name Logger name
+   * @return FlightRecord* nullptr if the thread has no ring
+   */
+  static FlightRecord *begin_record(LogLevel::Level level,
+                                    const char *name) noexcept;
+
+  /**
+   * @brief Publish a slot claimed by begin_record()
+   *
+   * @param record Slot
+   */
+  static void end_record(FlightRecord *record) noexcept;
+
+  static std::atomic<bool> active_;         ///< Recording
+  static std::atomic<bool> dump_on_error_;  ///< Dump on error
+  static std::atomic<size_t> slots_;        ///< Slots of new rings
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_FLIGHT_RECORDER_H
@@ -5,6 +5,7 @@
 #include <cstdio>
 #include <mutex>
 
+#include <utilities/flight_recorder.h>
 #include <utilities/log_config.h>
 
 namespace qle {
@@ -45,8 +46,8 @@ class Logger {
    * @param logger_name Logger name
    */
   explicit Logger(const char *logger_name) noexcept
-      : logger_name_(logger_name) {
-    logger_config_ = LoggerConfig::create();
+      : logger_name_(logger_name), threshold_(logger_name) {
+    LoggerConfig::create();
   }
 
   /**
@@ -54,6 +55,16 @@ class Logger {
    */
   ~Logger() = default;
 
+  /**
+   * @brief Check if a line of \p level would be logged by this logger
+   *
+   * @param level Log level
+   * @return true/false
+   */
+  bool is_enabled(LogLevel::Level level) const noexcept {
+    return threshold_.is_enabled(level);
+  }
+
   /**
    * @brief Log trace to stdout
    *
@@ -61,6 +72,16 @@ class Logger {
    * @param ...
    */
   void trace(const char *format, ...) noexcept {
+    if (QLE_UNLIKELY(FlightRecorder::active())) {
+      va_list args;
+      va_start(args, format);
+      FlightRecorder::record_printf(LogLevel::TRACE, logger_name_, format,
+                                    args);
+      va_end(args);
+    }
+    if (QLE_UNLIKELY(!threshold_.is_enabled(LogLevel::TRACE))) {
+      return;
+    }
     va_list args;
     va_start(args, format);
     log(LogLevel::TRACE, format, args);
@@ -74,6 +95,16 @@ class Logger {
    * @param ...
    */
   void debug(const char *format, ...) noexcept {
+    if (QLE_UNLIKELY(FlightRecorder::active())) {
+      va_list args;
+      va_start(args, format);
+      FlightRecorder::record_printf(LogLevel::DEBUG, logger_name_, format,
+                                    args);
+      va_end(args);
+    }
+    if (QLE_UNLIKELY(!threshold_.is_enabled(LogLevel::DEBUG))) {
+      return;
+    }
     va_list args;
     va_start(args, format);
     log(LogLevel::DEBUG, format, args);
@@ -87,6 +118,9 @@ class Logger {
    * @param ...
    */
   void info(const char *format, ...) noexcept {
+    if (QLE_UNLIKELY(!threshold_.is_enabled(LogLevel::INFO))) {
+      return;
+    }
     va_list args;
     va_start(args, format);
     log(LogLevel::INFO, format, args);
@@ -100,6 +134,9 @@ class Logger {
    * @param ...
    */
   void warn(const char *format, ...) noexcept {
+    if (QLE_UNLIKELY(!threshold_.is_enabled(LogLevel::WARNING))) {
+      return;
+    }
     va_list args;
     va_start(args, format);
     log(LogLevel::WARNING, format, args);
@@ -113,10 +150,32 @@ class Logger {
    * @param ...
    */
   void error(const char *format, ...) noexcept {
+    if (QLE_UNLIKELY(!threshold_.is_enabled(LogLevel::ERROR))) {
+      return;
+    }
     va_list args;
     va_start(args, format);
     log(LogLevel::ERROR, format, args);
     va_end(args);
+    if (QLE_UNLIKELY(FlightRecorder::active())) {
+      FlightRecorder::on_error();
+    }
+  }
+
+  /**
+   * @brief Log at \p level whatever the logger level
+   *
+   * Used by the statements enabled through LogSiteRegistry.
+   *
+   * @param level Log level
+   * @param format Format
+   * @param ...
+   */
+  void emit(LogLevel::Level level, const char *format, ...) noexcept {
+    va_list args;
+    va_start(args, format);
+    log(level, format, args);
+    va_end(args);
   }
 
  private:
@@ -128,8 +187,18 @@ class Logger {
    */
   void log(LogLevel::Level level, const char *format, va_list args) noexcept;
 
-  const char *logger_name_;               ///< Logger name
-  LoggerConfig *logger_config_{nullptr};  ///< Logger config
+  /**
+   * @brief Write the formatted message to the binary log file
+   *
+   * @param level Log level
+   * @param format Format
+   * @param args Arguments
+   */
+  void log_binary(LogLevel::Level level, const char *format,
+                  va_list args) noexcept;
+
+  const char *logger_name_;  ///< Logger name
+  LogThreshold threshold_;   ///< Resolved log level
 };
 
 }  // namespace qle
@@ -0,0 +1,125 @@
+#ifndef UTILITIES_LOG_CLOCK_H
+#define UTILITIES_LOG_CLOCK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace qle {
+
+/**
+ * @brief Length of a time formatted by LogClock::format(),
+ * "YYYY-MM-DD HH:MM:SS.nnnnnnnnn"
+ */
+static constexpr size_t cLogTimeLength{29};
+
+/**
+ * @brief Interval between two calibrations of the TSC
+ */
+static constexpr uint64_t cLogClockCalibrationIntervalNs{1000000000ULL};
+
+/**
+ * @brief LogClock timestamps log lines in ticks and converts them lazily
+ *
+ * With an invariant TSC a tick is one TSC cycle, read without a system
+ * call. The TSC is calibrated once at startup and again every
+ * cLogClockCalibrationIntervalNs, as conversions go: its rate against
+ * CLOCK_MONOTONIC, its offset against CLOCK_REALTIME. Without an invariant
+ * TSC, ticks are CLOCK_REALTIME nanoseconds read through the vDSO.
+ */
+class LogClock {
+ public:
+  /**
+   * @brief Get the current time in ticks
+   *
+   * @return uint64_t
+   */
+  static uint64_t now() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    if (uses_tsc()) {
+      return __rdtsc();
+    }
+#endif
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+           static_cast<uint64_t>(ts.tv_nsec);
+  }
+
+  /**
+   * @brief Convert ticks to nanoseconds since epoch
+   *
+   * Calibrates the TSC first if due.
+   *
+   * @param ticks Ticks from now()
+   * @return uint64_t
+   */
+  static uint64_t to_ns(uint64_t ticks) noexcept;
+
+  /**
+   * @brief Convert ticks to nanoseconds since epoch with the last published
+   * calibration, without calibrating or waiting for a calibration
+   *
+   * Async-signal-safe once calibrate() was called.
+   *
+   * @param ticks Ticks from now()
+   * @param ns Output nanoseconds since epoch
+   * @return bool false if a calibration is being published
+   */
+  static bool to_ns_nowait(uint64_t ticks, uint64_t &ns) noexcept;
+
+  /**
+   * @brief Calibrate the TSC against the wall clock now
+   *
+   * The first calibration measures the TSC over a few milliseconds.
+   */
+  static void calibrate() noexcept;
+
+  /**
+   * @brief Check if ticks are TSC cycles
+   *
+   * @return true/false
+   */
+  static bool uses_tsc() noexcept {
+    static const bool tsc = detect_tsc();
+    return tsc;
+  }
+
+  /**
+   * @brief Format \p ns as UTC "YYYY-MM-DD HH:MM:SS.nnnnnnnnn"
+   *
+   * The date part is cached per thread, so only the fraction is formatted
+   * for lines within the same second.
+   *
+   * @param ns Nanoseconds since epoch
+   * @param out Output of cLogTimeLength characters, not null-terminated
+   */
+  static void format(uint64_t ns, char *out) noexcept;
+
+  /**
+   * @brief Format \p ns as UTC "YYYY-MM-DD HH:MM:SS.nnnnnnnnn" without the
+   * cache
+   *
+   * Async-signal-safe.
+   *
+   * @param ns Nanoseconds since epoch
+   * @param out Output of cLogTimeLength characters, not null-terminated
+   */
+  static void format_uncached(uint64_t ns, char *out) noexcept;
+
+ private:
+  /**
+   * @brief Check if the TSC is invariant
+   *
+   * @return true/false
+   */
+  static bool detect_tsc() noexcept;
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_LOG_CLOCK_H
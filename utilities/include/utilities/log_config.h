@@ -1,12 +1,45 @@
 #ifndef UTILITIES_LOG_CONFIG_H
 #define UTILITIES_LOG_CONFIG_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <memory>
 #include <mutex>
 
+#include <utilities/log_clock.h>
+#include <utilities/log_file.h>
+#include <utilities/log_shard.h>
+
+/**
+ * @brief Lowest log level compiled in, from the QLE_LOG_ACTIVE_LEVEL CMake
+ * option
+ *
+ * Calls below it through the QLE_LOG_* macros compile to nothing, and the
+ * logger methods return before touching their arguments.
+ */
+#ifndef QLE_LOG_ACTIVE_LEVEL
+#define QLE_LOG_ACTIVE_LEVEL 0
+#endif
+
+/**
+ * @brief Branch prediction hint for a likely condition
+ */
+#define QLE_LIKELY(x) __builtin_expect(!!(x), 1)
+
+/**
+ * @brief Branch prediction hint for an unlikely condition
+ */
+#define QLE_UNLIKELY(x) __builtin_expect(!!(x), 0)
+
 namespace qle {
 
+class AsyncLogWriter;
+class BinaryLogWriter;
+class LogFlusher;
+class LogSink;
+
 /**
  * @brief LogLevel class
  */
@@ -34,6 +67,16 @@ class LogLevel {
     return ((level >= Level::TRACE) && (level <= Level::DISABLED));
   }
 
+  /**
+   * @brief Check if log level is compiled in
+   *
+   * @param level Log level
+   * @return true/false
+   */
+  static constexpr bool is_compiled_in(Level level) noexcept {
+    return level >= QLE_LOG_ACTIVE_LEVEL;
+  }
+
   /**
    * @brief Convert log level to string
    *
@@ -59,6 +102,130 @@ class LogLevel {
   }
 };
 
+/**
+ * @brief What an asynchronous logger does when its queue is full
+ */
+enum class LogOverflowPolicy {
+  BLOCK,             ///< Wait for the writer to make room
+  DROP_NEWEST,       ///< Discard the new line
+  OVERWRITE_OLDEST,  ///< Discard the oldest queued line
+};
+
+/**
+ * @brief Default number of lines queued by an asynchronous logger
+ */
+static constexpr size_t cDefaultLogQueueCapacity{1024};
+
+/**
+ * @brief Size of the stdio buffer of the log file
+ */
+static constexpr size_t cLogFileBufferSize{64 * 1024};
+
+/**
+ * @brief Size at which a block of the binary log file is written
+ */
+static constexpr size_t cDefaultBinaryLogBlockSize{64 * 1024};
+
+/**
+ * @brief Maximum number of sinks of a LoggerConfig
+ */
+static constexpr size_t cMaxLogSinks{8};
+
+/**
+ * @brief When buffered log output is flushed
+ *
+ * The default leaves flushing to stdio, plus a flush on shutdown and, in
+ * asynchronous mode, whenever the queue runs empty. Thresholds above the
+ * stdio buffer size (cLogFileBufferSize for the log file) are reached by
+ * stdio itself first.
+ *
+ * The interval flushes every output: the stdout, stderr or log file stream,
+ * the sinks and the sharded file; a mapped file needs no flush, its lines
+ * being in the page cache once appended. The byte threshold and
+ * flush_on_warning only apply to the stdout, stderr or log file stream.
+ */
+struct LogFlushPolicy {
+  size_t byte_threshold{0};      ///< Flush once this many bytes buffered
+  uint32_t interval_ms{0};       ///< Flush buffered bytes this often
+  bool flush_on_warning{false};  ///< Flush warn and error lines at once
+};
+
+/**
+ * @brief LogThreshold is the resolved log level of one named logger
+ *
+ * Every Logger and CLogger owns one. The threshold is the logger's override
+ * if one is set, the global log level otherwise, and is recomputed by
+ * LoggerConfig whenever either changes, so that the logging hot path is a
+ * single relaxed load.
+ */
+class LogThreshold {
+ public:
+  /**
+   * @brief Construct and register a new LogThreshold object
+   *
+   * @param name Logger name, must outlive the threshold
+   */
+  explicit LogThreshold(const char *name) noexcept;
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  LogThreshold(const LogThreshold &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  LogThreshold(LogThreshold &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  LogThreshold &operator=(const LogThreshold &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  LogThreshold &operator=(LogThreshold &&) = delete;
+
+  /**
+   * @brief Unregister and destroy the LogThreshold object
+   */
+  ~LogThreshold() noexcept;
+
+  /**
+   * @brief Check if a line of \p level would be logged
+   *
+   * @param level Log level
+   * @return true/false
+   */
+  bool is_enabled(LogLevel::Level level) const noexcept {
+    return LogLevel::is_compiled_in(level) &&
+           (level >= level_.load(std::memory_order_relaxed));
+  }
+
+  /**
+   * @brief Resolved log level getter
+   *
+   * @return LogLevel::Level
+   */
+  LogLevel::Level level() const noexcept {
+    return level_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Logger name getter
+   *
+   * @return const char*
+   */
+  const char *name() const noexcept { return name_; }
+
+ private:
+  friend class LoggerConfig;
+
+  const char *name_;                                        ///< Logger name
+  std::atomic<LogLevel::Level> level_{LogLevel::DISABLED};  ///< Threshold
+};
+
 /**
  * @brief Logger config
  *
@@ -103,25 +270,19 @@ class LoggerConfig {
     }
     std::lock_guard<std::mutex> lock(instance_mtx_);
     if (!instance_) {
-      instance_ = new LoggerConfig(loglevel, logfile);
+      loglevel_ = loglevel;
+      instance_ = new LoggerConfig(logfile);
+      update_thresholds();
     }
     return instance_;
   }
 
   /**
    * @brief Destroy an instance of LoggerConfig
+   *
+   * Lines still queued by an asynchronous logger are written first.
    */
-  static void destroy() {
-    if (!instance_) {
-      return;
-    }
-    std::lock_guard<std::mutex> lock(instance_mtx_);
-    if (instance_->logfile_) {
-      fclose(instance_->logfile());
-    }
-    delete instance_;
-    instance_ = nullptr;
-  }
+  static void destroy();
 
   /**
    * @brief LoggerConfig singleton instance
@@ -133,31 +294,283 @@ class LoggerConfig {
   /**
    * @brief Log level getter
    *
-   * @return LogLevel::Level
+   * @return LogLevel::Level DISABLED if there is no instance
+   */
+  static LogLevel::Level loglevel() {
+    return loglevel_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Change the global log level at runtime
+   *
+   * Loggers without an override pick the new level up immediately.
+   *
+   * @param level Log level
+   * @return bool false if there is no instance or the level is invalid
+   */
+  static bool set_loglevel(LogLevel::Level level) noexcept;
+
+  /**
+   * @brief Override the log level of the loggers named \p name
+   *
+   * Overrides are dropped when the instance is destroyed.
+   *
+   * @param name Logger name
+   * @param level Log level
+   * @return bool false if there is no instance or the level is invalid
    */
-  static LogLevel::Level loglevel() { return instance_->loglevel_; }
+  static bool set_logger_level(const char *name, LogLevel::Level level);
+
+  /**
+   * @brief Remove the override of the loggers named \p name
+   *
+   * @param name Logger name
+   */
+  static void clear_logger_level(const char *name);
+
+  /**
+   * @brief Check if a line of \p level would be logged at the global level
+   *
+   * @param level Log level
+   * @return true/false
+   */
+  static bool is_enabled(LogLevel::Level level) noexcept {
+    return LogLevel::is_compiled_in(level) &&
+           (level >= loglevel_.load(std::memory_order_relaxed));
+  }
 
   /**
    * @brief Log file getter
    *
    * @return FILE *
    */
-  static FILE *logfile() { return instance_->logfile_; }
+  static FILE *logfile() {
+    LoggerConfig *config = instance_;
+    return config ? config->logfile_ : nullptr;
+  }
+
+  /**
+   * @brief Write a formatted line to the configured output
+   *
+   * Lines go to the sinks if any were added, else to the memory-mapped
+   * file, the sharded file or the log file if open, else to stdout (trace,
+   * debug, info) or stderr (warn, error). In asynchronous mode the line is
+   * only queued.
+   *
+   * @param level Log level
+   * @param line Line, without trailing newline
+   * @param length Line length
+   * @param ticks LogClock time of the line, 0 to read it now if timestamps
+   * are on
+   */
+  static void write(LogLevel::Level level, const char *line, size_t length,
+                    uint64_t ticks = 0) noexcept;
+
+  /**
+   * @brief Switch to asynchronous mode
+   *
+   * Lines are queued in a lock-free ring and written by a background
+   * thread, so logging threads never wait for I/O or for each other.
+   *
+   * @param capacity Number of queued lines
+   * @param policy Behaviour when the queue is full
+   * @return bool false if already asynchronous or out of memory
+   */
+  bool start_async(size_t capacity = cDefaultLogQueueCapacity,
+                   LogOverflowPolicy policy = LogOverflowPolicy::BLOCK);
+
+  /**
+   * @brief Write queued lines and switch back to synchronous mode
+   */
+  void stop_async() noexcept;
+
+  /**
+   * @brief Check if in asynchronous mode
+   *
+   * @return true/false
+   */
+  bool is_async() const noexcept { return async_writer_ != nullptr; }
+
+  /**
+   * @brief Write lines to memory-mapped segments of \p path instead
+   *
+   * Appending takes no lock and makes no system call; see MappedLogFile.
+   * The file stays open until the config is destroyed.
+   *
+   * @param path Path prefix of the segments
+   * @param options Segment options
+   * @return bool false if already open or on I/O error
+   */
+  bool open_mapped_file(
+      const char *path,
+      const MappedLogFileOptions &options = MappedLogFileOptions());
+
+  /**
+   * @brief Get the memory-mapped file
+   *
+   * @return MappedLogFile* nullptr if not open
+   */
+  MappedLogFile *mapped_file() const noexcept {
+    return mapped_file_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Add an output to the sink pipeline
+   *
+   * Once a sink is added, lines go to the sinks instead of the other
+   * outputs. Each line is formatted once and handed to every sink whose
+   * level filter accepts it. Sinks stay until the config is destroyed.
+   *
+   * @param sink Sink
+   * @return LogSink* Added sink, nullptr if cMaxLogSinks sinks were added
+   */
+  LogSink *add_sink(std::unique_ptr<LogSink> sink);
+
+  /**
+   * @brief Get number of sinks
+   *
+   * @return size_t
+   */
+  size_t sink_count() const noexcept {
+    return sink_count_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Write the lines of each thread to its own shard of \p path
+   *
+   * Threads share no lock; see ShardedLogFile. Merge the shards by
+   * timestamp with qle-logmerge. The shards stay open until the config is
+   * destroyed.
+   *
+   * @param path Path prefix of the shards
+   * @return bool false if already open
+   */
+  bool open_sharded_file(const char *path);
+
+  /**
+   * @brief Get the sharded file
+   *
+   * @return ShardedLogFile* nullptr if not open
+   */
+  ShardedLogFile *sharded_file() const noexcept {
+    return sharded_file_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Write records to the binary log file \p path instead
+   *
+   * CLogger records keep their format string and type-tagged arguments
+   * unformatted; see BinaryLogWriter. Read the file with qle-logcat. The
+   * file stays open until the config is destroyed.
+   *
+   * @param path File path
+   * @param block_size Size at which a block is written
+   * @return bool false if already open or on I/O error
+   */
+  bool open_binary_file(const char *path,
+                        size_t block_size = cDefaultBinaryLogBlockSize);
+
+  /**
+   * @brief Prefix lines with their UTC time, "YYYY-MM-DD HH:MM:SS.nnnnnnnnn"
+   *
+   * Logging threads only read LogClock ticks; the conversion to wall time
+   * and the formatting happen where the line is written, on the writer
+   * thread in asynchronous mode. Off by default.
+   *
+   * @param enabled true/false
+   */
+  void set_timestamps(bool enabled) noexcept;
+
+  /**
+   * @brief Check if lines are timestamped
+   *
+   * @return true/false
+   */
+  static bool timestamps() noexcept {
+    return timestamps_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Check if a binary log file is open
+   *
+   * @return true/false
+   */
+  static bool binary_active() noexcept {
+    return binary_active_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Write a record to the binary log file
+   *
+   * @param level Log level
+   * @param name Logger name
+   * @param format Format string
+   * @param args Arguments encoded by detail::binary_encode
+   * @param size Size of encoded arguments
+   */
+  static void write_binary(LogLevel::Level level, const char *name,
+                           const char *format, const uint8_t *args,
+                           size_t size) noexcept;
+
+  /**
+   * @brief Set when buffered output is flushed
+   *
+   * A non-zero interval starts a background thread flushing the outputs.
+   *
+   * @param policy Flush policy
+   * @return bool false if the flush thread could not be started
+   */
+  bool set_flush_policy(const LogFlushPolicy &policy);
+
+  /**
+   * @brief Flush policy getter
+   *
+   * @return LogFlushPolicy
+   */
+  LogFlushPolicy flush_policy() noexcept {
+    std::lock_guard<std::mutex> guard(logmutex);
+    return flush_policy_;
+  }
+
+  /**
+   * @brief Wait until lines logged so far are written, then flush outputs
+   */
+  void flush() noexcept;
+
+  /**
+   * @brief Get number of lines discarded by DROP_NEWEST since start_async
+   *
+   * @return uint64_t
+   */
+  uint64_t dropped_count() noexcept;
+
+  /**
+   * @brief Get number of lines discarded by OVERWRITE_OLDEST since
+   * start_async
+   *
+   * @return uint64_t
+   */
+  uint64_t overwritten_count() noexcept;
 
   std::mutex logmutex;  ///< logging mutex
 
  private:
+  friend class AsyncLogWriter;
+  friend class LogFlusher;
+  friend class LogThreshold;
+
   /**
    * @brief Construct LoggerConfig object
    *
-   * @param loglevel Log level
    * @param logfile Log file
    */
-  explicit LoggerConfig(LogLevel::Level loglevel = LogLevel::INFO,
-                        const char *logfile = nullptr)
-      : loglevel_(loglevel) {
+  explicit LoggerConfig(const char *logfile = nullptr) {
     if (logfile) {
       logfile_ = fopen(logfile, "a");
+      if (logfile_) {
+        file_buffer_ = new char[cLogFileBufferSize];
+        setvbuf(logfile_, file_buffer_, _IOFBF, cLogFileBufferSize);
+      }
     }
   }
 
@@ -166,11 +579,77 @@ class LoggerConfig {
    */
   ~LoggerConfig() = default;
 
-  static LoggerConfig *instance_;   ///< LoggerConfig instance
-  static std::mutex instance_mtx_;  ///< LoggerConfig instance mutex
+  /**
+   * @brief Write a line to the output on the calling thread
+   *
+   * @param level Log level
+   * @param line Line, without trailing newline
+   * @param length Line length
+   * @param ticks LogClock time of the line, 0 for no timestamp
+   */
+  void write_line(LogLevel::Level level, const char *line, size_t length,
+                  uint64_t ticks = 0) noexcept;
+
+  /**
+   * @brief Flush the output streams
+   */
+  void flush_output() noexcept;
+
+  /**
+   * @brief Flush the sinks and the sharded file, then the output streams
+   * if bytes are buffered
+   */
+  void flush_pending() noexcept;
+
+  /**
+   * @brief Flush the output streams after a batch of asynchronous writes,
+   * unless a flush policy is set
+   */
+  void flush_batch() noexcept;
+
+  /**
+   * @brief Stop the interval flush thread
+   */
+  void stop_flusher() noexcept;
+
+  /**
+   * @brief Recompute the threshold of every registered logger
+   */
+  static void update_thresholds() noexcept;
+
+  /**
+   * @brief Resolve the log level of the loggers named \p name
+   *
+   * Must be called with the threshold registry locked.
+   *
+   * @param name Logger name
+   * @return LogLevel::Level
+   */
+  static LogLevel::Level resolve_level(const char *name);
+
+  /**
+   * @brief Wait until no thread is inside write() or write_binary()
+   */
+  static void wait_for_writers() noexcept;
+
+  static std::atomic<LoggerConfig *> instance_;   ///< LoggerConfig instance
+  static std::mutex instance_mtx_;                ///< Instance mutex
+  static std::atomic<LogLevel::Level> loglevel_;  ///< Log level
+  static std::atomic<bool> binary_active_;        ///< Binary file open
+  static std::atomic<bool> timestamps_;           ///< Timestamped lines
 
-  LogLevel::Level loglevel_{LogLevel::INFO};  ///< Log level
-  FILE *logfile_{nullptr};                    ///< Log file ptr
+  FILE *logfile_{nullptr};                                 ///< Log file ptr
+  char *file_buffer_{nullptr};                             ///< Log file buffer
+  std::atomic<AsyncLogWriter *> async_writer_{nullptr};    ///< Async writer
+  std::mutex async_mtx_;                                   ///< Mode switch lock
+  std::atomic<MappedLogFile *> mapped_file_{nullptr};      ///< Mapped file
+  std::atomic<ShardedLogFile *> sharded_file_{nullptr};    ///< Sharded file
+  std::atomic<BinaryLogWriter *> binary_writer_{nullptr};  ///< Binary file
+  LogFlusher *flusher_{nullptr};                           ///< Flush thread
+  LogSink *sinks_[cMaxLogSinks]{};                         ///< Sinks
+  std::atomic<size_t> sink_count_{0};                      ///< Sinks added
+  LogFlushPolicy flush_policy_;                            ///< Flush policy
+  size_t unflushed_bytes_{0};                              ///< Unflushed bytes
 };
 
 /**
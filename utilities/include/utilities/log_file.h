@@ -0,0 +1,201 @@
+#ifndef UTILITIES_LOG_FILE_H
+#define UTILITIES_LOG_FILE_H
+
+#include <utilities/thread.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace qle {
+
+/**
+ * @brief Default size of a memory-mapped log segment
+ */
+static constexpr size_t cDefaultLogSegmentSize{64 * 1024 * 1024};
+
+/**
+ * @brief Options of a MappedLogFile
+ *
+ * A rotation period of 0 rotates by size only; a write-back period of 0
+ * leaves writing dirty pages back to the kernel.
+ */
+struct MappedLogFileOptions {
+  size_t segment_size{cDefaultLogSegmentSize};  ///< Bytes per segment
+  uint32_t rotate_interval_ms{0};               ///< Rotation period, or 0
+  uint32_t sync_interval_ms{1000};              ///< Write-back period, or 0
+};
+
+/**
+ * @brief MappedLogFile appends lines to preallocated, memory-mapped segments
+ *
+ * The file is a series of segments named "<path>.<sequence>". Each segment
+ * is preallocated and mapped up front, and a line is appended by reserving
+ * its bytes with one atomic add and copying it into the mapping, so logging
+ * threads make no system call and take no lock.
+ *
+ * A segment is rotated when full, or when it is older than the rotation
+ * interval. The next segment is prepared ahead by a background thread, so
+ * rotating is a pointer switch. The same thread writes dirty pages back,
+ * and truncates, syncs and unmaps retired segments once their last writer
+ * is done. Readers of the live segment see zeros past the last line.
+ */
+class MappedLogFile : public Thread {
+ public:
+  /**
+   * @brief Construct a new MappedLogFile object
+   *
+   * @param path Path prefix of the segments
+   * @param options Options
+   */
+  MappedLogFile(const char *path, const MappedLogFileOptions &options) noexcept
+      : Thread("qle-log-file"), path_(path ? path : ""), options_(options) {}
+
+  /**
+   * @brief Write back and close all segments
+   */
+  ~MappedLogFile() override;
+
+  /**
+   * @brief Map the first segment and start the background thread
+   *
+   * Sequences start after the last existing segment of \p path.
+   *
+   * @return bool false on I/O error
+   */
+  bool open() noexcept;
+
+  /**
+   * @brief Append a line and a newline
+   *
+   * @param line Line
+   * @param length Line length
+   * @return bool false if the line was dropped
+   */
+  bool append(const char *line, size_t length) noexcept;
+
+  /**
+   * @brief Write the lines appended so far back to disk
+   */
+  void sync() noexcept;
+
+  /**
+   * @brief Get the sequence number of the segment being written
+   *
+   * @return uint64_t
+   */
+  uint64_t sequence() const noexcept {
+    return current_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get number of lines dropped, e.g. longer than a segment
+   *
+   * @return uint64_t
+   */
+  uint64_t dropped_count() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the path of segment \p sequence
+   *
+   * @param sequence Segment sequence number
+   * @return std::string
+   */
+  std::string segment_path(uint64_t sequence) const;
+
+ protected:
+  /**
+   * @brief Prepare, rotate, write back and retire segments until stopped
+   */
+  void run() override;
+
+ private:
+  /**
+   * @brief Number of segment slots, reused in turn
+   */
+  static constexpr size_t cSegmentSlots{4};
+
+  /**
+   * @brief Mapped segment
+   *
+   * Slots are never freed, so a writer holding a stale sequence can safely
+   * bump the writer count of a slot before finding out it moved on.
+   */
+  struct Segment {
+    std::atomic<size_t> reserved{0};               ///< Bytes reserved
+    std::atomic<size_t> writers{0};                ///< Writers inside
+    std::atomic<size_t> used{0};                   ///< Bytes once sealed
+    char *base{nullptr};                           ///< Mapping
+    int fd{-1};                                    ///< File descriptor
+    std::chrono::steady_clock::time_point opened;  ///< Time made current
+  };
+
+  /**
+   * @brief Get the slot of segment \p sequence
+   *
+   * @param sequence Segment sequence number
+   * @return Segment&
+   */
+  Segment &slot(uint64_t sequence) noexcept {
+    return segments_[sequence % cSegmentSlots];
+  }
+
+  /**
+   * @brief Enter the current segment, or nullptr if it changed meanwhile
+   *
+   * @param sequence Sequence of the entered segment
+   * @return Segment*
+   */
+  Segment *enter(uint64_t &sequence) noexcept;
+
+  /**
+   * @brief Create and map segment \p sequence, with the mutex held
+   *
+   * @param sequence Segment sequence number
+   * @return bool false on I/O error or if its slot is not retired yet
+   */
+  bool prepare(uint64_t sequence) noexcept;
+
+  /**
+   * @brief Close segment \p sequence to writers, keeping \p used bytes
+   *
+   * @param sequence Segment sequence number
+   * @param used Bytes of whole lines
+   */
+  void seal(uint64_t sequence, size_t used) noexcept;
+
+  /**
+   * @brief Switch from sealed segment \p sequence to the next one
+   *
+   * @param sequence Segment sequence number
+   * @return bool true if segment \p sequence is no longer current
+   */
+  bool rotate(uint64_t sequence) noexcept;
+
+  /**
+   * @brief Wait for the writers of segment \p sequence, then truncate,
+   * sync and unmap it
+   *
+   * @param sequence Segment sequence number
+   */
+  void retire(uint64_t sequence) noexcept;
+
+  std::string path_;                   ///< Path prefix
+  MappedLogFileOptions options_;       ///< Options
+  Segment segments_[cSegmentSlots];    ///< Segment slots
+  std::mutex mtx_;                     ///< Prepare and rotate mutex
+  std::atomic<uint64_t> current_{0};   ///< Segment being written
+  std::atomic<uint64_t> prepared_{0};  ///< Segments before it are mapped
+  std::atomic<uint64_t> sealed_{0};    ///< Last sealed segment + 1
+  std::atomic<uint64_t> retired_{0};   ///< Segments before it are closed
+  std::atomic<uint64_t> dropped_{0};   ///< Lines dropped
+  bool opened_{false};                 ///< First segment mapped
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_LOG_FILE_H
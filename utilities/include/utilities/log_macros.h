@@ -0,0 +1,185 @@
+#ifndef UTILITIES_LOG_MACROS_H
+#define UTILITIES_LOG_MACROS_H
+
+#include <utilities/clog.h>
+#include <utilities/log.h>
+#include <utilities/log_config.h>
+#include <utilities/log_rate_limit.h>
+#include <utilities/log_site.h>
+
+namespace qle {
+namespace detail {
+
+/**
+ * @brief Format of the summary of lines suppressed by a rate limit
+ */
+inline const char *suppressed_format(const Logger &) noexcept {
+  return "Suppressed %llu lines at %s:%d";
+}
+
+/**
+ * @brief Format of the summary of lines suppressed by a rate limit
+ */
+inline const char *suppressed_format(const CLogger &) noexcept {
+  return "Suppressed {} lines at {}:{}";
+}
+
+}  // namespace detail
+}  // namespace qle
+
+/**
+ * @brief First argument of a macro argument list, the format of a call
+ */
+#define QLE_LOG_FIRST_ARG(...) QLE_LOG_FIRST_ARG_(__VA_ARGS__, unused)
+#define QLE_LOG_FIRST_ARG_(first, ...) first
+
+/**
+ * @brief Log through \p logger, a Logger or CLogger, at \p level
+ *
+ * Below QLE_LOG_ACTIVE_LEVEL the condition is a constant false, so the call
+ * and its arguments are compiled out while still being type-checked. Above
+ * it, each statement has a static LogSite: a site that follows the logger
+ * level costs one branch on its mode, then arguments are only evaluated if
+ * the level is enabled at runtime or the FlightRecorder records it. Sites
+ * enabled through LogSiteRegistry log whatever the logger level.
+ */
+#define QLE_LOG_CALL(logger, level, method, ...)                             \
+  do {                                                                       \
+    if (QLE_LOG_ACTIVE_LEVEL <= (level)) {                                   \
+      static qle::LogSite qle_log_site(__FILE__, __LINE__, __func__,         \
+                                       (level));                             \
+      qle::LogSite::Mode qle_log_mode = qle_log_site.mode();                 \
+      if (QLE_UNLIKELY(qle_log_mode != qle::LogSite::DEFAULT)) {             \
+        qle_log_mode = qle::LogSiteRegistry::resolve(                        \
+            qle_log_site,                                                    \
+            qle::detail::format_c_str(QLE_LOG_FIRST_ARG(__VA_ARGS__)));      \
+      }                                                                      \
+      if (qle_log_mode == qle::LogSite::DEFAULT) {                           \
+        if (QLE_LIKELY((logger).is_enabled(level)) ||                        \
+            QLE_UNLIKELY(qle::FlightRecorder::records(level))) {             \
+          (logger).method(__VA_ARGS__);                                      \
+        }                                                                    \
+      } else if (qle_log_mode == qle::LogSite::ENABLED) {                    \
+        (logger).emit((level), __VA_ARGS__);                                 \
+      }                                                                      \
+    }                                                                        \
+  } while (0)
+
+/**
+ * @brief Log trace through \p logger
+ */
+#define QLE_LOG_TRACE(logger, ...) \
+  QLE_LOG_CALL(logger, qle::LogLevel::TRACE, trace, __VA_ARGS__)
+
+/**
+ * @brief Log debug through \p logger
+ */
+#define QLE_LOG_DEBUG(logger, ...) \
+  QLE_LOG_CALL(logger, qle::LogLevel::DEBUG, debug, __VA_ARGS__)
+
+/**
+ * @brief Log info through \p logger
+ */
+#define QLE_LOG_INFO(logger, ...) \
+  QLE_LOG_CALL(logger, qle::LogLevel::INFO, info, __VA_ARGS__)
+
+/**
+ * @brief Log warning through \p logger
+ */
+#define QLE_LOG_WARN(logger, ...) \
+  QLE_LOG_CALL(logger, qle::LogLevel::WARNING, warn, __VA_ARGS__)
+
+/**
+ * @brief Log error through \p logger
+ */
+#define QLE_LOG_ERROR(logger, ...) \
+  QLE_LOG_CALL(logger, qle::LogLevel::ERROR, error, __VA_ARGS__)
+
+/**
+ * @brief Log level of a severity token of the rate-limited macros
+ */
+#define QLE_LOG_LEVEL_TRACE qle::LogLevel::TRACE
+#define QLE_LOG_LEVEL_DEBUG qle::LogLevel::DEBUG
+#define QLE_LOG_LEVEL_INFO qle::LogLevel::INFO
+#define QLE_LOG_LEVEL_WARN qle::LogLevel::WARNING
+#define QLE_LOG_LEVEL_ERROR qle::LogLevel::ERROR
+
+/**
+ * @brief Logger method of a severity token of the rate-limited macros
+ */
+#define QLE_LOG_METHOD_TRACE trace
+#define QLE_LOG_METHOD_DEBUG debug
+#define QLE_LOG_METHOD_INFO info
+#define QLE_LOG_METHOD_WARN warn
+#define QLE_LOG_METHOD_ERROR error
+
+/**
+ * @brief Log through \p logger at \p severity, limited by a static
+ * LogRateLimit of the call site
+ *
+ * The statement has a static LogSite like QLE_LOG_CALL, so it can be
+ * toggled through LogSiteRegistry. Lines are only counted against the limit
+ * if the level or the site is enabled. At
+ * most once per summary interval, the call site also logs how many lines
+ * it suppressed, before its next allowed line or on a suppressed line, see
+ * LogRateLimit::poll_summary().
+ */
+#define QLE_LOG_LIMITED_CALL(logger, severity, policy, n, interval_ns, ...) \
+  do {                                                                     \
+    if (QLE_LOG_ACTIVE_LEVEL <= (QLE_LOG_LEVEL_##severity)) {              \
+      static qle::LogSite qle_log_site(__FILE__, __LINE__, __func__,       \
+                                       (QLE_LOG_LEVEL_##severity));        \
+      qle::LogSite::Mode qle_log_mode = qle_log_site.mode();               \
+      if (QLE_UNLIKELY(qle_log_mode != qle::LogSite::DEFAULT)) {           \
+        qle_log_mode = qle::LogSiteRegistry::resolve(                      \
+            qle_log_site,                                                  \
+            qle::detail::format_c_str(QLE_LOG_FIRST_ARG(__VA_ARGS__)));    \
+      }                                                                    \
+      if ((qle_log_mode == qle::LogSite::ENABLED) ||                       \
+          ((qle_log_mode == qle::LogSite::DEFAULT) &&                      \
+           QLE_LIKELY((logger).is_enabled(QLE_LOG_LEVEL_##severity)))) {   \
+        static qle::LogRateLimit qle_log_limit(qle::LogRateLimit::policy,  \
+                                               (n), (interval_ns));        \
+        const bool qle_log_allowed = qle_log_limit.allow();                \
+        const uint64_t qle_log_suppressed =                                \
+            qle_log_limit.poll_summary(qle_log_allowed);                   \
+        if (qle_log_suppressed != 0) {                                     \
+          (logger).emit(QLE_LOG_LEVEL_##severity,                          \
+                        qle::detail::suppressed_format(logger),            \
+                        static_cast<unsigned long long>(                   \
+                            qle_log_suppressed),                           \
+                        __FILE__, __LINE__);                               \
+        }                                                                  \
+        if (qle_log_allowed && (qle_log_mode == qle::LogSite::ENABLED)) {  \
+          (logger).emit(QLE_LOG_LEVEL_##severity, __VA_ARGS__);            \
+        } else if (qle_log_allowed) {                                      \
+          (logger).QLE_LOG_METHOD_##severity(__VA_ARGS__);                 \
+        }                                                                  \
+      }                                                                    \
+    }                                                                      \
+  } while (0)
+
+/**
+ * @brief Log one line in \p n through \p logger
+ *
+ * \p severity is one of TRACE, DEBUG, INFO, WARN or ERROR, e.g.
+ * QLE_LOG_EVERY_N(logger, ERROR, 100, "send failed: %d", err).
+ */
+#define QLE_LOG_EVERY_N(logger, severity, n, ...) \
+  QLE_LOG_LIMITED_CALL(logger, severity, EVERY_N, n, 0, __VA_ARGS__)
+
+/**
+ * @brief Log the first \p n lines through \p logger
+ */
+#define QLE_LOG_FIRST_N(logger, severity, n, ...) \
+  QLE_LOG_LIMITED_CALL(logger, severity, FIRST_N, n, 0, __VA_ARGS__)
+
+/**
+ * @brief Log at most \p n lines per second through \p logger, in bursts of
+ * up to \p n lines
+ */
+#define QLE_LOG_PER_SECOND(logger, severity, n, ...)                  \
+  QLE_LOG_LIMITED_CALL(logger, severity, TOKEN_BUCKET, n, 1000000000ULL, \
+                       __VA_ARGS__)
+
+#endif  // UTILITIES_LOG_MACROS_H
@@ -0,0 +1,179 @@
+#ifndef UTILITIES_LOG_QUEUE_H
+#define UTILITIES_LOG_QUEUE_H
+
+#include <utilities/aligned_buffer.h>
+#include <utilities/log_config.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace qle {
+
+/**
+ * @brief Maximum length of a queued log line
+ *
+ * LogQueue::push truncates longer lines, so AsyncLogWriter and AsyncLogSink
+ * do not queue them: they write them on the calling thread instead.
+ */
+static constexpr size_t cMaxLogLineLength{1000};
+
+/**
+ * @brief LogRecord is one formatted log line waiting to be written
+ */
+struct LogRecord {
+  LogLevel::Level level;         ///< Log level
+  uint64_t ticks;                ///< LogClock time, 0 for no timestamp
+  size_t length;                 ///< Line length, without terminator
+  char text[cMaxLogLineLength];  ///< Line, not null-terminated
+};
+
+/**
+ * @brief LogQueue is a bounded lock-free queue of log records
+ *
+ * Dmitry Vyukov's bounded MPMC ring: every cell carries a sequence number
+ * telling producers and consumers whose turn it is, so each side claims a
+ * cell with a single CAS on its own position counter and never waits for a
+ * lock. The logging backend uses it with many producers and one writer
+ * thread; producers may also pop to make room when overwriting the oldest
+ * records.
+ */
+class LogQueue {
+ public:
+  /**
+   * @brief Construct a new LogQueue object
+   *
+   * @param capacity Number of records, rounded up to a power of 2
+   */
+  explicit LogQueue(size_t capacity) noexcept;
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  LogQueue(const LogQueue &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  LogQueue(LogQueue &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  LogQueue &operator=(const LogQueue &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  LogQueue &operator=(LogQueue &&) = delete;
+
+  /**
+   * @brief Destroy the LogQueue object
+   */
+  ~LogQueue() noexcept = default;
+
+  /**
+   * @brief Check if the ring was allocated
+   *
+   * @return true/false
+   */
+  bool valid() const noexcept { return cells_ != nullptr; }
+
+  /**
+   * @brief Get capacity
+   *
+   * @return size_t
+   */
+  size_t capacity() const noexcept { return mask_ + 1; }
+
+  /**
+   * @brief Append a line
+   *
+   * @param level Log level
+   * @param line Line
+   * @param length Line length
+   * @param ticks LogClock time, 0 for no timestamp
+   * @return bool false if the queue is full
+   */
+  bool push(LogLevel::Level level, const char *line, size_t length,
+            uint64_t ticks = 0) noexcept;
+
+  /**
+   * @brief Remove the oldest record, handing it to \p consume
+   *
+   * @tparam Func void(const LogRecord &)
+   * @param consume Record consumer
+   * @return bool false if the queue is empty
+   */
+  template <typename Func>
+  bool pop(Func &&consume) noexcept {
+    Cell *cell{nullptr};
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      const size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const auto diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    consume(static_cast<const LogRecord &>(cell->record));
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    popped_.fetch_add(1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Get number of records pushed so far
+   *
+   * @return uint64_t
+   */
+  uint64_t pushed_count() const noexcept {
+    return enqueue_pos_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get number of records fully consumed so far
+   *
+   * @return uint64_t
+   */
+  uint64_t popped_count() const noexcept {
+    return popped_.load(std::memory_order_acquire);
+  }
+
+ private:
+  /**
+   * @brief Ring cell
+   */
+  struct Cell {
+    std::atomic<size_t> sequence;  ///< Turn of the cell
+    LogRecord record;              ///< Record
+  };
+
+  AlignedBuffer buffer_;  ///< Ring memory
+  Cell *cells_{nullptr};  ///< Ring
+  size_t mask_{0};        ///< Capacity - 1
+
+  // Counters are padded apart instead of over-aligned, as C++14 operator
+  // new does not honour extended alignment.
+  char pad0_[cCacheLineSize];           ///< Padding
+  std::atomic<size_t> enqueue_pos_{0};  ///< Next cell to produce
+  char pad1_[cCacheLineSize];           ///< Padding
+  std::atomic<size_t> dequeue_pos_{0};  ///< Next cell to consume
+  char pad2_[cCacheLineSize];           ///< Padding
+  std::atomic<uint64_t> popped_{0};     ///< Records fully consumed
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_LOG_QUEUE_H
@@ -0,0 +1,199 @@
+#ifndef UTILITIES_LOG_RATE_LIMIT_H
+#define UTILITIES_LOG_RATE_LIMIT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace qle {
+
+/**
+ * @brief Default interval between two summaries of suppressed lines
+ */
+static constexpr uint64_t cLogRateSummaryIntervalNs{10ULL * 1000000000ULL};
+
+/**
+ * @brief Number of suppressed lines between two clock reads of
+ * LogRateLimit::poll_summary()
+ */
+static constexpr uint64_t cLogRateSummaryCheckInterval{16};
+
+/**
+ * @brief LogRateLimit is the state of one rate-limited log call site
+ *
+ * It lives in a static slot of the call site, see QLE_LOG_EVERY_N and
+ * friends. Deciding whether a line passes takes one or two relaxed atomic
+ * operations; suppressed lines are counted and reported by poll_summary(),
+ * on the next line the site lets through or, while the site keeps
+ * suppressing, on every cLogRateSummaryCheckInterval-th suppressed line.
+ */
+class LogRateLimit {
+ public:
+  /**
+   * @brief Limiting mode
+   */
+  enum Mode {
+    EVERY_N,       ///< Let one line in n through
+    FIRST_N,       ///< Let the first n lines through
+    TOKEN_BUCKET,  ///< Let n lines per interval through, in bursts up to n
+  };
+
+  /**
+   * @brief Construct a new LogRateLimit object
+   *
+   * Constant arguments make the object constant-initialized, so a static
+   * slot needs no guard.
+   *
+   * @param mode Limiting mode
+   * @param n Number of lines, see Mode
+   * @param interval_ns Token bucket refill interval in nanoseconds
+   * @param summary_interval_ns Minimum interval between two summaries
+   */
+  constexpr LogRateLimit(
+      Mode mode, uint64_t n, uint64_t interval_ns = 1000000000ULL,
+      uint64_t summary_interval_ns = cLogRateSummaryIntervalNs) noexcept
+      : mode_(mode),
+        n_(n ? n : 1),
+        emission_ns_(interval_ns / (n ? n : 1)),
+        summary_interval_ns_(summary_interval_ns) {}
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  LogRateLimit(const LogRateLimit &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  LogRateLimit(LogRateLimit &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  LogRateLimit &operator=(const LogRateLimit &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  LogRateLimit &operator=(LogRateLimit &&) = delete;
+
+  /**
+   * @brief Destroy the LogRateLimit object
+   */
+  ~LogRateLimit() = default;
+
+  /**
+   * @brief Check if a line passes, counting it as suppressed otherwise
+   *
+   * @return true/false
+   */
+  bool allow() noexcept {
+    bool allowed{false};
+    switch (mode_) {
+      case EVERY_N:
+        allowed = (count_.fetch_add(1, std::memory_order_relaxed) % n_) == 0;
+        break;
+      case FIRST_N:
+        allowed = (count_.load(std::memory_order_relaxed) < n_) &&
+                  (count_.fetch_add(1, std::memory_order_relaxed) < n_);
+        break;
+      case TOKEN_BUCKET:
+        allowed = take_token();
+        break;
+    }
+    if (!allowed) {
+      suppressed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return allowed;
+  }
+
+  /**
+   * @brief Take the number of suppressed lines if a summary is due
+   *
+   * At most one caller per summary interval gets a non-zero count; the
+   * count is then reset.
+   *
+   * @return uint64_t Suppressed lines to report, 0 if none or not due
+   */
+  uint64_t summary() noexcept;
+
+  /**
+   * @brief Take the number of suppressed lines if a summary is due, for a
+   * line just decided by allow()
+   *
+   * An allowed line reads the clock if lines were suppressed since the
+   * last summary, so that a site logging again reports them; a suppressed
+   * line only reads it every cLogRateSummaryCheckInterval suppressed lines.
+   *
+   * @param allowed Result of allow() for the line
+   * @return uint64_t Suppressed lines to report, 0 if none or not due
+   */
+  uint64_t poll_summary(bool allowed) noexcept {
+    const uint64_t suppressed = suppressed_.load(std::memory_order_relaxed);
+    if ((suppressed == 0) ||
+        (!allowed && ((suppressed - 1) % cLogRateSummaryCheckInterval != 0))) {
+      return 0;
+    }
+    return summary();
+  }
+
+  /**
+   * @brief Get number of suppressed lines not reported yet
+   *
+   * @return uint64_t
+   */
+  uint64_t suppressed_count() const noexcept {
+    return suppressed_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /**
+   * @brief Get monotonic time in nanoseconds
+   *
+   * @return uint64_t
+   */
+  static uint64_t now_ns() noexcept {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+
+  /**
+   * @brief Take a token from the bucket
+   *
+   * Generic cell rate algorithm: the bucket is a single theoretical arrival
+   * time, one emission interval ahead per line, at most n - 1 intervals
+   * ahead of now.
+   *
+   * @return bool false if the bucket is empty
+   */
+  bool take_token() noexcept {
+    const uint64_t now = now_ns();
+    const uint64_t tolerance = (n_ - 1) * emission_ns_;
+    uint64_t tat = tat_.load(std::memory_order_relaxed);
+    while (true) {
+      const uint64_t start = (tat > now) ? tat : now;
+      if (start - now > tolerance) {
+        return false;
+      }
+      if (tat_.compare_exchange_weak(tat, start + emission_ns_,
+                                     std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+  }
+
+  const Mode mode_;                        ///< Limiting mode
+  const uint64_t n_;                       ///< Number of lines
+  const uint64_t emission_ns_;             ///< Interval between two tokens
+  const uint64_t summary_interval_ns_;     ///< Summary interval
+  std::atomic<uint64_t> count_{0};         ///< Lines seen
+  std::atomic<uint64_t> tat_{0};           ///< Theoretical arrival time
+  std::atomic<uint64_t> suppressed_{0};    ///< Unreported suppressed lines
+  std::atomic<uint64_t> next_summary_{0};  ///< Time a summary is due
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_LOG_RATE_LIMIT_H
@@ -0,0 +1,217 @@
+#ifndef UTILITIES_LOG_SHARD_H
+#define UTILITIES_LOG_SHARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qle {
+
+/**
+ * @brief Size of the stdio buffer of each log shard
+ */
+static constexpr size_t cLogShardBufferSize{64 * 1024};
+
+/**
+ * @brief ShardedLogFile gives each logging thread its own file
+ *
+ * The first line a thread logs takes a shard "<path>.<index>"; later lines
+ * go to that shard through its own stdio buffer, so threads share no lock
+ * and no buffer. Each line is prefixed with its LogClock time in
+ * nanoseconds since epoch, so that LogShardMerger can merge the shards
+ * into one ordered stream. When a thread exits, its shard is handed to the
+ * next thread that logs; shards stay open until the file is destroyed.
+ */
+class ShardedLogFile {
+ public:
+  /**
+   * @brief Construct a new ShardedLogFile object
+   *
+   * @param path Path prefix of the shards
+   */
+  explicit ShardedLogFile(const char *path) noexcept;
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  ShardedLogFile(const ShardedLogFile &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  ShardedLogFile(ShardedLogFile &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  ShardedLogFile &operator=(const ShardedLogFile &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  ShardedLogFile &operator=(ShardedLogFile &&) = delete;
+
+  /**
+   * @brief Flush and close all shards
+   */
+  ~ShardedLogFile();
+
+  /**
+   * @brief Append a line to the shard of the calling thread
+   *
+   * @param line Line
+   * @param length Line length
+   * @param ticks LogClock time of the line, 0 for now
+   * @return bool false if the shard could not be created
+   */
+  bool append(const char *line, size_t length, uint64_t ticks = 0) noexcept;
+
+  /**
+   * @brief Flush all shards
+   */
+  void flush() noexcept;
+
+  /**
+   * @brief Get number of shards created
+   *
+   * @return size_t
+   */
+  size_t shard_count() noexcept;
+
+  /**
+   * @brief Get the path of shard \p index
+   *
+   * @param index Shard index
+   * @return std::string
+   */
+  std::string shard_path(size_t index) const;
+
+ private:
+  /**
+   * @brief Shard of one thread
+   */
+  struct Shard {
+    FILE *file{nullptr};             ///< File
+    std::unique_ptr<char[]> buffer;  ///< stdio buffer
+  };
+
+  /**
+   * @brief Shard cached by a thread
+   */
+  struct ThreadShard {
+    uint64_t owner{0};      ///< Id of the owning ShardedLogFile
+    Shard *shard{nullptr};  ///< Shard
+
+    /**
+     * @brief Release the shard when the thread exits
+     */
+    ~ThreadShard() { release(); }
+
+    /**
+     * @brief Hand the shard back to its owner, if still alive
+     */
+    void release() noexcept;
+  };
+
+  /**
+   * @brief Get the shard of the calling thread, taking a released one or
+   * creating one on first use
+   *
+   * @return Shard* nullptr if it could not be created
+   */
+  Shard *shard() noexcept;
+
+  static thread_local ThreadShard thread_shard_;  ///< Shard of the thread
+
+  std::string path_;                            ///< Path prefix
+  uint64_t id_;                                 ///< Unique instance id
+  std::mutex mtx_;                              ///< Shard list mutex
+  std::vector<std::unique_ptr<Shard>> shards_;  ///< Shards
+  std::vector<Shard *> free_shards_;            ///< Shards of exited threads
+};
+
+/**
+ * @brief LogShardMerger merges the shards of a ShardedLogFile by timestamp
+ *
+ * Each shard is in timestamp order, so a k-way merge reading one line
+ * ahead per shard yields all lines in order.
+ */
+class LogShardMerger {
+ public:
+  /**
+   * @brief Construct a new LogShardMerger object
+   */
+  LogShardMerger() noexcept = default;
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  LogShardMerger(const LogShardMerger &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  LogShardMerger(LogShardMerger &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  LogShardMerger &operator=(const LogShardMerger &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  LogShardMerger &operator=(LogShardMerger &&) = delete;
+
+  /**
+   * @brief Destroy the LogShardMerger object
+   */
+  ~LogShardMerger() = default;
+
+  /**
+   * @brief Open the shards "<path>.0", "<path>.1", ... that exist
+   *
+   * @param path Path prefix of the shards
+   * @return size_t Number of shards opened
+   */
+  size_t open(const char *path);
+
+  /**
+   * @brief Get the next line in timestamp order
+   *
+   * @param timestamp Output timestamp in nanoseconds since epoch
+   * @param line Output line, without timestamp and newline
+   * @return bool false when all shards are exhausted
+   */
+  bool next(uint64_t &timestamp, std::string &line);
+
+ private:
+  /**
+   * @brief Read the next line of shard \p index into the heap
+   *
+   * @param index Shard index
+   */
+  void advance(size_t index);
+
+  /**
+   * @brief Pending line: timestamp and shard index
+   */
+  using Entry = std::pair<uint64_t, size_t>;
+
+  std::vector<std::unique_ptr<std::ifstream>> files_;  ///< Shards
+  std::vector<std::string> lines_;                     ///< Pending lines
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>
+      heap_;  ///< Shards by pending timestamp
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_LOG_SHARD_H
@@ -0,0 +1,319 @@
+#ifndef UTILITIES_LOG_SINK_H
+#define UTILITIES_LOG_SINK_H
+
+#include <utilities/log_config.h>
+#include <utilities/log_queue.h>
+#include <utilities/thread.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qle {
+
+/**
+ * @brief Default number of lines kept by MemoryLogSink
+ */
+static constexpr size_t cDefaultLogTailCapacity{256};
+
+/**
+ * @brief LogSink is one output of the LoggerConfig sink pipeline
+ *
+ * Every line is formatted once and the same buffer is handed to each sink
+ * whose level filter accepts it. Sinks buffer and lock on their own; wrap
+ * a slow sink in AsyncLogSink so that it does not hold up the others.
+ */
+class LogSink {
+ public:
+  /**
+   * @brief Construct a new LogSink object accepting all levels
+   */
+  LogSink() noexcept = default;
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  LogSink(const LogSink &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  LogSink(LogSink &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  LogSink &operator=(const LogSink &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  LogSink &operator=(LogSink &&) = delete;
+
+  /**
+   * @brief Destroy the LogSink object
+   */
+  virtual ~LogSink() = default;
+
+  /**
+   * @brief Write a line
+   *
+   * @param level Log level
+   * @param line Line, without trailing newline
+   * @param length Line length
+   */
+  virtual void write(LogLevel::Level level, const char *line,
+                     size_t length) noexcept = 0;
+
+  /**
+   * @brief Flush buffered lines
+   */
+  virtual void flush() noexcept {}
+
+  /**
+   * @brief Set the lowest level written by this sink
+   *
+   * @param level Log level
+   */
+  void set_level(LogLevel::Level level) noexcept {
+    level_.store(level, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the lowest level written by this sink
+   *
+   * @return LogLevel::Level
+   */
+  LogLevel::Level level() const noexcept {
+    return level_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Check if this sink writes lines of \p level
+   *
+   * @param level Log level
+   * @return true/false
+   */
+  bool accepts(LogLevel::Level level) const noexcept {
+    return (level != LogLevel::DISABLED) &&
+           (level >= level_.load(std::memory_order_relaxed));
+  }
+
+ private:
+  std::atomic<LogLevel::Level> level_{LogLevel::TRACE};  ///< Level filter
+};
+
+/**
+ * @brief ConsoleLogSink writes trace, debug and info to stdout, warn and
+ * error to stderr
+ */
+class ConsoleLogSink : public LogSink {
+ public:
+  /**
+   * @brief Construct a new ConsoleLogSink object
+   */
+  ConsoleLogSink() noexcept = default;
+
+  /**
+   * @brief Destroy the ConsoleLogSink object
+   */
+  ~ConsoleLogSink() override = default;
+
+  /**
+   * @brief Write a line to stdout or stderr
+   *
+   * @param level Log level
+   * @param line Line, without trailing newline
+   * @param length Line length
+   */
+  void write(LogLevel::Level level, const char *line,
+             size_t length) noexcept override;
+
+  /**
+   * @brief Flush stdout and stderr
+   */
+  void flush() noexcept override;
+
+ private:
+  std::mutex mtx_;  ///< Console mutex
+};
+
+/**
+ * @brief FileLogSink writes lines to a file through its own stdio buffer
+ */
+class FileLogSink : public LogSink {
+ public:
+  /**
+   * @brief Open \p path for writing, truncating it
+   *
+   * @param path File path
+   */
+  explicit FileLogSink(const char *path) noexcept;
+
+  /**
+   * @brief Flush and close the file
+   */
+  ~FileLogSink() override;
+
+  /**
+   * @brief Check if the file could be opened
+   *
+   * @return true/false
+   */
+  bool is_open() const noexcept { return file_ != nullptr; }
+
+  /**
+   * @brief Write a line to the file
+   *
+   * @param level Log level
+   * @param line Line, without trailing newline
+   * @param length Line length
+   */
+  void write(LogLevel::Level level, const char *line,
+             size_t length) noexcept override;
+
+  /**
+   * @brief Flush the file
+   */
+  void flush() noexcept override;
+
+ private:
+  std::mutex mtx_;                  ///< File mutex
+  FILE *file_{nullptr};             ///< File
+  std::unique_ptr<char[]> buffer_;  ///< stdio buffer
+};
+
+/**
+ * @brief MemoryLogSink keeps the last lines in memory
+ */
+class MemoryLogSink : public LogSink {
+ public:
+  /**
+   * @brief Construct a new MemoryLogSink object
+   *
+   * @param capacity Number of lines kept
+   */
+  explicit MemoryLogSink(size_t capacity = cDefaultLogTailCapacity) noexcept
+      : capacity_(capacity) {}
+
+  /**
+   * @brief Destroy the MemoryLogSink object
+   */
+  ~MemoryLogSink() override = default;
+
+  /**
+   * @brief Keep a line, dropping the oldest one when full
+   *
+   * @param level Log level
+   * @param line Line, without trailing newline
+   * @param length Line length
+   */
+  void write(LogLevel::Level level, const char *line,
+             size_t length) noexcept override;
+
+  /**
+   * @brief Get a copy of the kept lines, oldest first
+   *
+   * @return std::vector<std::string>
+   */
+  std::vector<std::string> lines();
+
+ private:
+  std::mutex mtx_;                 ///< Tail mutex
+  size_t capacity_;                ///< Number of lines kept
+  std::deque<std::string> lines_;  ///< Kept lines
+};
+
+/**
+ * @brief AsyncLogSink queues lines for another sink written by a
+ * background thread
+ *
+ * Writing only copies the line into a lock-free LogQueue, so a slow sink
+ * behind it cannot hold up the sinks next to it. A line longer than
+ * cMaxLogLineLength is written to the sink by the calling thread, once the
+ * lines queued before it are written.
+ */
+class AsyncLogSink : public LogSink, public Thread {
+ public:
+  /**
+   * @brief Construct a new AsyncLogSink object
+   *
+   * @param sink Sink written by the background thread
+   * @param capacity Number of queued lines
+   * @param policy Behaviour when the queue is full
+   */
+  explicit AsyncLogSink(
+      std::unique_ptr<LogSink> sink, size_t capacity = cDefaultLogQueueCapacity,
+      LogOverflowPolicy policy = LogOverflowPolicy::DROP_NEWEST) noexcept
+      : Thread("qle-log-sink"),
+        sink_(std::move(sink)),
+        queue_(capacity),
+        policy_(policy) {}
+
+  /**
+   * @brief Write the queued lines and stop the background thread
+   */
+  ~AsyncLogSink() override { deinit(); }
+
+  /**
+   * @brief Start the background thread and wait until it is draining
+   *
+   * @return bool false if the queue could not be allocated
+   */
+  bool start() noexcept;
+
+  /**
+   * @brief Queue a line, applying the overflow policy if the queue is full,
+   * or write it if it is too long for a LogRecord
+   *
+   * @param level Log level
+   * @param line Line, without trailing newline
+   * @param length Line length
+   */
+  void write(LogLevel::Level level, const char *line,
+             size_t length) noexcept override;
+
+  /**
+   * @brief Wait until all lines queued so far are written, then flush the
+   * sink
+   */
+  void flush() noexcept override;
+
+  /**
+   * @brief Get number of lines discarded because the queue was full
+   *
+   * @return uint64_t
+   */
+  uint64_t dropped_count() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  /**
+   * @brief Drain the queue until stopped, then drain what is left
+   */
+  void run() override;
+
+ private:
+  /**
+   * @brief Write all queued lines to the sink
+   *
+   * @return bool true if any line was written
+   */
+  bool drain() noexcept;
+
+  std::unique_ptr<LogSink> sink_;     ///< Sink
+  LogQueue queue_;                    ///< Queued lines
+  LogOverflowPolicy policy_;          ///< Overflow policy
+  std::atomic<bool> started_{false};  ///< Thread is draining
+  std::atomic<uint64_t> dropped_{0};  ///< Lines dropped
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_LOG_SINK_H
@@ -0,0 +1,261 @@
+#ifndef UTILITIES_LOG_SITE_H
+#define UTILITIES_LOG_SITE_H
+
+#include <utilities/log_config.h>
+#include <utilities/thread.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace qle {
+
+/**
+ * @brief Default period of the LogSiteWatcher control file check
+ */
+static constexpr uint32_t cDefaultLogSiteWatchIntervalMs{1000};
+
+/**
+ * @brief LogSite is the static metadata of one QLE_LOG_* statement
+ *
+ * A site is constant-initialized, so the statement pays no guard on each
+ * call: it loads its mode and takes one branch. The first execution finds
+ * the site UNREGISTERED and enrolls it in LogSiteRegistry, which keeps a
+ * copy of its format and applies the rules set so far.
+ */
+class LogSite {
+ public:
+  /**
+   * @brief Site mode
+   */
+  enum Mode : uint8_t {
+    UNREGISTERED,  ///< Never executed
+    DEFAULT,       ///< Follows the logger level
+    ENABLED,       ///< Logs whatever the logger level
+    DISABLED,      ///< Never logs
+  };
+
+  /**
+   * @brief Construct a new LogSite object
+   *
+   * @param file Source file
+   * @param line Source line
+   * @param function Enclosing function
+   * @param level Log level of the statement
+   */
+  constexpr LogSite(const char *file, int line, const char *function,
+                    LogLevel::Level level) noexcept
+      : file_(file), line_(line), function_(function), level_(level) {}
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  LogSite(const LogSite &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  LogSite(LogSite &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  LogSite &operator=(const LogSite &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  LogSite &operator=(LogSite &&) = delete;
+
+  /**
+   * @brief Get the mode
+   *
+   * @return Mode
+   */
+  Mode mode() const noexcept { return mode_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Get the source file
+   *
+   * @return const char*
+   */
+  const char *file() const noexcept { return file_; }
+
+  /**
+   * @brief Get the source line
+   *
+   * @return int
+   */
+  int line() const noexcept { return line_; }
+
+  /**
+   * @brief Get the enclosing function
+   *
+   * @return const char*
+   */
+  const char *function() const noexcept { return function_; }
+
+  /**
+   * @brief Get the log level of the statement
+   *
+   * @return LogLevel::Level
+   */
+  LogLevel::Level level() const noexcept { return level_; }
+
+  /**
+   * @brief Get the format, copied by LogSiteRegistry when the site is
+   * enrolled
+   *
+   * @return const char* nullptr if not enrolled
+   */
+  const char *format() const noexcept { return format_; }
+
+ private:
+  friend class LogSiteRegistry;
+
+  const char *file_;                      ///< Source file
+  int line_;                              ///< Source line
+  const char *function_;                  ///< Enclosing function
+  LogLevel::Level level_;                 ///< Log level
+  const char *format_{nullptr};           ///< Format, owned by the registry
+  std::atomic<Mode> mode_{UNREGISTERED};  ///< Mode
+  LogSite *next_{nullptr};                ///< Next enrolled site
+};
+
+/**
+ * @brief LogSiteRegistry holds the enrolled QLE_LOG_* statements and the
+ * rules that enable or disable them, like the kernel's dynamic debug
+ *
+ * A rule is "[file GLOB] [func GLOB] [line N[-M]] [format TEXT] FLAG":
+ * the file glob matches the source path, or its base name if the glob has
+ * no '/'; the format matches if it contains TEXT; FLAG is '+' to enable,
+ * '-' to disable and '=' to follow the logger level again. Rules apply to
+ * the enrolled sites and are kept for the sites enrolled later; the last
+ * matching rule wins.
+ */
+class LogSiteRegistry {
+ public:
+  /**
+   * @brief Enroll \p site, once, and apply the rules to it
+   *
+   * @param site Site
+   * @param format Format of the statement, copied
+   * @return LogSite::Mode Mode of the site
+   */
+  static LogSite::Mode enroll(LogSite &site, const char *format) noexcept;
+
+  /**
+   * @brief Get the mode of \p site, enrolling it on first use
+   *
+   * @param site Site
+   * @param format Format of the statement, copied on enrollment
+   * @return LogSite::Mode Mode of the site
+   */
+  static LogSite::Mode resolve(LogSite &site, const char *format) noexcept {
+    const LogSite::Mode mode = site.mode();
+    return (mode == LogSite::UNREGISTERED) ? enroll(site, format) : mode;
+  }
+
+  /**
+   * @brief Parse and apply a rule
+   *
+   * @param rule Rule, e.g. "file log_file.cc func open* +"
+   * @param matched Output number of enrolled sites matched, if not nullptr
+   * @return bool false if the rule is invalid
+   */
+  static bool apply(const char *rule, size_t *matched = nullptr) noexcept;
+
+  /**
+   * @brief Forget the rules and make all sites follow the logger level
+   */
+  static void reset() noexcept;
+
+  /**
+   * @brief Get number of enrolled sites
+   *
+   * @return size_t
+   */
+  static size_t size() noexcept;
+
+  /**
+   * @brief Write one "file:line [function] level =mode \"format\"" line per
+   * enrolled site to \p stream, mode being '+', '-' or '='
+   *
+   * @param stream Output stream
+   */
+  static void dump(FILE *stream) noexcept;
+};
+
+/**
+ * @brief LogSiteWatcher applies the rules of a control file whenever it
+ * changes
+ *
+ * The file holds one rule per line; empty lines and lines starting with
+ * '#' are skipped. On each change the registry is reset, so the file
+ * describes all rules in force, including those applied through the API.
+ */
+class LogSiteWatcher : public Thread {
+ public:
+  /**
+   * @brief Construct a new LogSiteWatcher object
+   *
+   * @param path Control file
+   * @param interval_ms Check period in milliseconds
+   */
+  explicit LogSiteWatcher(
+      const char *path,
+      uint32_t interval_ms = cDefaultLogSiteWatchIntervalMs) noexcept
+      : Thread("qle-log-sites"),
+        path_(path ? path : ""),
+        interval_ms_(interval_ms) {}
+
+  /**
+   * @brief Stop watching
+   */
+  ~LogSiteWatcher() override { deinit(); }
+
+  /**
+   * @brief Apply the control file, then start watching it
+   */
+  void start() noexcept;
+
+  /**
+   * @brief Reset the registry and apply the rules of the control file
+   *
+   * @return size_t Number of valid rules applied
+   */
+  size_t reload() noexcept;
+
+  /**
+   * @brief Get number of reloads, including the one of start()
+   *
+   * @return uint64_t
+   */
+  uint64_t reload_count() const noexcept {
+    return reloads_.load(std::memory_order_acquire);
+  }
+
+ protected:
+  /**
+   * @brief Reload when the modification time or size of the file changes
+   */
+  void run() override;
+
+ private:
+  /**
+   * @brief Read the modification time and size of the file
+   *
+   * @return std::string Empty if the file does not exist
+   */
+  std::string file_version() const;
+
+  std::string path_;                  ///< Control file
+  uint32_t interval_ms_;              ///< Check period in milliseconds
+  std::string version_;               ///< Version of the last reload
+  std::atomic<uint64_t> reloads_{0};  ///< Reloads
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_LOG_SITE_H
@@ -0,0 +1,149 @@
+#ifndef UTILITIES_LOG_WRITER_H
+#define UTILITIES_LOG_WRITER_H
+
+#include <utilities/log_config.h>
+#include <utilities/log_queue.h>
+#include <utilities/thread.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace qle {
+
+/**
+ * @brief AsyncLogWriter drains a LogQueue to the LoggerConfig output
+ *
+ * Logging threads push finished lines and return; the writer thread does
+ * the I/O and flushes the outputs whenever the queue runs empty. A line
+ * longer than cMaxLogLineLength is written by the logging thread, once the
+ * lines queued before it are written.
+ */
+class AsyncLogWriter : public Thread {
+ public:
+  /**
+   * @brief Construct a new AsyncLogWriter object
+   *
+   * @param config Logger config
+   * @param capacity Number of queued lines
+   * @param policy Behaviour when the queue is full
+   */
+  AsyncLogWriter(LoggerConfig &config, size_t capacity,
+                 LogOverflowPolicy policy) noexcept
+      : Thread("qle-log-writer"),
+        config_(config),
+        queue_(capacity),
+        policy_(policy) {}
+
+  /**
+   * @brief Destroy the AsyncLogWriter object
+   */
+  ~AsyncLogWriter() override { deinit(); }
+
+  /**
+   * @brief Start the writer thread and wait until it is draining
+   *
+   * @return bool false if the queue could not be allocated
+   */
+  bool start() noexcept;
+
+  /**
+   * @brief Queue a line, applying the overflow policy if the queue is full,
+   * or write it if it is too long for a LogRecord
+   *
+   * @param level Log level
+   * @param line Line
+   * @param length Line length
+   * @param ticks LogClock time, 0 for no timestamp
+   */
+  void push(LogLevel::Level level, const char *line, size_t length,
+            uint64_t ticks) noexcept;
+
+  /**
+   * @brief Wait until all lines queued so far are written
+   */
+  void flush() noexcept;
+
+  /**
+   * @brief Get number of lines discarded by DROP_NEWEST
+   *
+   * @return uint64_t
+   */
+  uint64_t dropped_count() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get number of lines discarded by OVERWRITE_OLDEST
+   *
+   * @return uint64_t
+   */
+  uint64_t overwritten_count() const noexcept {
+    return overwritten_.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  /**
+   * @brief Drain the queue until stopped, then drain what is left
+   */
+  void run() override;
+
+ private:
+  /**
+   * @brief Write all queued lines
+   *
+   * @return bool true if any line was written
+   */
+  bool drain() noexcept;
+
+  LoggerConfig &config_;                  ///< Logger config
+  LogQueue queue_;                        ///< Queued lines
+  LogOverflowPolicy policy_;              ///< Overflow policy
+  std::atomic<bool> started_{false};      ///< Writer thread is draining
+  std::atomic<uint64_t> dropped_{0};      ///< Lines dropped
+  std::atomic<uint64_t> overwritten_{0};  ///< Lines overwritten
+};
+
+/**
+ * @brief LogFlusher flushes the LoggerConfig outputs at a fixed interval
+ *
+ * Bounds how long a line can stay in a stdio buffer, including those of
+ * the sinks and shards, when flushing is otherwise left to byte thresholds.
+ */
+class LogFlusher : public Thread {
+ public:
+  /**
+   * @brief Construct a new LogFlusher object
+   *
+   * @param config Logger config
+   * @param interval_ms Flush interval in milliseconds
+   */
+  LogFlusher(LoggerConfig &config, uint32_t interval_ms) noexcept
+      : Thread("qle-log-flush"), config_(config), interval_ms_(interval_ms) {}
+
+  /**
+   * @brief Destroy the LogFlusher object
+   */
+  ~LogFlusher() override { deinit(); }
+
+  /**
+   * @brief Start the flush thread and wait until it is running
+   *
+   * @return bool false if the thread could not be started
+   */
+  bool start() noexcept;
+
+ protected:
+  /**
+   * @brief Flush the outputs every interval until stopped
+   */
+  void run() override;
+
+ private:
+  LoggerConfig &config_;              ///< Logger config
+  uint32_t interval_ms_;              ///< Flush interval in milliseconds
+  std::atomic<bool> started_{false};  ///< Flush thread is running
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_LOG_WRITER_H
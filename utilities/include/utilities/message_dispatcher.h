@@ -0,0 +1,203 @@
+#ifndef UTILITIES_MESSAGE_DISPATCHER_H
+#define UTILITIES_MESSAGE_DISPATCHER_H
+
+#include <utilities/byte_reader.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace qle {
+
+namespace detail {
+
+/**
+ * @brief Type list tag for handler resolution
+ */
+template <typename... Ts>
+struct TypeList {};
+
+/**
+ * @brief Resolve handler of \p type, no handler left
+ */
+template <typename Handler, Handler Fallback>
+constexpr Handler resolve_handler(uint8_t, TypeList<>) {
+  return Fallback;
+}
+
+/**
+ * @brief Resolve handler of \p type, first match wins
+ */
+template <typename Handler, Handler Fallback, typename H, typename... Rest>
+constexpr Handler resolve_handler(uint8_t type, TypeList<H, Rest...>) {
+  return (H::cType == type)
+             ? &H::handle
+             : resolve_handler<Handler, Fallback>(type, TypeList<Rest...>{});
+}
+
+/**
+ * @brief Check no message type is handled twice
+ */
+template <typename... Handlers>
+constexpr bool has_unique_types() {
+  const uint8_t types[] = {Handlers::cType..., 0};
+  for (size_t i = 0; i < sizeof...(Handlers); i++) {
+    for (size_t j = i + 1; j < sizeof...(Handlers); j++) {
+      if (types[i] == types[j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Build a jump table with one entry per message type
+ */
+template <typename Handler, Handler Fallback, typename... Handlers,
+          size_t... I>
+constexpr std::array<Handler, sizeof...(I)> make_dispatch_table(
+    std::index_sequence<I...>) {
+  return {{resolve_handler<Handler, Fallback>(static_cast<uint8_t>(I),
+                                               TypeList<Handlers...>{})...}};
+}
+
+}  // namespace detail
+
+/**
+ * @brief MessageDispatcher routes messages to handlers by message type
+ *
+ * Handlers are types exposing the message type they accept and a static
+ * handle function:
+ *
+ *     struct HeartbeatHandler {
+ *       static constexpr uint8_t cType{0x01};
+ *       static void handle(Session &session, ByteReader<> payload);
+ *     };
+ *
+ * The dispatcher builds a dense 256-entry jump table at compile time, so
+ * routing is a single indirect call with no switch chain or map lookup.
+ * Unknown types land on a no-op entry. Every dispatch unconditionally bumps
+ * the per-type counter, so statistics cost no extra branch. A dispatcher is
+ * meant to be owned by a single thread; counters are not synchronized.
+ *
+ * @tparam Context Caller state passed to every handler
+ * @tparam E Endianess of the payload
+ * @tparam Handlers Handler types
+ */
+template <typename Context, Endianess E, typename... Handlers>
+class MessageDispatcher {
+ public:
+  /**
+   * @brief Payload reader type
+   */
+  using Payload = ByteReader<E>;
+
+  /**
+   * @brief Handler function type
+   */
+  using Handler = void (*)(Context &context, Payload payload);
+
+  /**
+   * @brief Number of message types, one per value of the type byte
+   */
+  static constexpr size_t cTableSize{256};
+
+  /**
+   * @brief Read the message type byte and route the remaining payload
+   *
+   * @param context Caller state
+   * @param reader Reader positioned at the message header; it is consumed
+   * @return bool false if the type byte could not be read
+   */
+  bool dispatch(Context &context, Payload &reader) noexcept {
+    uint8_t type{0};
+    if (!reader.get(type)) {
+      return false;
+    }
+    dispatch(context, type, reader);
+    reader = Payload();
+    return true;
+  }
+
+  /**
+   * @brief Route an already decoded message type
+   *
+   * @param context Caller state
+   * @param type Message type
+   * @param payload Message payload
+   */
+  void dispatch(Context &context, uint8_t type, Payload payload) noexcept {
+    ++counters_[type];
+    cTable[type](context, payload);
+  }
+
+  /**
+   * @brief Check if a handler is registered for \p type
+   *
+   * @param type Message type
+   * @return true/false
+   */
+  static constexpr bool is_handled(uint8_t type) noexcept {
+    return cTable[type] != &unhandled;
+  }
+
+  /**
+   * @brief Get number of dispatched messages of \p type
+   *
+   * @param type Message type
+   * @return uint64_t
+   */
+  uint64_t count(uint8_t type) const noexcept { return counters_[type]; }
+
+  /**
+   * @brief Get number of dispatched messages without handler
+   *
+   * @return uint64_t
+   */
+  uint64_t unhandled_count() const noexcept {
+    uint64_t total{0};
+    for (size_t type = 0; type < cTableSize; type++) {
+      if (!is_handled(static_cast<uint8_t>(type))) {
+        total += counters_[type];
+      }
+    }
+    return total;
+  }
+
+  /**
+   * @brief Reset all counters
+   */
+  void reset_counters() noexcept { counters_.fill(0); }
+
+ private:
+  /**
+   * @brief Handler of message types without registered handler
+   */
+  static void unhandled(Context &, Payload) {}
+
+  static_assert(detail::has_unique_types<Handlers...>(),
+                "Each message type needs one handler");
+
+  /**
+   * @brief Jump table indexed by message type
+   */
+  static constexpr std::array<Handler, cTableSize> cTable{
+      detail::make_dispatch_table<Handler, &unhandled, Handlers...>(
+          std::make_index_sequence<cTableSize>{})};
+
+  std::array<uint64_t, cTableSize> counters_{};  ///< Per-type counters
+};
+
+template <typename Context, Endianess E, typename... Handlers>
+constexpr std::array<
+    typename MessageDispatcher<Context, E, Handlers...>::Handler,
+    MessageDispatcher<Context, E, Handlers...>::cTableSize>
+    MessageDispatcher<Context, E, Handlers...>::cTable;
+
+template <typename Context, Endianess E, typename... Handlers>
+constexpr size_t MessageDispatcher<Context, E, Handlers...>::cTableSize;
+
+}  // namespace qle
+
+#endif  // UTILITIES_MESSAGE_DISPATCHER_H
@@ -0,0 +1,513 @@
+#ifndef UTILITIES_OBJECT_POOL_H
+#define UTILITIES_OBJECT_POOL_H
+
+#include <utilities/aligned_buffer.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace qle {
+
+/**
+ * @brief ThreadSlot gives each running thread a small unique index
+ *
+ * Slots are taken on first use and given back when the thread exits, so
+ * indices stay dense and can address per-thread arrays. Threads beyond
+ * cMaxThreads get cNoSlot.
+ */
+class ThreadSlot {
+ public:
+  /**
+   * @brief Maximum number of threads holding a slot at the same time
+   */
+  static constexpr size_t cMaxThreads{64};
+
+  /**
+   * @brief Slot of a thread that could not get one
+   */
+  static constexpr size_t cNoSlot{cMaxThreads};
+
+  /**
+   * @brief Get slot of the calling thread
+   *
+   * @return size_t Slot in [0, cMaxThreads), or cNoSlot
+   */
+  static size_t id() noexcept;
+};
+
+/**
+ * @brief ObjectPool recycles objects of type T between threads
+ *
+ * Objects live in a fixed slab and are constructed and destroyed in place.
+ * Free slots are cached in a per-thread magazine, so create() and destroy()
+ * touch no shared cache line in the common case: the magazine lock is only
+ * contended while another thread steals from it. A magazine holds at most
+ * a quarter of the capacity, and at most MagazineSize slots; when it runs
+ * empty or full, half of it is exchanged with a lock-free global free list.
+ * The global list is a Treiber stack whose head packs a 32-bit slot index
+ * with a 32-bit tag bumped on every update, which makes it ABA-safe. When
+ * both the magazine and the global list are empty, create() steals half of
+ * another magazine, so slots freed by a thread that mostly frees objects
+ * allocated elsewhere, or by a thread that exited, are never stranded.
+ *
+ * @tparam T
+ * @tparam MagazineSize Number of free slots cached per thread
+ */
+template <typename T, size_t MagazineSize = 32>
+class ObjectPool {
+  static_assert(alignof(T) <= cCacheLineSize, "T is over-aligned");
+  static_assert(MagazineSize >= 2, "Magazine too small");
+
+ public:
+  /**
+   * @brief Deleter giving objects back to their pool
+   */
+  struct Deleter {
+    ObjectPool *pool;  ///< Owning pool
+
+    /**
+     * @brief Destroy \p obj
+     *
+     * @param obj Object
+     */
+    void operator()(T *obj) const noexcept { pool->destroy(obj); }
+  };
+
+  /**
+   * @brief Owning pointer to a pooled object
+   */
+  using Pointer = std::unique_ptr<T, Deleter>;
+
+  /**
+   * @brief Construct a new ObjectPool object
+   *
+   * @param capacity Maximum number of live objects
+   */
+  explicit ObjectPool(size_t capacity) noexcept;
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  ObjectPool(const ObjectPool &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  ObjectPool(ObjectPool &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  ObjectPool &operator=(const ObjectPool &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  ObjectPool &operator=(ObjectPool &&) = delete;
+
+  /**
+   * @brief Destroy the ObjectPool object
+   *
+   * All objects must have been destroyed before.
+   */
+  ~ObjectPool() noexcept = default;
+
+  /**
+   * @brief Check if the slab was allocated
+   *
+   * @return true/false
+   */
+  bool valid() const noexcept { return slots_ != nullptr; }
+
+  /**
+   * @brief Get maximum number of live objects
+   *
+   * @return size_t
+   */
+  size_t capacity() const noexcept { return capacity_; }
+
+  /**
+   * @brief Construct an object in the pool
+   *
+   * @tparam Args
+   * @param args Constructor arguments
+   * @return T* nullptr if the pool is exhausted
+   */
+  template <typename... Args>
+  T *create(Args &&...args) {
+    const uint32_t index = acquire_slot();
+    if (index == cNil) {
+      exhausted_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    try {
+      return new (&slots_[index].storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      release_slot(index);
+      throw;
+    }
+  }
+
+  /**
+   * @brief Construct an object in the pool, owned by a Pointer
+   *
+   * @tparam Args
+   * @param args Constructor arguments
+   * @return Pointer Empty if the pool is exhausted
+   */
+  template <typename... Args>
+  Pointer make(Args &&...args) {
+    return Pointer(create(std::forward<Args>(args)...), Deleter{this});
+  }
+
+  /**
+   * @brief Destroy an object and give its slot back, from any thread
+   *
+   * @param obj Object created by this pool, or nullptr
+   */
+  void destroy(T *obj) noexcept {
+    if (!obj) {
+      return;
+    }
+    obj->~T();
+    const auto *slot = reinterpret_cast<const Slot *>(obj);
+    release_slot(static_cast<uint32_t>(slot - slots_));
+  }
+
+  /**
+   * @brief Get number of objects served from a thread's magazine
+   *
+   * @return uint64_t
+   */
+  uint64_t hit_count() const noexcept;
+
+  /**
+   * @brief Get number of objects that needed the global free list
+   *
+   * @return uint64_t
+   */
+  uint64_t miss_count() const noexcept;
+
+  /**
+   * @brief Get number of failed creations
+   *
+   * @return uint64_t
+   */
+  uint64_t exhausted_count() const noexcept {
+    return exhausted_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /**
+   * @brief Index of no slot
+   */
+  static constexpr uint32_t cNil{0xFFFFFFFFU};
+
+  /**
+   * @brief Storage of one object
+   */
+  struct Slot {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    std::atomic<uint32_t> next;  ///< Next free slot in the global list
+  };
+
+  /**
+   * @brief Free slots cached by one thread
+   *
+   * The slots are guarded by locked, taken by the owning thread and by
+   * threads stealing slots. Only the owning thread writes the counters;
+   * they are atomics so that statistics can be read from anywhere.
+   */
+  struct alignas(cCacheLineSize) Magazine {
+    std::atomic<bool> locked{false};  ///< Slots are being accessed
+    size_t count{0};                  ///< Number of cached slots
+    uint32_t items[MagazineSize];     ///< Cached slot indices
+    std::atomic<uint64_t> hits{0};    ///< Served from the magazine
+    std::atomic<uint64_t> misses{0};  ///< Refilled from elsewhere
+  };
+
+  /**
+   * @brief Lock the slots of \p magazine
+   *
+   * @param magazine Magazine
+   */
+  static void lock(Magazine &magazine) noexcept {
+    while (magazine.locked.exchange(true, std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * @brief Unlock the slots of \p magazine
+   *
+   * @param magazine Magazine
+   */
+  static void unlock(Magazine &magazine) noexcept {
+    magazine.locked.store(false, std::memory_order_release);
+  }
+
+  /**
+   * @brief Increment a counter owned by the calling thread
+   *
+   * @param counter Counter
+   */
+  static void bump(std::atomic<uint64_t> &counter) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Take a free slot
+   *
+   * @return uint32_t cNil if none is left
+   */
+  uint32_t acquire_slot() noexcept;
+
+  /**
+   * @brief Give a slot back
+   *
+   * @param index Slot index
+   */
+  void release_slot(uint32_t index) noexcept;
+
+  /**
+   * @brief Take half of the slots of the first non-empty magazine, other
+   * than the magazine of \p id
+   *
+   * Locks one magazine at a time, so thieves never wait on each other.
+   *
+   * @param id ThreadSlot of the calling thread
+   * @param items Output slot indices
+   * @param max Maximum number of slots taken
+   * @return size_t Number of slots taken, 0 if all magazines are empty
+   */
+  size_t steal(size_t id, uint32_t *items, size_t max) noexcept;
+
+  /**
+   * @brief Pop one slot from the global free list
+   *
+   * @return uint32_t cNil if the list is empty
+   */
+  uint32_t pop_global() noexcept;
+
+  /**
+   * @brief Push a chain of slots linked through Slot::next
+   *
+   * @param first First slot of the chain
+   * @param last Last slot of the chain
+   */
+  void push_global(uint32_t first, uint32_t last) noexcept;
+
+  /**
+   * @brief Build a new head from \p head, bumping its tag
+   *
+   * @param head Current head
+   * @param index New first slot
+   * @return uint64_t
+   */
+  static uint64_t next_head(uint64_t head, uint32_t index) noexcept {
+    return (((head >> 32) + 1) << 32) | index;
+  }
+
+  AlignedBuffer slot_buffer_;      ///< Slab memory
+  AlignedBuffer magazine_buffer_;  ///< Magazine memory
+  Slot *slots_{nullptr};           ///< Slab
+  Magazine *magazines_{nullptr};   ///< One magazine per ThreadSlot
+  size_t capacity_{0};             ///< Number of slots
+  size_t magazine_limit_{0};       ///< Slots cached per magazine
+
+  /**
+   * @brief Global free list head, tag in the upper 32 bits
+   */
+  alignas(cCacheLineSize) std::atomic<uint64_t> head_{cNil};
+
+  std::atomic<uint64_t> unslotted_misses_{0};  ///< Misses without ThreadSlot
+  std::atomic<uint64_t> exhausted_{0};         ///< Failed creations
+};
+
+template <typename T, size_t MagazineSize>
+constexpr uint32_t ObjectPool<T, MagazineSize>::cNil;
+
+template <typename T, size_t MagazineSize>
+ObjectPool<T, MagazineSize>::ObjectPool(size_t capacity) noexcept
+    : slot_buffer_(capacity * sizeof(Slot)),
+      magazine_buffer_(ThreadSlot::cMaxThreads * sizeof(Magazine)) {
+  if ((capacity == 0) || (capacity >= cNil) || !slot_buffer_.valid() ||
+      !magazine_buffer_.valid()) {
+    return;
+  }
+
+  slots_ = reinterpret_cast<Slot *>(slot_buffer_.Data());
+  magazines_ = reinterpret_cast<Magazine *>(magazine_buffer_.Data());
+  capacity_ = capacity;
+  magazine_limit_ = std::max<size_t>(std::min(capacity / 4, MagazineSize), 2);
+
+  for (size_t i = 0; i < capacity; i++) {
+    new (&slots_[i].next) std::atomic<uint32_t>(
+        (i + 1 < capacity) ? static_cast<uint32_t>(i + 1) : cNil);
+  }
+  for (size_t i = 0; i < ThreadSlot::cMaxThreads; i++) {
+    new (&magazines_[i]) Magazine();
+  }
+  head_.store(0, std::memory_order_release);
+}
+
+template <typename T, size_t MagazineSize>
+uint64_t ObjectPool<T, MagazineSize>::hit_count() const noexcept {
+  uint64_t hits{0};
+  for (size_t i = 0; magazines_ && (i < ThreadSlot::cMaxThreads); i++) {
+    hits += magazines_[i].hits.load(std::memory_order_relaxed);
+  }
+  return hits;
+}
+
+template <typename T, size_t MagazineSize>
+uint64_t ObjectPool<T, MagazineSize>::miss_count() const noexcept {
+  uint64_t misses = unslotted_misses_.load(std::memory_order_relaxed);
+  for (size_t i = 0; magazines_ && (i < ThreadSlot::cMaxThreads); i++) {
+    misses += magazines_[i].misses.load(std::memory_order_relaxed);
+  }
+  return misses;
+}
+
+template <typename T, size_t MagazineSize>
+uint32_t ObjectPool<T, MagazineSize>::acquire_slot() noexcept {
+  if (!slots_) {
+    return cNil;
+  }
+
+  const size_t id = ThreadSlot::id();
+  if (id == ThreadSlot::cNoSlot) {
+    uint32_t index = pop_global();
+    if ((index == cNil) && (steal(id, &index, 1) == 0)) {
+      return cNil;
+    }
+    unslotted_misses_.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+
+  Magazine &magazine = magazines_[id];
+  const size_t refill = magazine_limit_ / 2;
+  uint32_t index{cNil};
+  lock(magazine);
+  if (magazine.count == 0) {
+    while (magazine.count < refill) {
+      const uint32_t popped = pop_global();
+      if (popped == cNil) {
+        break;
+      }
+      magazine.items[magazine.count++] = popped;
+    }
+    if (magazine.count != 0) {
+      bump(magazine.misses);
+      index = magazine.items[--magazine.count];
+    }
+  } else {
+    bump(magazine.hits);
+    index = magazine.items[--magazine.count];
+  }
+  unlock(magazine);
+  if (index != cNil) {
+    return index;
+  }
+
+  // The free slots are all cached by other threads
+  uint32_t stolen[MagazineSize];
+  const size_t count = steal(id, stolen, refill);
+  if (count == 0) {
+    return cNil;
+  }
+  lock(magazine);
+  for (size_t i = 1; i < count; i++) {
+    magazine.items[magazine.count++] = stolen[i];
+  }
+  bump(magazine.misses);
+  unlock(magazine);
+  return stolen[0];
+}
+
+template <typename T, size_t MagazineSize>
+void ObjectPool<T, MagazineSize>::release_slot(uint32_t index) noexcept {
+  const size_t id = ThreadSlot::id();
+  if (id == ThreadSlot::cNoSlot) {
+    push_global(index, index);
+    return;
+  }
+
+  Magazine &magazine = magazines_[id];
+  lock(magazine);
+  if (magazine.count == magazine_limit_) {
+    // Hand the upper half over to the global list as a single chain
+    const size_t first = magazine_limit_ / 2;
+    for (size_t i = first; i + 1 < magazine_limit_; i++) {
+      slots_[magazine.items[i]].next.store(magazine.items[i + 1],
+                                           std::memory_order_relaxed);
+    }
+    push_global(magazine.items[first], magazine.items[magazine_limit_ - 1]);
+    magazine.count = first;
+  }
+  magazine.items[magazine.count++] = index;
+  unlock(magazine);
+}
+
+template <typename T, size_t MagazineSize>
+size_t ObjectPool<T, MagazineSize>::steal(size_t id, uint32_t *items,
+                                          size_t max) noexcept {
+  for (size_t i = 0; i < ThreadSlot::cMaxThreads; i++) {
+    if (i == id) {
+      continue;
+    }
+    Magazine &magazine = magazines_[i];
+    lock(magazine);
+    const size_t count = std::min((magazine.count + 1) / 2, max);
+    for (size_t taken = 0; taken < count; taken++) {
+      items[taken] = magazine.items[--magazine.count];
+    }
+    unlock(magazine);
+    if (count != 0) {
+      return count;
+    }
+  }
+  return 0;
+}
+
+template <typename T, size_t MagazineSize>
+uint32_t ObjectPool<T, MagazineSize>::pop_global() noexcept {
+  uint64_t head = head_.load(std::memory_order_acquire);
+  while (true) {
+    const auto index = static_cast<uint32_t>(head);
+    if (index == cNil) {
+      return cNil;
+    }
+    // The slot may be popped and reused concurrently; the tag then makes
+    // the exchange below fail, so a stale next is never published.
+    const uint32_t next = slots_[index].next.load(std::memory_order_relaxed);
+    if (head_.compare_exchange_weak(head, next_head(head, next),
+                                    std::memory_order_acquire,
+                                    std::memory_order_acquire)) {
+      return index;
+    }
+  }
+}
+
+template <typename T, size_t MagazineSize>
+void ObjectPool<T, MagazineSize>::push_global(uint32_t first,
+                                              uint32_t last) noexcept {
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  do {
+    slots_[last].next.store(static_cast<uint32_t>(head),
+                            std::memory_order_relaxed);
+  } while (!head_.compare_exchange_weak(head, next_head(head, first),
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed));
+}
+
+}  // namespace qle
+
+#endif  // UTILITIES_OBJECT_POOL_H
@@ -0,0 +1,69 @@
+#ifndef UTILITIES_UTF8_H
+#define UTILITIES_UTF8_H
+
+#include <public_types/span.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace qle {
+
+/**
+ * @brief UTF-8 validator
+ *
+ * Validates byte sequences against RFC 3629: overlong encodings, surrogates
+ * (U+D800..U+DFFF), code points above U+10FFFF and truncated sequences are
+ * rejected. is_valid() picks the AVX2 implementation at runtime when the CPU
+ * supports it and falls back to the scalar implementation otherwise.
+ */
+class Utf8Validator {
+ public:
+  /**
+   * @brief Validate a span of bytes
+   *
+   * @param span Byte span
+   * @return true/false
+   */
+  static bool is_valid(Span<const uint8_t> span) noexcept {
+    return is_valid(span.Data(), span.Size());
+  }
+
+  /**
+   * @brief Validate a byte buffer
+   *
+   * @param data Byte buffer
+   * @param size Length of buffer
+   * @return true/false
+   */
+  static bool is_valid(const uint8_t *data, size_t size) noexcept;
+
+  /**
+   * @brief Validate a byte buffer with the scalar implementation
+   *
+   * @param data Byte buffer
+   * @param size Length of buffer
+   * @return true/false
+   */
+  static bool is_valid_scalar(const uint8_t *data, size_t size) noexcept;
+
+  /**
+   * @brief Validate a byte buffer with the AVX2 implementation
+   *
+   * Must only be called when avx2_supported() returns true.
+   *
+   * @param data Byte buffer
+   * @param size Length of buffer
+   * @return true/false
+   */
+  static bool is_valid_avx2(const uint8_t *data, size_t size) noexcept;
+
+  /**
+   * @brief Check if the AVX2 implementation is usable on this CPU
+   *
+   * @return true/false
+   */
+  static bool avx2_supported() noexcept;
+};
+
+}  // namespace qle
+
+#endif  // UTILITIES_UTF8_H
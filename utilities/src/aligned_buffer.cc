@@ -0,0 +1,118 @@
+#include <utilities/aligned_buffer.h>
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief Round \p value up to a multiple of \p alignment, a power of 2
+ */
+size_t round_up(size_t value, size_t alignment) noexcept {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+AlignedBuffer::AlignedBuffer(size_t size, size_t alignment,
+                             PageBacking backing) noexcept
+    : alignment_(alignment), backing_(backing) {
+  if ((size == 0) || (alignment == 0) || ((alignment & (alignment - 1)) != 0)) {
+    return;
+  }
+
+  if (backing == PageBacking::DEFAULT) {
+    void *ptr{nullptr};
+    if (posix_memalign(&ptr, std::max(alignment, sizeof(void *)), size) != 0) {
+      return;
+    }
+    data_ = static_cast<uint8_t *>(ptr);
+    size_ = size;
+    return;
+  }
+
+  // Huge pages need the mapping aligned to the huge page size
+  alignment_ = std::max(alignment, cHugePageSize);
+  const size_t rounded = round_up(size, cHugePageSize);
+  if ((backing == PageBacking::HUGETLB) && map(rounded, PageBacking::HUGETLB)) {
+    return;
+  }
+  map(rounded, PageBacking::TRANSPARENT_HUGE);
+}
+
+AlignedBuffer::AlignedBuffer(AlignedBuffer &&other) noexcept {
+  *this = std::move(other);
+}
+
+AlignedBuffer &AlignedBuffer::operator=(AlignedBuffer &&other) noexcept {
+  if (this != &other) {
+    reset();
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(alignment_, other.alignment_);
+    std::swap(backing_, other.backing_);
+    std::swap(mapping_, other.mapping_);
+    std::swap(mapping_size_, other.mapping_size_);
+  }
+  return *this;
+}
+
+void AlignedBuffer::reset() noexcept {
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+  } else {
+    free(data_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+}
+
+bool AlignedBuffer::map(size_t size, PageBacking backing) noexcept {
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  size_t mapping_size = size;
+
+  if (backing == PageBacking::HUGETLB) {
+#ifdef MAP_HUGETLB
+    flags |= MAP_HUGETLB;
+    // hugetlbfs mappings are huge page aligned already
+    if (alignment_ > cHugePageSize) {
+      mapping_size += alignment_;
+    }
+#else
+    return false;
+#endif
+  } else {
+    // Over-allocate so an aligned region of size bytes fits in the mapping
+    mapping_size += alignment_;
+  }
+
+  void *mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, flags,
+                       -1, 0);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  auto *aligned = reinterpret_cast<uint8_t *>(
+      round_up(reinterpret_cast<uintptr_t>(mapping), alignment_));
+#ifdef MADV_HUGEPAGE
+  if (backing == PageBacking::TRANSPARENT_HUGE) {
+    // Advisory only: without THP support the mapping uses regular pages
+    (void)madvise(aligned, size, MADV_HUGEPAGE);
+  }
+#endif
+
+  data_ = aligned;
+  size_ = size;
+  backing_ = backing;
+  mapping_ = mapping;
+  mapping_size_ = mapping_size;
+  return true;
+}
+
+}  // namespace qle
@@ -0,0 +1,66 @@
+#include <utilities/arena.h>
+
+#include <cstdlib>
+
+namespace qle {
+
+Arena::~Arena() noexcept {
+  for (void *block : blocks_) {
+    free(block);
+  }
+  for (void *block : large_blocks_) {
+    free(block);
+  }
+}
+
+Arena &Arena::thread_local_instance() noexcept {
+  static thread_local Arena arena;
+  return arena;
+}
+
+void *Arena::allocate_slow(size_t size, size_t alignment) noexcept {
+  if (size + alignment > block_size_) {
+    void *block = malloc(size + alignment);
+    if (!block) {
+      return nullptr;
+    }
+    large_blocks_.push_back(block);
+    const uintptr_t start = reinterpret_cast<uintptr_t>(block);
+    allocated_bytes_ += size;
+    return reinterpret_cast<void *>((start + alignment - 1) & ~(alignment - 1));
+  }
+
+  const size_t index = (cursor_ == 0) ? 0 : current_block_ + 1;
+  if (index == blocks_.size()) {
+    void *block = malloc(block_size_);
+    if (!block) {
+      return nullptr;
+    }
+    blocks_.push_back(block);
+  }
+  use_block(index);
+  return allocate(size, alignment);
+}
+
+void Arena::use_block(size_t index) noexcept {
+  current_block_ = index;
+  cursor_ = reinterpret_cast<uintptr_t>(blocks_[index]);
+  end_ = cursor_ + block_size_;
+}
+
+void Arena::reset() noexcept {
+  for (void *block : large_blocks_) {
+    free(block);
+  }
+  large_blocks_.clear();
+  allocated_bytes_ = 0;
+
+  if (blocks_.empty()) {
+    cursor_ = 0;
+    end_ = 0;
+  } else {
+    use_block(0);
+  }
+}
+
+}  // namespace qle
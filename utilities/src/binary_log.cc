@@ -0,0 +1,416 @@
+#include <utilities/binary_log.h>
+
+#include <fmt/format.h>
+#include <chrono>
+
+namespace qle {
+
+namespace {
+
+using Reader = ByteReader<Endianess::LITTLE_END>;
+
+/**
+ * @brief Size of a record entry without its arguments
+ */
+constexpr size_t cRecordHeaderSize{1 + 8 + 1 + 4 + 4 + 4};
+
+/**
+ * @brief Format one value with an optional format spec
+ */
+template <typename T>
+std::string format_value(const std::string &spec, const T &value) {
+  const std::string field = spec.empty() ? "{}" : "{:" + spec + "}";
+  try {
+    return fmt::vformat(field, fmt::make_format_args(value));
+  } catch (const fmt::format_error &) {
+    return fmt::vformat("{}", fmt::make_format_args(value));
+  }
+}
+
+/**
+ * @brief Format the argument at \p arg with \p spec
+ */
+std::string format_arg(Reader arg, const std::string &spec) {
+  uint8_t tag{0};
+  uint64_t bits{0};
+  arg.get(tag);
+  switch (static_cast<BinaryArgType>(tag)) {
+    case BinaryArgType::INT:
+      arg.get(bits);
+      return format_value(spec, static_cast<int64_t>(bits));
+    case BinaryArgType::UINT:
+      arg.get(bits);
+      return format_value(spec, bits);
+    case BinaryArgType::DOUBLE: {
+      double value{0};
+      arg.get(value);
+      return format_value(spec, value);
+    }
+    case BinaryArgType::BOOL:
+      arg.get(bits, 1);
+      return format_value(spec, bits != 0);
+    case BinaryArgType::CHAR:
+      arg.get(bits, 1);
+      return format_value(spec, static_cast<char>(bits));
+    case BinaryArgType::STRING: {
+      uint32_t length{0};
+      const uint8_t *data{nullptr};
+      if (!arg.get(length) || !arg.get_bytes(data, length)) {
+        return "";
+      }
+      return format_value(
+          spec,
+          fmt::string_view(reinterpret_cast<const char *>(data), length));
+    }
+    case BinaryArgType::POINTER:
+      arg.get(bits);
+      return format_value(
+          spec, reinterpret_cast<const void *>(static_cast<uintptr_t>(bits)));
+    default:
+      return "";
+  }
+}
+
+/**
+ * @brief Skip the argument at \p args
+ *
+ * @return bool false on corrupt data
+ */
+bool skip_arg(Reader &args) {
+  uint8_t tag{0};
+  if (!args.get(tag)) {
+    return false;
+  }
+  switch (static_cast<BinaryArgType>(tag)) {
+    case BinaryArgType::INT:
+    case BinaryArgType::UINT:
+    case BinaryArgType::DOUBLE:
+    case BinaryArgType::POINTER:
+      return args.skip(8);
+    case BinaryArgType::BOOL:
+    case BinaryArgType::CHAR:
+      return args.skip(1);
+    case BinaryArgType::STRING: {
+      uint32_t length{0};
+      return args.get(length) && args.skip(length);
+    }
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+bool BinaryLogWriter::open(const char *path) noexcept {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (file_ || !path) {
+    return false;
+  }
+  file_ = fopen(path, "wb");
+  if (!file_) {
+    return false;
+  }
+  // Definitions of a previous file are not in this one
+  loggers_ = detail::BinaryTextIds();
+  formats_ = detail::BinaryTextIds();
+  uint8_t header[cBinaryFileHeaderSize]{};
+  uint8_t *out = detail::store_le(header, cBinaryLogMagic, 8);
+  detail::store_le(out, cBinaryLogVersion, 4);
+  if (fwrite(header, sizeof(header), 1, file_) != 1) {
+    fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void BinaryLogWriter::close() noexcept {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (!file_) {
+    return;
+  }
+  write_block();
+  fclose(file_);
+  file_ = nullptr;
+}
+
+bool BinaryLogWriter::write(LogLevel::Level level, const char *name,
+                            const char *format, const uint8_t *args,
+                            size_t size) noexcept {
+  const auto timestamp = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (!file_ || !LogLevel::is_valid_log_level(level) ||
+      (level == LogLevel::DISABLED)) {
+    return false;
+  }
+  try {
+    const uint32_t logger_id = define(loggers_, BinaryEntryType::LOGGER, name);
+    const uint32_t format_id =
+        define(formats_, BinaryEntryType::FORMAT, format);
+    if ((record_count_ != 0) &&
+        (block_.size() + cRecordHeaderSize + size > block_size_)) {
+      write_block();
+    }
+
+    uint8_t *out = extend(cRecordHeaderSize + size);
+    *out++ = static_cast<uint8_t>(BinaryEntryType::RECORD);
+    out = detail::store_le(out, timestamp, 8);
+    *out++ = static_cast<uint8_t>(level);
+    out = detail::store_le(out, logger_id, 4);
+    out = detail::store_le(out, format_id, 4);
+    out = detail::store_le(out, size, 4);
+    memcpy(out, args, size);
+  } catch (const std::bad_alloc &) {
+    return false;
+  }
+
+  record_count_++;
+  level_mask_ |= 1U << level;
+  min_timestamp_ = std::min(min_timestamp_, timestamp);
+  max_timestamp_ = std::max(max_timestamp_, timestamp);
+  if (block_.size() >= block_size_) {
+    write_block();
+  }
+  return true;
+}
+
+void BinaryLogWriter::flush() noexcept {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (!file_) {
+    return;
+  }
+  write_block();
+  fflush(file_);
+}
+
+uint32_t BinaryLogWriter::define(detail::BinaryTextIds &ids,
+                                 BinaryEntryType type, const char *text) {
+  if (!text) {
+    text = "";
+  }
+  auto it = ids.ids.find(fmt::string_view(text));
+  if (it != ids.ids.end()) {
+    return it->second;
+  }
+
+  const auto id = static_cast<uint32_t>(ids.texts.size());
+  ids.texts.emplace_back(text);
+  const std::string &copy = ids.texts.back();
+  uint8_t *out = extend(1 + 4 + 4 + copy.size());
+  *out++ = static_cast<uint8_t>(type);
+  out = detail::store_le(out, id, 4);
+  out = detail::store_le(out, copy.size(), 4);
+  memcpy(out, copy.data(), copy.size());
+  ids.ids.emplace(fmt::string_view(copy), id);
+  definition_count_++;
+  return id;
+}
+
+uint8_t *BinaryLogWriter::extend(size_t size) {
+  const size_t offset = block_.size();
+  block_.resize(offset + size);
+  return block_.data() + offset;
+}
+
+void BinaryLogWriter::write_block() noexcept {
+  if (block_.empty()) {
+    return;
+  }
+  uint8_t header[cBinaryBlockHeaderSize]{};
+  uint8_t *out = detail::store_le(header, cBinaryBlockMagic, 4);
+  out = detail::store_le(out, block_.size(), 4);
+  out = detail::store_le(out, record_count_, 4);
+  out = detail::store_le(out, level_mask_, 4);
+  out = detail::store_le(out, record_count_ ? min_timestamp_ : 0, 8);
+  out = detail::store_le(out, max_timestamp_, 8);
+  detail::store_le(out, definition_count_, 4);
+  fwrite(header, sizeof(header), 1, file_);
+  fwrite(block_.data(), block_.size(), 1, file_);
+
+  block_.clear();
+  record_count_ = 0;
+  definition_count_ = 0;
+  level_mask_ = 0;
+  min_timestamp_ = UINT64_MAX;
+  max_timestamp_ = 0;
+}
+
+BinaryLogReader::~BinaryLogReader() {
+  if (file_) {
+    fclose(file_);
+  }
+}
+
+bool BinaryLogReader::open(const char *path) noexcept {
+  if (file_ || !path) {
+    return false;
+  }
+  file_ = fopen(path, "rb");
+  if (!file_) {
+    return false;
+  }
+  uint8_t header[cBinaryFileHeaderSize]{};
+  uint64_t magic{0};
+  uint32_t version{0};
+  Reader reader(header, sizeof(header));
+  if ((fread(header, sizeof(header), 1, file_) != 1) || !reader.get(magic) ||
+      !reader.get(version) || (magic != cBinaryLogMagic) ||
+      (version != cBinaryLogVersion)) {
+    fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool BinaryLogReader::next(BinaryLogRecord &record) {
+  while (true) {
+    if ((entries_.remaining() == 0) && !next_block()) {
+      return false;
+    }
+
+    uint8_t type{0};
+    uint32_t id{0};
+    uint32_t length{0};
+    const uint8_t *data{nullptr};
+    if (!entries_.get(type)) {
+      return false;
+    }
+    if (static_cast<BinaryEntryType>(type) != BinaryEntryType::RECORD) {
+      if (!entries_.get(id) || !entries_.get(length) ||
+          !entries_.get_bytes(data, length)) {
+        return false;
+      }
+      auto &names = (static_cast<BinaryEntryType>(type) ==
+                     BinaryEntryType::LOGGER)
+                        ? loggers_
+                        : formats_;
+      names[id].assign(reinterpret_cast<const char *>(data), length);
+      continue;
+    }
+
+    uint64_t timestamp{0};
+    uint8_t level{0};
+    uint32_t logger_id{0};
+    uint32_t format_id{0};
+    Reader args;
+    if (!entries_.get(timestamp) || !entries_.get(level) ||
+        !entries_.get(logger_id) || !entries_.get(format_id) ||
+        !entries_.get(length) || !entries_.take(args, length)) {
+      return false;
+    }
+    if (definitions_only_ || (level < filter_.min_level) ||
+        (timestamp < filter_.from) || (timestamp > filter_.to)) {
+      continue;
+    }
+
+    record.timestamp = timestamp;
+    record.level = static_cast<LogLevel::Level>(level);
+    record.logger = loggers_[logger_id];
+    record.message = render(formats_[format_id], args);
+    return true;
+  }
+}
+
+std::string BinaryLogReader::render(const std::string &format, Reader args) {
+  std::vector<Reader> values;
+  while (args.remaining() != 0) {
+    values.push_back(args.fork());
+    if (!skip_arg(args)) {
+      values.pop_back();
+      break;
+    }
+  }
+
+  std::string out;
+  size_t next_index{0};
+  for (size_t i = 0; i < format.size(); i++) {
+    const char c = format[i];
+    if ((c == '{') || (c == '}')) {
+      if ((i + 1 < format.size()) && (format[i + 1] == c)) {
+        out += c;
+        i++;
+        continue;
+      }
+    }
+    const size_t close = (c == '{') ? format.find('}', i) : std::string::npos;
+    if (close == std::string::npos) {
+      out += c;
+      continue;
+    }
+
+    const std::string field = format.substr(i + 1, close - i - 1);
+    const size_t colon = field.find(':');
+    const std::string index = field.substr(0, colon);
+    const std::string spec =
+        (colon == std::string::npos) ? "" : field.substr(colon + 1);
+    size_t arg_index{next_index++};
+    if (!index.empty()) {
+      arg_index = static_cast<size_t>(strtoul(index.c_str(), nullptr, 10));
+    }
+    out += (arg_index < values.size()) ? format_arg(values[arg_index], spec)
+                                       : "{" + field + "}";
+    i = close;
+  }
+  return out;
+}
+
+bool BinaryLogReader::next_block() {
+  while (true) {
+    uint8_t header[cBinaryBlockHeaderSize]{};
+    if (!file_ || (fread(header, sizeof(header), 1, file_) != 1)) {
+      return false;
+    }
+    Reader reader(header, sizeof(header));
+    uint32_t magic{0};
+    uint32_t size{0};
+    uint32_t record_count{0};
+    uint32_t level_mask{0};
+    uint64_t min_timestamp{0};
+    uint64_t max_timestamp{0};
+    uint32_t definition_count{0};
+    reader.get(magic);
+    reader.get(size);
+    reader.get(record_count);
+    reader.get(level_mask);
+    reader.get(min_timestamp);
+    reader.get(max_timestamp);
+    reader.get(definition_count);
+    if (magic != cBinaryBlockMagic) {
+      return false;
+    }
+
+    const bool match = (record_count != 0) &&
+                       ((level_mask >> filter_.min_level) != 0) &&
+                       (max_timestamp >= filter_.from) &&
+                       (min_timestamp <= filter_.to);
+    if (!match && (definition_count == 0)) {
+      blocks_skipped_++;
+      if (fseek(file_, size, SEEK_CUR) != 0) {
+        return false;
+      }
+      continue;
+    }
+
+    block_.resize(size);
+    if ((size != 0) && (fread(block_.data(), size, 1, file_) != 1)) {
+      return false;
+    }
+    entries_ = Reader(block_.data(), block_.size());
+    definitions_only_ = !match;
+    if (match) {
+      blocks_read_++;
+    } else {
+      blocks_skipped_++;
+    }
+    if (size != 0) {
+      return true;
+    }
+  }
+}
+
+}  // namespace qle
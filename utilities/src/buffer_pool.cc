@@ -0,0 +1,146 @@
+#include <utilities/buffer_pool.h>
+
+#include <cstdint>
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief Biggest power of 2 of a size_t
+ */
+constexpr size_t cMaxPow2{SIZE_MAX / 2 + 1};
+
+/**
+ * @brief Round \p value up to the next power of 2, at most cMaxPow2
+ */
+size_t round_up_pow2(size_t value) noexcept {
+  size_t pow2{1};
+  while ((pow2 < value) && (pow2 != cMaxPow2)) {
+    pow2 <<= 1;
+  }
+  return pow2;
+}
+
+}  // namespace
+
+PooledBuffer &PooledBuffer::operator=(PooledBuffer &&other) noexcept {
+  if (this != &other) {
+    release();
+    pool_ = other.pool_;
+    buffer_ = std::move(other.buffer_);
+    size_ = other.size_;
+    size_class_ = other.size_class_;
+    other.pool_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+void PooledBuffer::release() noexcept {
+  if (pool_ && buffer_) {
+    pool_->recycle(std::move(buffer_), size_class_);
+  }
+  buffer_.reset();
+  pool_ = nullptr;
+  size_ = 0;
+}
+
+BufferPool::BufferPool(size_t min_size, size_t max_size, size_t alignment,
+                       PageBacking backing) noexcept
+    : min_size_(round_up_pow2(min_size)),
+      alignment_(alignment),
+      backing_(backing) {
+  // Stop at cMaxPow2, as the next shift would wrap to 0
+  for (size_t size = min_size_; size <= max_size; size <<= 1) {
+    free_lists_.emplace_back();
+    if (size == cMaxPow2) {
+      break;
+    }
+  }
+}
+
+PooledBuffer BufferPool::acquire(size_t size) noexcept {
+  const size_t index = size_class(size);
+  if (index < free_lists_.size()) {
+    std::lock_guard<std::mutex> guard(mtx_);
+    auto &free_list = free_lists_[index];
+    if (!free_list.empty()) {
+      auto buffer = std::move(free_list.back());
+      free_list.pop_back();
+      reuse_count_++;
+      return PooledBuffer(this, std::move(buffer), size, index);
+    }
+  }
+
+  const size_t buffer_size =
+      (index < free_lists_.size()) ? (min_size_ << index) : size;
+  auto buffer =
+      std::make_unique<AlignedBuffer>(buffer_size, alignment_, backing_);
+  if (!buffer->valid()) {
+    return PooledBuffer();
+  }
+  {
+    std::lock_guard<std::mutex> guard(mtx_);
+    allocation_count_++;
+  }
+  return PooledBuffer(this, std::move(buffer), size, index);
+}
+
+void BufferPool::reserve(size_t size, size_t count) noexcept {
+  const size_t index = size_class(size);
+  if (index >= free_lists_.size()) {
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    auto buffer = std::make_unique<AlignedBuffer>(min_size_ << index,
+                                                  alignment_, backing_);
+    if (!buffer->valid()) {
+      return;
+    }
+    std::lock_guard<std::mutex> guard(mtx_);
+    allocation_count_++;
+    free_lists_[index].push_back(std::move(buffer));
+  }
+}
+
+size_t BufferPool::allocation_count() const noexcept {
+  std::lock_guard<std::mutex> guard(mtx_);
+  return allocation_count_;
+}
+
+size_t BufferPool::reuse_count() const noexcept {
+  std::lock_guard<std::mutex> guard(mtx_);
+  return reuse_count_;
+}
+
+size_t BufferPool::idle_count() const noexcept {
+  std::lock_guard<std::mutex> guard(mtx_);
+  size_t count{0};
+  for (const auto &free_list : free_lists_) {
+    count += free_list.size();
+  }
+  return count;
+}
+
+size_t BufferPool::size_class(size_t size) const noexcept {
+  size_t index{0};
+  for (size_t class_size = min_size_; class_size < size; class_size <<= 1) {
+    index++;
+    if ((index >= free_lists_.size()) || (class_size == cMaxPow2)) {
+      break;
+    }
+  }
+  return index;
+}
+
+void BufferPool::recycle(std::unique_ptr<AlignedBuffer> buffer,
+                         size_t size_class) noexcept {
+  if (size_class >= free_lists_.size()) {
+    return;  // Oversized buffer, freed here
+  }
+  std::lock_guard<std::mutex> guard(mtx_);
+  free_lists_[size_class].push_back(std::move(buffer));
+}
+
+}  // namespace qle
@@ -0,0 +1,341 @@
+#include <utilities/byte_algorithm.h>
+#include <utilities/cpu_features.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define QLE_BYTE_ALGORITHM_HAS_SIMD_IMPL 1
+#endif
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief Restrict \p level to what the CPU supports
+ */
+SimdLevel clamp_simd_level(SimdLevel level) noexcept {
+  return std::min(level, ByteAlgorithm::best_simd_level());
+}
+
+size_t find_byte_scalar(const uint8_t *data, size_t size, uint8_t value,
+                        size_t start) noexcept {
+  for (size_t i = start; i < size; i++) {
+    if (data[i] == value) {
+      return i;
+    }
+  }
+  return size;
+}
+
+size_t find_pattern_scalar(const uint8_t *data, size_t size,
+                           const uint8_t *pattern, size_t pattern_size,
+                           size_t start) noexcept {
+  for (size_t i = start; i + pattern_size <= size; i++) {
+    if ((data[i] == pattern[0]) &&
+        (memcmp(data + i + 1, pattern + 1, pattern_size - 1) == 0)) {
+      return i;
+    }
+  }
+  return size;
+}
+
+size_t count_scalar(const uint8_t *data, size_t size, uint8_t value,
+                    size_t start) noexcept {
+  size_t total{0};
+  for (size_t i = start; i < size; i++) {
+    total += (data[i] == value) ? 1 : 0;
+  }
+  return total;
+}
+
+size_t mismatch_scalar(const uint8_t *lhs, const uint8_t *rhs, size_t size,
+                       size_t start) noexcept {
+  for (size_t i = start; i < size; i++) {
+    if (lhs[i] != rhs[i]) {
+      return i;
+    }
+  }
+  return size;
+}
+
+#if defined(QLE_BYTE_ALGORITHM_HAS_SIMD_IMPL)
+
+/**
+ * @brief Check the candidate positions of \p mask for a full pattern match
+ *
+ * Candidates already match the first and last pattern byte.
+ *
+ * @return size_t Index of the match, or \p size if none
+ */
+size_t verify_candidates(uint32_t mask, const uint8_t *data, size_t size,
+                         size_t offset, const uint8_t *pattern,
+                         size_t pattern_size) noexcept {
+  while (mask != 0) {
+    const size_t pos = offset + static_cast<size_t>(__builtin_ctz(mask));
+    if ((pattern_size <= 2) ||
+        (memcmp(data + pos + 1, pattern + 1, pattern_size - 2) == 0)) {
+      return pos;
+    }
+    mask &= mask - 1;
+  }
+  return size;
+}
+
+__attribute__((target("avx2"))) size_t find_byte_avx2(const uint8_t *data,
+                                                      size_t size,
+                                                      uint8_t value) noexcept {
+  const __m256i needle = _mm256_set1_epi8(static_cast<char>(value));
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    const uint32_t mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return find_byte_scalar(data, size, value, i);
+}
+
+__attribute__((target("sse4.2"))) size_t find_byte_sse42(
+    const uint8_t *data, size_t size, uint8_t value) noexcept {
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    const uint32_t mask =
+        static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return find_byte_scalar(data, size, value, i);
+}
+
+// Pattern search compares the first and last pattern byte at 32 (or 16)
+// candidate positions at once and only verifies the middle of the pattern
+// where both match (W. Mula, "SIMD-friendly algorithms for substring
+// searching").
+__attribute__((target("avx2"))) size_t find_pattern_avx2(
+    const uint8_t *data, size_t size, const uint8_t *pattern,
+    size_t pattern_size) noexcept {
+  const __m256i first = _mm256_set1_epi8(static_cast<char>(pattern[0]));
+  const __m256i last =
+      _mm256_set1_epi8(static_cast<char>(pattern[pattern_size - 1]));
+  size_t i = 0;
+  for (; i + pattern_size - 1 + 32 <= size; i += 32) {
+    const __m256i block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    const __m256i block_last = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(data + i + pattern_size - 1));
+    const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                         _mm256_cmpeq_epi8(block_last, last))));
+    const size_t pos =
+        verify_candidates(mask, data, size, i, pattern, pattern_size);
+    if (pos != size) {
+      return pos;
+    }
+  }
+  return find_pattern_scalar(data, size, pattern, pattern_size, i);
+}
+
+__attribute__((target("sse4.2"))) size_t find_pattern_sse42(
+    const uint8_t *data, size_t size, const uint8_t *pattern,
+    size_t pattern_size) noexcept {
+  const __m128i first = _mm_set1_epi8(static_cast<char>(pattern[0]));
+  const __m128i last =
+      _mm_set1_epi8(static_cast<char>(pattern[pattern_size - 1]));
+  size_t i = 0;
+  for (; i + pattern_size - 1 + 16 <= size; i += 16) {
+    const __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    const __m128i block_last = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + i + pattern_size - 1));
+    const uint32_t mask = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                        _mm_cmpeq_epi8(block_last, last))));
+    const size_t pos =
+        verify_candidates(mask, data, size, i, pattern, pattern_size);
+    if (pos != size) {
+      return pos;
+    }
+  }
+  return find_pattern_scalar(data, size, pattern, pattern_size, i);
+}
+
+// Counting subtracts the 0xFF compare results from per-byte accumulators,
+// which would overflow after 255 blocks, so the accumulators are folded
+// into 64-bit sums with SAD at least every 255 blocks.
+__attribute__((target("avx2"))) size_t count_avx2(const uint8_t *data,
+                                                  size_t size,
+                                                  uint8_t value) noexcept {
+  const __m256i needle = _mm256_set1_epi8(static_cast<char>(value));
+  size_t total{0};
+  size_t i = 0;
+  while (i + 32 <= size) {
+    __m256i acc = _mm256_setzero_si256();
+    const size_t blocks = std::min<size_t>((size - i) / 32, 255);
+    for (size_t k = 0; k < blocks; k++, i += 32) {
+      const __m256i block =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+      acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(block, needle));
+    }
+    const __m256i sums = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+    total += static_cast<size_t>(_mm256_extract_epi64(sums, 0)) +
+             static_cast<size_t>(_mm256_extract_epi64(sums, 1)) +
+             static_cast<size_t>(_mm256_extract_epi64(sums, 2)) +
+             static_cast<size_t>(_mm256_extract_epi64(sums, 3));
+  }
+  return total + count_scalar(data, size, value, i);
+}
+
+__attribute__((target("sse4.2"))) size_t count_sse42(const uint8_t *data,
+                                                     size_t size,
+                                                     uint8_t value) noexcept {
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+  size_t total{0};
+  size_t i = 0;
+  while (i + 16 <= size) {
+    __m128i acc = _mm_setzero_si128();
+    const size_t blocks = std::min<size_t>((size - i) / 16, 255);
+    for (size_t k = 0; k < blocks; k++, i += 16) {
+      const __m128i block =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+      acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(block, needle));
+    }
+    const __m128i sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+    total += static_cast<size_t>(_mm_extract_epi64(sums, 0)) +
+             static_cast<size_t>(_mm_extract_epi64(sums, 1));
+  }
+  return total + count_scalar(data, size, value, i);
+}
+
+__attribute__((target("avx2"))) size_t mismatch_avx2(const uint8_t *lhs,
+                                                     const uint8_t *rhs,
+                                                     size_t size) noexcept {
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+    const uint32_t mask =
+        ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return mismatch_scalar(lhs, rhs, size, i);
+}
+
+__attribute__((target("sse4.2"))) size_t mismatch_sse42(const uint8_t *lhs,
+                                                        const uint8_t *rhs,
+                                                        size_t size) noexcept {
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+    const uint32_t mask =
+        ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) &
+        0xFFFFU;
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return mismatch_scalar(lhs, rhs, size, i);
+}
+
+#endif  // QLE_BYTE_ALGORITHM_HAS_SIMD_IMPL
+
+}  // namespace
+
+SimdLevel ByteAlgorithm::best_simd_level() noexcept {
+  if (CpuFeatures::has_avx2()) {
+    return SimdLevel::AVX2;
+  }
+  if (CpuFeatures::has_sse42()) {
+    return SimdLevel::SSE42;
+  }
+  return SimdLevel::SCALAR;
+}
+
+size_t ByteAlgorithm::find_byte(Span<const uint8_t> span, uint8_t value,
+                                SimdLevel level) noexcept {
+  switch (clamp_simd_level(level)) {
+#if defined(QLE_BYTE_ALGORITHM_HAS_SIMD_IMPL)
+    case SimdLevel::AVX2:
+      return find_byte_avx2(span.Data(), span.Size(), value);
+    case SimdLevel::SSE42:
+      return find_byte_sse42(span.Data(), span.Size(), value);
+#endif
+    case SimdLevel::SCALAR:
+    default:
+      return find_byte_scalar(span.Data(), span.Size(), value, 0);
+  }
+}
+
+size_t ByteAlgorithm::find_pattern(Span<const uint8_t> span,
+                                   Span<const uint8_t> pattern,
+                                   SimdLevel level) noexcept {
+  if (pattern.Empty()) {
+    return 0;
+  }
+  if (pattern.Size() > span.Size()) {
+    return span.Size();
+  }
+  switch (clamp_simd_level(level)) {
+#if defined(QLE_BYTE_ALGORITHM_HAS_SIMD_IMPL)
+    case SimdLevel::AVX2:
+      return find_pattern_avx2(span.Data(), span.Size(), pattern.Data(),
+                               pattern.Size());
+    case SimdLevel::SSE42:
+      return find_pattern_sse42(span.Data(), span.Size(), pattern.Data(),
+                                pattern.Size());
+#endif
+    case SimdLevel::SCALAR:
+    default:
+      return find_pattern_scalar(span.Data(), span.Size(), pattern.Data(),
+                                 pattern.Size(), 0);
+  }
+}
+
+size_t ByteAlgorithm::count(Span<const uint8_t> span, uint8_t value,
+                            SimdLevel level) noexcept {
+  switch (clamp_simd_level(level)) {
+#if defined(QLE_BYTE_ALGORITHM_HAS_SIMD_IMPL)
+    case SimdLevel::AVX2:
+      return count_avx2(span.Data(), span.Size(), value);
+    case SimdLevel::SSE42:
+      return count_sse42(span.Data(), span.Size(), value);
+#endif
+    case SimdLevel::SCALAR:
+    default:
+      return count_scalar(span.Data(), span.Size(), value, 0);
+  }
+}
+
+size_t ByteAlgorithm::mismatch(Span<const uint8_t> lhs, Span<const uint8_t> rhs,
+                               SimdLevel level) noexcept {
+  const size_t size = std::min(lhs.Size(), rhs.Size());
+  switch (clamp_simd_level(level)) {
+#if defined(QLE_BYTE_ALGORITHM_HAS_SIMD_IMPL)
+    case SimdLevel::AVX2:
+      return mismatch_avx2(lhs.Data(), rhs.Data(), size);
+    case SimdLevel::SSE42:
+      return mismatch_sse42(lhs.Data(), rhs.Data(), size);
+#endif
+    case SimdLevel::SCALAR:
+    default:
+      return mismatch_scalar(lhs.Data(), rhs.Data(), size, 0);
+  }
+}
+
+}  // namespace qle
@@ -0,0 +1 @@
+#include <utilities/byte_reader.h>
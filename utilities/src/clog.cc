@@ -1,3 +1 @@
-#include <iostream>
-
 #include <utilities/clog.h>
@@ -0,0 +1,44 @@
+#include <utilities/cpu_features.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace qle {
+
+bool CpuFeatures::has_avx2() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+bool CpuFeatures::has_sse42() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  static const bool supported = __builtin_cpu_supports("sse4.2");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+bool CpuFeatures::has_invariant_tsc() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  static const bool supported = []() {
+    // Advanced power management leaf, EDX bit 8
+    unsigned int eax{0};
+    unsigned int ebx{0};
+    unsigned int ecx{0};
+    unsigned int edx{0};
+    return (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) != 0) &&
+           ((edx & (1U << 8)) != 0);
+  }();
+  return supported;
+#else
+  return false;
+#endif
+}
+
+}  // namespace qle
@@ -0,0 +1,193 @@
+#include <utilities/deferred_log.h>
+#include <utilities/thread.h>
+
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace qle {
+
+std::atomic<bool> DeferredLog::active_{false};
+std::atomic<uint64_t> DeferredLog::dropped_{0};
+std::atomic<LogOverflowPolicy> DeferredLog::policy_{LogOverflowPolicy::BLOCK};
+std::atomic<size_t> DeferredLog::buffer_size_{DeferredLog::cDefaultBufferSize};
+
+namespace {
+
+/**
+ * @brief Sleep of the formatter thread when all buffers are empty
+ */
+constexpr auto cIdleSleep = std::chrono::microseconds(200);
+
+/**
+ * @brief Buffers of all threads that logged, guarded by registry_mtx
+ *
+ * A buffer whose thread exited is only referenced here and is released
+ * once drained.
+ */
+std::vector<std::shared_ptr<DeferredLogBuffer>> registry;
+std::mutex registry_mtx;  ///< Registry mutex
+
+/**
+ * @brief Get a snapshot of the registered buffers
+ *
+ * @return std::vector<std::shared_ptr<DeferredLogBuffer>>
+ */
+std::vector<std::shared_ptr<DeferredLogBuffer>> registered_buffers() {
+  std::lock_guard<std::mutex> lock(registry_mtx);
+  return registry;
+}
+
+/**
+ * @brief Format and write every published record
+ *
+ * @return bool true if any record was written
+ */
+bool drain_buffers() {
+  bool written{false};
+  for (auto &buffer : registered_buffers()) {
+    written |= buffer->consume([](const DeferredRecordHeader &header) {
+      try {
+        const std::string line = DeferredLog::format(header);
+        LoggerConfig::write(header.level, line.data(), line.size(),
+                            header.ticks);
+      } catch (const std::exception &) {
+        // bad_alloc or format_error: keep the format rather than the line
+        LoggerConfig::write(header.level, header.format,
+                            strlen(header.format), header.ticks);
+      }
+    }) != 0;
+  }
+
+  // Release buffers of exited threads, unless a record is still pending
+  std::lock_guard<std::mutex> lock(registry_mtx);
+  for (auto it = registry.begin(); it != registry.end();) {
+    if ((it->use_count() == 1) && ((*it)->consumed() == (*it)->published())) {
+      it = registry.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return written;
+}
+
+/**
+ * @brief DeferredLogFormatter formats records in the background
+ */
+class DeferredLogFormatter : public Thread {
+ public:
+  /**
+   * @brief Construct a new DeferredLogFormatter object
+   */
+  DeferredLogFormatter() noexcept : Thread("qle-log-format") {}
+
+  /**
+   * @brief Destroy the DeferredLogFormatter object
+   */
+  ~DeferredLogFormatter() override { deinit(); }
+
+ protected:
+  /**
+   * @brief Drain buffers until stopped, then drain what is left
+   */
+  void run() override {
+    while (running()) {
+      if (!drain_buffers()) {
+        std::this_thread::sleep_for(cIdleSleep);
+      }
+    }
+    drain_buffers();
+  }
+};
+
+std::unique_ptr<DeferredLogFormatter> formatter;  ///< Formatter thread
+std::mutex formatter_mtx;                         ///< Formatter mutex
+
+}  // namespace
+
+bool DeferredLog::start(size_t buffer_size, LogOverflowPolicy policy) {
+  std::lock_guard<std::mutex> lock(formatter_mtx);
+  if (formatter) {
+    return false;
+  }
+
+  size_t size{cCacheLineSize};
+  while (size < buffer_size) {
+    size <<= 1;
+  }
+  buffer_size_ = size;
+  policy_ = policy;
+  formatter = std::make_unique<DeferredLogFormatter>();
+  formatter->init();
+  active_ = true;
+  return true;
+}
+
+void DeferredLog::stop() noexcept {
+  std::lock_guard<std::mutex> lock(formatter_mtx);
+  if (!formatter) {
+    return;
+  }
+  active_ = false;
+
+  // Pairs with the fence of log(): wait for the records of producers that
+  // saw DeferredLog active, so that the formatter drains them on stopping
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  {
+    std::lock_guard<std::mutex> registry_lock(registry_mtx);
+    for (const auto &buffer : registry) {
+      while (buffer->writing()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+  formatter.reset();
+}
+
+void DeferredLog::flush() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(formatter_mtx);
+    if (formatter) {
+      for (auto &buffer : registered_buffers()) {
+        const size_t target = buffer->published();
+        while (buffer->consumed() < target) {
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+  LoggerConfig *config = LoggerConfig::instance();
+  if (config) {
+    config->flush();
+  }
+}
+
+std::string DeferredLog::format(const DeferredRecordHeader &header) {
+  const std::string message = header.decode(
+      header.format, reinterpret_cast<const uint8_t *>(&header + 1));
+  return fmt::format("[{}] {}: {}", LogLevel::log_level_to_string(header.level),
+                     header.name, message);
+}
+
+DeferredLogBuffer *DeferredLog::thread_buffer() noexcept {
+  static thread_local std::shared_ptr<DeferredLogBuffer> buffer;
+  if (!buffer) {
+    auto created = std::make_shared<DeferredLogBuffer>(buffer_size_.load());
+    if (!created->valid()) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(registry_mtx);
+    registry.push_back(created);
+    buffer = std::move(created);
+  }
+  return buffer.get();
+}
+
+void DeferredLog::wait_for_space() noexcept { std::this_thread::yield(); }
+
+}  // namespace qle
@@ -0,0 +1,518 @@
+#include <utilities/flight_recorder.h>
+
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief FlightRing is the ring of one thread at a time
+ *
+ * Only its thread writes it; dumps read it from any thread. When the
+ * thread exits, the ring goes to a free list for the next new thread.
+ */
+struct FlightRing {
+  FlightRecord *slots{nullptr};     ///< Slots
+  size_t mask{0};                   ///< Number of slots - 1
+  size_t id{0};                     ///< Ring number, in creation order
+  std::atomic<uint64_t> head{0};    ///< Records written
+  std::atomic<uint64_t> dumped{0};  ///< Records dumped or cleared
+  FlightRing *next_free{nullptr};   ///< Next released ring
+};
+
+/**
+ * @brief Rings of all threads that recorded, never freed so that the
+ * records of exited threads can still be dumped
+ */
+std::atomic<FlightRing *> rings[cMaxFlightRecorderThreads];
+std::atomic<size_t> ring_count{0};  ///< Rings registered
+
+/**
+ * @brief Rings released by exited threads, guarded by dump_mtx
+ */
+FlightRing *free_rings{nullptr};
+
+/**
+ * @brief Serializes dumps, so that each record is dumped once
+ */
+std::mutex dump_mtx;
+
+/**
+ * @brief Set while a fatal signal is being handled
+ */
+std::atomic<bool> in_signal{false};
+
+/**
+ * @brief Fatal signals dumped by install_signal_handlers()
+ */
+constexpr int cFatalSignals[]{SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+/**
+ * @brief Ring of the calling thread, released when the thread exits
+ */
+struct ThreadRing {
+  FlightRing *ring{nullptr};  ///< Ring, nullptr if none
+  bool created{false};        ///< Creation was attempted
+
+  /**
+   * @brief Release the ring for reuse by a later thread
+   */
+  ~ThreadRing();
+};
+
+thread_local ThreadRing thread_ring;
+
+/**
+ * @brief Round \p value up to a power of 2
+ */
+size_t round_up_pow2(size_t value) noexcept {
+  size_t result{1};
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+/**
+ * @brief Create and register the ring of the calling thread, or reuse one
+ * released by an exited thread
+ *
+ * A reused ring keeps its size and the records of its previous thread.
+ *
+ * @param slots Number of slots of a new ring, a power of 2
+ * @return FlightRing* nullptr if out of memory or too many threads
+ */
+FlightRing *create_ring(size_t slots) noexcept {
+  {
+    std::lock_guard<std::mutex> lock(dump_mtx);
+    if (free_rings) {
+      FlightRing *ring = free_rings;
+      free_rings = ring->next_free;
+      ring->next_free = nullptr;
+      return ring;
+    }
+  }
+
+  auto *ring = new (std::nothrow) FlightRing();
+  auto *memory = new (std::nothrow) FlightRecord[slots];
+  if (!ring || !memory) {
+    delete ring;
+    delete[] memory;
+    return nullptr;
+  }
+  for (size_t i = 0; i < slots; i++) {
+    memory[i].sequence.store(0, std::memory_order_relaxed);
+  }
+  ring->slots = memory;
+  ring->mask = slots - 1;
+
+  // Registration is rare; claim an index under the dump mutex
+  std::lock_guard<std::mutex> lock(dump_mtx);
+  ring->id = ring_count.load(std::memory_order_relaxed);
+  if (ring->id >= cMaxFlightRecorderThreads) {
+    delete[] memory;
+    delete ring;
+    return nullptr;
+  }
+  rings[ring->id].store(ring, std::memory_order_release);
+  ring_count.store(ring->id + 1, std::memory_order_release);
+  return ring;
+}
+
+/**
+ * @brief Copy of a complete record
+ */
+struct Snapshot {
+  uint64_t ticks;                       ///< LogClock time
+  size_t thread;                        ///< Ring number
+  const char *name;                     ///< Logger name
+  const char *format;                   ///< Format, nullptr if args is text
+  DeferredDecodeFn decode;              ///< Decoder of args
+  LogLevel::Level level;                ///< Log level
+  uint32_t size;                        ///< Size of args used
+  uint8_t args[cFlightRecordArgsSize];  ///< Encoded arguments or text
+};
+
+/**
+ * @brief Copy the complete records not dumped yet and mark them dumped
+ *
+ * Must be called with dump_mtx locked, or from the signal handler.
+ *
+ * @return std::vector<Snapshot> Records, oldest first
+ */
+std::vector<Snapshot> collect() {
+  std::vector<Snapshot> snapshots;
+  const size_t count = ring_count.load(std::memory_order_acquire);
+  for (size_t r = 0; r < count; r++) {
+    FlightRing *ring = rings[r].load(std::memory_order_acquire);
+    const uint64_t head = ring->head.load(std::memory_order_acquire);
+    const uint64_t dumped = ring->dumped.load(std::memory_order_relaxed);
+    const uint64_t capacity = ring->mask + 1;
+    uint64_t index = (head - dumped > capacity) ? head - capacity : dumped;
+    for (; index < head; index++) {
+      const FlightRecord &slot = ring->slots[index & ring->mask];
+      const uint64_t expected = 2 * index + 2;
+      if (slot.sequence.load(std::memory_order_acquire) != expected) {
+        continue;
+      }
+      Snapshot snapshot;
+      snapshot.ticks = slot.ticks;
+      snapshot.thread = ring->id;
+      snapshot.name = slot.name;
+      snapshot.format = slot.format;
+      snapshot.decode = slot.decode;
+      snapshot.level = slot.level;
+      snapshot.size = std::min<uint32_t>(slot.size, sizeof(slot.args));
+      memcpy(snapshot.args, slot.args, snapshot.size);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // Overwritten while copying
+      if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+        continue;
+      }
+      snapshots.push_back(snapshot);
+    }
+    ring->dumped.store(head, std::memory_order_relaxed);
+  }
+  std::stable_sort(snapshots.begin(), snapshots.end(),
+                   [](const Snapshot &a, const Snapshot &b) {
+                     return a.ticks < b.ticks;
+                   });
+  return snapshots;
+}
+
+/**
+ * @brief Decode a record to "[flight N] <time> [level] name: message"
+ *
+ * @param snapshot Record
+ * @return std::string
+ */
+std::string decode(const Snapshot &snapshot) {
+  std::string message;
+  if (snapshot.decode) {
+    try {
+      message = snapshot.decode(snapshot.format, snapshot.args);
+    } catch (const fmt::format_error &) {
+      message = snapshot.format;
+    }
+  } else {
+    message.assign(reinterpret_cast<const char *>(snapshot.args),
+                   snapshot.size);
+  }
+  char time[cLogTimeLength]{};
+  LogClock::format(LogClock::to_ns(snapshot.ticks), time);
+  return fmt::format("[flight {}] {} [{}] {}: {}", snapshot.thread,
+                     fmt::string_view(time, sizeof(time)),
+                     LogLevel::log_level_to_string(snapshot.level),
+                     snapshot.name ? snapshot.name : "", message);
+}
+
+/**
+ * @brief Size of the line built by the signal handler
+ */
+constexpr size_t cSignalLineSize{256};
+
+/**
+ * @brief Line of the signal handler, so that it does not allocate
+ */
+struct SignalLine {
+  char data[cSignalLineSize];  ///< Characters
+  size_t size{0};              ///< Characters used
+
+  /**
+   * @brief Append \p size characters, truncating at the end of the line
+   */
+  void append(const char *text, size_t length) noexcept {
+    length = std::min(length, sizeof(data) - size);
+    memcpy(data + size, text, length);
+    size += length;
+  }
+
+  /**
+   * @brief Append a null-terminated string
+   */
+  void append(const char *text) noexcept {
+    append(text, text ? strlen(text) : 0);
+  }
+
+  /**
+   * @brief Append \p value in decimal
+   */
+  void append(uint64_t value) noexcept {
+    char digits[20];
+    size_t count{0};
+    do {
+      digits[sizeof(digits) - ++count] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    append(digits + sizeof(digits) - count, count);
+  }
+};
+
+SignalLine signal_line;
+
+/**
+ * @brief Next record of each ring not written by the signal handler
+ */
+uint64_t signal_cursors[cMaxFlightRecorderThreads];
+
+/**
+ * @brief Head of each ring when the signal handler started, so that
+ * threads still recording do not keep it writing
+ */
+uint64_t signal_heads[cMaxFlightRecorderThreads];
+
+/**
+ * @brief Write \p size bytes to stderr with write(2), retrying on EINTR
+ */
+void write_stderr(const char *data, size_t size) noexcept {
+  while (size > 0) {
+    const ssize_t written = write(STDERR_FILENO, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+}
+
+/**
+ * @brief Write the records of all rings to stderr, oldest first, with only
+ * async-signal-safe calls
+ *
+ * Records with encoded arguments are skipped, as their decoder formats
+ * with fmt; only the records stored as text are written.
+ */
+void signal_dump() noexcept {
+  const size_t count = std::min<size_t>(
+      ring_count.load(std::memory_order_acquire), cMaxFlightRecorderThreads);
+  for (size_t r = 0; r < count; r++) {
+    const FlightRing *ring = rings[r].load(std::memory_order_acquire);
+    const uint64_t head = ring->head.load(std::memory_order_acquire);
+    const uint64_t dumped = ring->dumped.load(std::memory_order_relaxed);
+    const uint64_t capacity = ring->mask + 1;
+    signal_cursors[r] = (head - dumped > capacity) ? head - capacity : dumped;
+    signal_heads[r] = head;
+  }
+
+  uint64_t skipped{0};
+  for (;;) {
+    // Merge the rings by time, without sorting a copy
+    size_t oldest{count};
+    uint64_t oldest_ticks{UINT64_MAX};
+    for (size_t r = 0; r < count; r++) {
+      if (signal_cursors[r] >= signal_heads[r]) {
+        continue;
+      }
+      const FlightRing *ring = rings[r].load(std::memory_order_acquire);
+      const FlightRecord &slot = ring->slots[signal_cursors[r] & ring->mask];
+      if (slot.ticks < oldest_ticks) {
+        oldest_ticks = slot.ticks;
+        oldest = r;
+      }
+    }
+    if (oldest == count) {
+      break;
+    }
+
+    const FlightRing *ring = rings[oldest].load(std::memory_order_acquire);
+    const uint64_t index = signal_cursors[oldest]++;
+    const FlightRecord &slot = ring->slots[index & ring->mask];
+    const uint64_t expected = 2 * index + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != expected) {
+      continue;
+    }
+    if (slot.decode) {
+      skipped++;
+      continue;
+    }
+
+    signal_line.size = 0;
+    signal_line.append("[flight ");
+    signal_line.append(static_cast<uint64_t>(ring->id));
+    signal_line.append("] ");
+    uint64_t ns{0};
+    if (LogClock::to_ns_nowait(slot.ticks, ns)) {
+      char time[cLogTimeLength];
+      LogClock::format_uncached(ns, time);
+      signal_line.append(time, sizeof(time));
+    } else {
+      signal_line.append(slot.ticks);
+    }
+    signal_line.append(" [");
+    signal_line.append(LogLevel::log_level_to_string(slot.level));
+    signal_line.append("] ");
+    signal_line.append(slot.name);
+    signal_line.append(": ");
+    signal_line.append(reinterpret_cast<const char *>(slot.args),
+                       std::min<size_t>(slot.size, sizeof(slot.args)));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // Overwritten while copying
+    if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+      continue;
+    }
+    signal_line.size = std::min(signal_line.size, cSignalLineSize - 1);
+    signal_line.data[signal_line.size++] = '\n';
+    write_stderr(signal_line.data, signal_line.size);
+  }
+
+  if (skipped != 0) {
+    signal_line.size = 0;
+    signal_line.append("[flight] ");
+    signal_line.append(skipped);
+    signal_line.append(" records with encoded arguments not decoded\n");
+    write_stderr(signal_line.data, signal_line.size);
+  }
+}
+
+/**
+ * @brief Dump to stderr, then let the signal kill the process
+ */
+void fatal_signal_handler(int signal) {
+  const int saved_errno = errno;
+  if (!in_signal.exchange(true)) {
+    signal_dump();
+  }
+  errno = saved_errno;
+  // SA_RESETHAND restored the default action
+  raise(signal);
+}
+
+}  // namespace
+
+ThreadRing::~ThreadRing() {
+  if (ring) {
+    std::lock_guard<std::mutex> lock(dump_mtx);
+    ring->next_free = free_rings;
+    free_rings = ring;
+  }
+  // Records made later by this thread's destructors are dropped
+  ring = nullptr;
+  created = true;
+}
+
+std::atomic<bool> FlightRecorder::active_{false};
+std::atomic<bool> FlightRecorder::dump_on_error_{false};
+std::atomic<size_t> FlightRecorder::slots_{cDefaultFlightRecorderSlots};
+
+void FlightRecorder::start(size_t slots, bool dump_on_error) noexcept {
+  slots_ = round_up_pow2(std::max<size_t>(slots, 2));
+  dump_on_error_ = dump_on_error;
+  LogClock::calibrate();
+  active_ = true;
+}
+
+void FlightRecorder::stop() noexcept { active_ = false; }
+
+void FlightRecorder::record_printf(LogLevel::Level level, const char *name,
+                                   const char *format,
+                                   va_list args) noexcept {
+  FlightRecord *slot = begin_record(level, name);
+  if (!slot) {
+    return;
+  }
+  const int length = vsnprintf(reinterpret_cast<char *>(slot->args),
+                               sizeof(slot->args), format, args);
+  slot->size = (length < 0) ? 0
+                            : static_cast<uint32_t>(std::min<size_t>(
+                                  length, sizeof(slot->args) - 1));
+  slot->format = nullptr;
+  slot->decode = nullptr;
+  end_record(slot);
+}
+
+void FlightRecorder::on_error() noexcept {
+  if (dump_on_error_.load(std::memory_order_relaxed)) {
+    dump_to_log();
+  }
+}
+
+size_t FlightRecorder::dump(FILE *stream) noexcept {
+  try {
+    std::lock_guard<std::mutex> lock(dump_mtx);
+    const auto snapshots = collect();
+    for (const Snapshot &snapshot : snapshots) {
+      const std::string line = decode(snapshot);
+      fprintf(stream, "%s\n", line.c_str());
+    }
+    fflush(stream);
+    return snapshots.size();
+  } catch (const std::bad_alloc &) {
+    return 0;
+  }
+}
+
+size_t FlightRecorder::dump_to_log() noexcept {
+  try {
+    std::lock_guard<std::mutex> lock(dump_mtx);
+    const auto snapshots = collect();
+    for (const Snapshot &snapshot : snapshots) {
+      const std::string line = decode(snapshot);
+      LoggerConfig::write(snapshot.level, line.data(), line.size());
+    }
+    return snapshots.size();
+  } catch (const std::bad_alloc &) {
+    return 0;
+  }
+}
+
+void FlightRecorder::clear() noexcept {
+  std::lock_guard<std::mutex> lock(dump_mtx);
+  const size_t count = ring_count.load(std::memory_order_acquire);
+  for (size_t r = 0; r < count; r++) {
+    FlightRing *ring = rings[r].load(std::memory_order_acquire);
+    ring->dumped.store(ring->head.load(std::memory_order_acquire),
+                       std::memory_order_relaxed);
+  }
+}
+
+bool FlightRecorder::install_signal_handlers() noexcept {
+  struct sigaction action {};
+  action.sa_handler = &fatal_signal_handler;
+  action.sa_flags = SA_RESETHAND | SA_NODEFER;
+  sigemptyset(&action.sa_mask);
+  bool installed{true};
+  for (const int signal : cFatalSignals) {
+    installed &= (sigaction(signal, &action, nullptr) == 0);
+  }
+  return installed;
+}
+
+FlightRecord *FlightRecorder::begin_record(LogLevel::Level level,
+                                           const char *name) noexcept {
+  if (!thread_ring.created) {
+    thread_ring.created = true;
+    thread_ring.ring = create_ring(slots_.load(std::memory_order_relaxed));
+  }
+  FlightRing *ring = thread_ring.ring;
+  if (!ring) {
+    return nullptr;
+  }
+  const uint64_t index = ring->head.load(std::memory_order_relaxed);
+  FlightRecord *slot = &ring->slots[index & ring->mask];
+  slot->sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->ticks = LogClock::now();
+  slot->name = name;
+  slot->level = level;
+  return slot;
+}
+
+void FlightRecorder::end_record(FlightRecord *record) noexcept {
+  const uint64_t index = record->sequence.load(std::memory_order_relaxed) / 2;
+  record->sequence.store(2 * index + 2, std::memory_order_release);
+  thread_ring.ring->head.store(index + 1, std::memory_order_release);
+}
+
+}  // namespace qle
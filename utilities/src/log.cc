@@ -1,5 +1,8 @@
+#include <utilities/binary_log.h>
 #include <utilities/log.h>
 
+#include <algorithm>
+
 namespace qle {
 
 void Logger::log(LogLevel::Level level, const char *format,
@@ -8,7 +11,8 @@ void Logger::log(LogLevel::Level level, const char *format,
     return;
   }
 
-  if (level < logger_config_->loglevel()) {
+  if (QLE_UNLIKELY(LoggerConfig::binary_active())) {
+    log_binary(level, format, args);
     return;
   }
 
@@ -16,31 +20,33 @@ void Logger::log(LogLevel::Level level, const char *format,
   vsnprintf(log_msg, sizeof(log_msg), format, args);
 
   char full_log_msg[1029]{};
-  snprintf(full_log_msg, sizeof(full_log_msg), "[%s] %s: %s",
-           LogLevel::log_level_to_string(level), logger_name_, log_msg);
-
-  std::lock_guard<std::mutex> guard(logger_config_->logmutex);
-  if (logger_config_->logfile()) {
-    if (level != LogLevel::DISABLED) {
-      fprintf(logger_config_->logfile(), "%s\n", full_log_msg);
-    }
+  const int length =
+      snprintf(full_log_msg, sizeof(full_log_msg), "[%s] %s: %s",
+               LogLevel::log_level_to_string(level), logger_name_, log_msg);
+  if (length < 0) {
     return;
   }
+  LoggerConfig::write(level, full_log_msg,
+                      std::min(static_cast<size_t>(length),
+                               sizeof(full_log_msg) - 1));
+}
 
-  switch (level) {
-    case LogLevel::TRACE:
-    case LogLevel::DEBUG:
-    case LogLevel::INFO:
-      fprintf(stdout, "%s\n", full_log_msg);
-      break;
-    case LogLevel::WARNING:
-    case LogLevel::ERROR:
-      fprintf(stderr, "%s\n", full_log_msg);
-      break;
-    case LogLevel::DISABLED:
-    default:
-      return;
+void Logger::log_binary(LogLevel::Level level, const char *format,
+                        va_list args) noexcept {
+  // printf arguments cannot be told apart, so the message is stored as text
+  static constexpr size_t cHeaderSize{detail::BinaryStringArg::size_of(0)};
+  uint8_t record[cHeaderSize + 1024]{};
+  const int length =
+      vsnprintf(reinterpret_cast<char *>(record + cHeaderSize),
+                sizeof(record) - cHeaderSize, format, args);
+  if (length < 0) {
+    return;
   }
+  const size_t size = std::min(static_cast<size_t>(length),
+                               sizeof(record) - cHeaderSize - 1);
+  detail::BinaryStringArg::encode_header(record, size);
+  LoggerConfig::write_binary(level, logger_name_, cBinaryTextFormat, record,
+                             cHeaderSize + size);
 }
 
 }  // namespace qle
@@ -0,0 +1,259 @@
+#include <utilities/cpu_features.h>
+#include <utilities/log_clock.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief Duration of the first TSC measurement
+ */
+constexpr auto cFirstCalibration = std::chrono::milliseconds(10);
+
+/**
+ * @brief Convert \p ts to nanoseconds
+ */
+uint64_t timespec_ns(const timespec &ts) noexcept {
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/**
+ * @brief Read the TSC, the monotonic clock and the wall clock at the same
+ * instant
+ *
+ * @param ticks Output TSC, midpoint of the reads around the clocks
+ * @param monotonic_ns Output CLOCK_MONOTONIC nanoseconds
+ * @param ns Output nanoseconds since epoch
+ */
+void sample(uint64_t &ticks, uint64_t &monotonic_ns, uint64_t &ns) noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  const uint64_t before = __rdtsc();
+  timespec monotonic{};
+  clock_gettime(CLOCK_MONOTONIC, &monotonic);
+  timespec ts{};
+  clock_gettime(CLOCK_REALTIME, &ts);
+  const uint64_t after = __rdtsc();
+  ticks = before + (after - before) / 2;
+  monotonic_ns = timespec_ns(monotonic);
+  ns = timespec_ns(ts);
+#else
+  ticks = monotonic_ns = ns = LogClock::now();
+#endif
+}
+
+/**
+ * @brief TSC calibration, published with a sequence lock
+ *
+ * The rate is measured against CLOCK_MONOTONIC, which NTP slews but never
+ * steps, and the base against CLOCK_REALTIME, so that a step of the wall
+ * clock moves timestamps at the next calibration without skewing the rate.
+ * Conversions read the base and the rate without a lock; calibrations are
+ * serialized by mtx.
+ */
+struct Calibration {
+  std::mutex mtx;                       ///< Calibration mutex
+  std::atomic<uint32_t> seq{0};         ///< Odd while being updated
+  std::atomic<uint64_t> base_ticks{0};  ///< TSC of the last sample
+  std::atomic<uint64_t> base_ns{0};     ///< Wall time of the last sample
+  std::atomic<double> ns_per_tick{0};   ///< Measured rate
+  std::atomic<uint64_t> next_ticks{0};  ///< TSC of the next calibration
+  uint64_t first_ticks{0};              ///< TSC of the first sample
+  uint64_t first_monotonic_ns{0};       ///< Monotonic time of the first sample
+
+  /**
+   * @brief Take a sample and publish the rate since the first sample
+   *
+   * Must be called with mtx locked.
+   */
+  void update() noexcept {
+    uint64_t ticks{0};
+    uint64_t monotonic_ns{0};
+    uint64_t ns{0};
+    sample(ticks, monotonic_ns, ns);
+    if ((ticks <= first_ticks) || (monotonic_ns <= first_monotonic_ns)) {
+      return;
+    }
+    const double rate = static_cast<double>(monotonic_ns - first_monotonic_ns) /
+                        static_cast<double>(ticks - first_ticks);
+
+    seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    base_ticks.store(ticks, std::memory_order_relaxed);
+    base_ns.store(ns, std::memory_order_relaxed);
+    ns_per_tick.store(rate, std::memory_order_relaxed);
+    seq.fetch_add(1, std::memory_order_release);
+    next_ticks.store(
+        ticks + static_cast<uint64_t>(cLogClockCalibrationIntervalNs / rate),
+        std::memory_order_relaxed);
+  }
+};
+
+/**
+ * @brief Get the calibration, measuring the TSC on first use
+ *
+ * @return Calibration&
+ */
+Calibration &calibration() noexcept {
+  static Calibration *state = []() {
+    auto *created = new Calibration();
+    uint64_t ns{0};
+    sample(created->first_ticks, created->first_monotonic_ns, ns);
+    std::this_thread::sleep_for(cFirstCalibration);
+    created->update();
+    return created;
+  }();
+  return *state;
+}
+
+/**
+ * @brief Write \p value as \p digits decimal digits, zero-padded
+ *
+ * @return char* Character after the digits
+ */
+char *format_digits(char *out, uint64_t value, size_t digits) noexcept {
+  for (size_t i = digits; i > 0; i--) {
+    out[i - 1] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  return out + digits;
+}
+
+/**
+ * @brief Format \p second as UTC "YYYY-MM-DD HH:MM:SS." without gmtime_r(),
+ * so that it is async-signal-safe
+ *
+ * @param second Seconds since epoch
+ * @param out Output of 20 characters
+ */
+void format_date(uint64_t second, char *out) noexcept {
+  // Civil date of a day count, H. Hinnant's days_from_civil inverse
+  const uint64_t day_second = second % 86400;
+  const uint64_t z = second / 86400 + 719468;
+  const uint64_t era = z / 146097;
+  const uint64_t day_of_era = z - era * 146097;
+  const uint64_t year_of_era =
+      (day_of_era - day_of_era / 1460 + day_of_era / 36524 -
+       day_of_era / 146096) /
+      365;
+  const uint64_t day_of_year =
+      day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  const uint64_t mp = (5 * day_of_year + 2) / 153;
+  const uint64_t day = day_of_year - (153 * mp + 2) / 5 + 1;
+  const uint64_t month = (mp < 10) ? mp + 3 : mp - 9;
+  const uint64_t year = year_of_era + era * 400 + ((month <= 2) ? 1 : 0);
+
+  out = format_digits(out, year, 4);
+  *out++ = '-';
+  out = format_digits(out, month, 2);
+  *out++ = '-';
+  out = format_digits(out, day, 2);
+  *out++ = ' ';
+  out = format_digits(out, day_second / 3600, 2);
+  *out++ = ':';
+  out = format_digits(out, day_second / 60 % 60, 2);
+  *out++ = ':';
+  out = format_digits(out, day_second % 60, 2);
+  *out = '.';
+}
+
+/**
+ * @brief Date part of the last time formatted by this thread
+ */
+struct DateCache {
+  uint64_t second{UINT64_MAX};  ///< Seconds since epoch
+  char date[20]{};              ///< "YYYY-MM-DD HH:MM:SS."
+};
+
+thread_local DateCache date_cache;
+
+}  // namespace
+
+uint64_t LogClock::to_ns(uint64_t ticks) noexcept {
+  if (!uses_tsc()) {
+    return ticks;
+  }
+  Calibration &state = calibration();
+  if (ticks >= state.next_ticks.load(std::memory_order_relaxed)) {
+    std::unique_lock<std::mutex> lock(state.mtx, std::try_to_lock);
+    if (lock.owns_lock()) {
+      state.update();
+    }
+  }
+
+  uint64_t base_ticks{0};
+  uint64_t base_ns{0};
+  double rate{0};
+  uint32_t seq{0};
+  do {
+    seq = state.seq.load(std::memory_order_acquire);
+    base_ticks = state.base_ticks.load(std::memory_order_relaxed);
+    base_ns = state.base_ns.load(std::memory_order_relaxed);
+    rate = state.ns_per_tick.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1U) || (seq != state.seq.load(std::memory_order_relaxed)));
+
+  // Ticks may predate the last calibration
+  const auto delta =
+      static_cast<double>(static_cast<int64_t>(ticks - base_ticks));
+  return static_cast<uint64_t>(static_cast<int64_t>(base_ns) +
+                               static_cast<int64_t>(delta * rate));
+}
+
+bool LogClock::to_ns_nowait(uint64_t ticks, uint64_t &ns) noexcept {
+  if (!uses_tsc()) {
+    ns = ticks;
+    return true;
+  }
+  const Calibration &state = calibration();
+  const uint32_t seq = state.seq.load(std::memory_order_acquire);
+  const uint64_t base_ticks = state.base_ticks.load(std::memory_order_relaxed);
+  const uint64_t base_ns = state.base_ns.load(std::memory_order_relaxed);
+  const double rate = state.ns_per_tick.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if ((seq & 1U) || (seq != state.seq.load(std::memory_order_relaxed))) {
+    return false;
+  }
+  const auto delta =
+      static_cast<double>(static_cast<int64_t>(ticks - base_ticks));
+  ns = static_cast<uint64_t>(static_cast<int64_t>(base_ns) +
+                             static_cast<int64_t>(delta * rate));
+  return true;
+}
+
+void LogClock::calibrate() noexcept {
+  if (!uses_tsc()) {
+    return;
+  }
+  Calibration &state = calibration();
+  std::lock_guard<std::mutex> lock(state.mtx);
+  state.update();
+}
+
+void LogClock::format(uint64_t ns, char *out) noexcept {
+  const uint64_t second = ns / 1000000000ULL;
+  if (second != date_cache.second) {
+    format_date(second, date_cache.date);
+    date_cache.second = second;
+  }
+  memcpy(out, date_cache.date, sizeof(date_cache.date));
+  format_digits(out + sizeof(date_cache.date), ns % 1000000000ULL,
+                cLogTimeLength - sizeof(date_cache.date));
+}
+
+void LogClock::format_uncached(uint64_t ns, char *out) noexcept {
+  format_date(ns / 1000000000ULL, out);
+  format_digits(out + 20, ns % 1000000000ULL, cLogTimeLength - 20);
+}
+
+bool LogClock::detect_tsc() noexcept {
+  return CpuFeatures::has_invariant_tsc();
+}
+
+}  // namespace qle
@@ -1,8 +1,628 @@
+#include <utilities/binary_log.h>
+#include <utilities/deferred_log.h>
 #include <utilities/log_config.h>
+#include <utilities/log_sink.h>
+#include <utilities/log_writer.h>
+
+#include <algorithm>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace qle {
 
-LoggerConfig *LoggerConfig::instance_{nullptr};
+namespace {
+
+/**
+ * @brief Live logger thresholds and per-name overrides
+ */
+struct ThresholdRegistry {
+  std::mutex mtx;                                    ///< Registry mutex
+  std::vector<LogThreshold *> thresholds;            ///< Live thresholds
+  std::map<std::string, LogLevel::Level> overrides;  ///< Per-name levels
+};
+
+/**
+ * @brief Get the threshold registry
+ *
+ * Constructed on first use, so that loggers with static storage duration
+ * can register from their constructors.
+ *
+ * @return ThresholdRegistry&
+ */
+ThresholdRegistry &threshold_registry() {
+  static ThresholdRegistry registry;
+  return registry;
+}
+
+/**
+ * @brief Writer count of one thread, on its own cache line, so that
+ * writers on different threads never touch the same line
+ */
+struct alignas(64) WriterSlot {
+  std::atomic<uint32_t> active{0};  ///< Nested write() calls of the owner
+  WriterSlot *next{nullptr};        ///< Next slot
+  bool in_use{false};               ///< Owned by a thread, guarded by mtx
+};
+
+/**
+ * @brief Slots of the writing threads, never freed, so that destroy() can
+ * wait for the threads inside write() without a shared counter
+ */
+struct WriterRegistry {
+  std::mutex mtx;                 ///< Registry mutex
+  WriterSlot *head{nullptr};      ///< Slots, in use or free
+  std::atomic<size_t> shared{0};  ///< Writers of threads without a slot
+};
+
+/**
+ * @brief Get the writer registry, never destroyed so that threads can
+ * write during static destruction
+ *
+ * @return WriterRegistry&
+ */
+WriterRegistry &writer_registry() noexcept {
+  static WriterRegistry *registry = new WriterRegistry();
+  return *registry;
+}
+
+/**
+ * @brief Writer slot of the calling thread, released when it exits
+ */
+struct ThreadWriterSlot {
+  WriterSlot *slot{nullptr};  ///< Slot, nullptr if none
+  bool acquired{false};       ///< Acquisition was attempted
+
+  /**
+   * @brief Release the slot for reuse by a later thread
+   */
+  ~ThreadWriterSlot() {
+    if (slot) {
+      WriterRegistry &registry = writer_registry();
+      std::lock_guard<std::mutex> lock(registry.mtx);
+      slot->in_use = false;
+    }
+    // Lines written later by this thread's destructors use the counter
+    slot = nullptr;
+    acquired = true;
+  }
+};
+
+thread_local ThreadWriterSlot thread_writer_slot;
+
+/**
+ * @brief Get the slot of the calling thread, taking a free one or
+ * allocating one on first use
+ *
+ * @return WriterSlot* nullptr if out of memory or the thread is exiting
+ */
+WriterSlot *writer_slot() noexcept {
+  if (QLE_LIKELY(thread_writer_slot.acquired)) {
+    return thread_writer_slot.slot;
+  }
+  thread_writer_slot.acquired = true;
+  WriterRegistry &registry = writer_registry();
+  std::lock_guard<std::mutex> lock(registry.mtx);
+  WriterSlot *slot = registry.head;
+  while (slot && slot->in_use) {
+    slot = slot->next;
+  }
+  if (!slot) {
+    slot = new (std::nothrow) WriterSlot();
+    if (!slot) {
+      return nullptr;
+    }
+    slot->next = registry.head;
+    registry.head = slot;
+  }
+  slot->in_use = true;
+  thread_writer_slot.slot = slot;
+  return slot;
+}
+
+/**
+ * @brief Marks the calling thread inside write() or write_binary()
+ *
+ * The mark is a store to the thread's own slot followed by a fence, so
+ * that destroy() either sees it or this thread sees no instance; only
+ * threads without a slot share a counter.
+ */
+class WriterScope {
+ public:
+  /**
+   * @brief Enter write()
+   */
+  WriterScope() noexcept : slot_(writer_slot()) {
+    if (QLE_LIKELY(slot_ != nullptr)) {
+      // Only the owner writes the count; nested calls increment it
+      slot_->active.store(slot_->active.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    } else {
+      writer_registry().shared.fetch_add(1);
+    }
+  }
+
+  /**
+   * @brief Leave write()
+   */
+  ~WriterScope() {
+    if (QLE_LIKELY(slot_ != nullptr)) {
+      slot_->active.store(slot_->active.load(std::memory_order_relaxed) - 1,
+                          std::memory_order_release);
+    } else {
+      writer_registry().shared.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Copy constructor deleted
+   */
+  WriterScope(const WriterScope &) = delete;
+
+  /**
+   * @brief Move constructor deleted
+   */
+  WriterScope(WriterScope &&) = delete;
+
+  /**
+   * @brief Copy assignment deleted
+   */
+  WriterScope &operator=(const WriterScope &) = delete;
+
+  /**
+   * @brief Move assignment deleted
+   */
+  WriterScope &operator=(WriterScope &&) = delete;
+
+ private:
+  WriterSlot *slot_;  ///< Slot of the thread, nullptr to use the counter
+};
+
+}  // namespace
+
+LogThreshold::LogThreshold(const char *name) noexcept : name_(name) {
+  ThresholdRegistry &registry = threshold_registry();
+  std::lock_guard<std::mutex> lock(registry.mtx);
+  registry.thresholds.push_back(this);
+  level_.store(LoggerConfig::resolve_level(name_), std::memory_order_relaxed);
+}
+
+LogThreshold::~LogThreshold() noexcept {
+  ThresholdRegistry &registry = threshold_registry();
+  std::lock_guard<std::mutex> lock(registry.mtx);
+  auto &thresholds = registry.thresholds;
+  thresholds.erase(std::remove(thresholds.begin(), thresholds.end(), this),
+                   thresholds.end());
+}
+
+std::atomic<LoggerConfig *> LoggerConfig::instance_{nullptr};
 std::mutex LoggerConfig::instance_mtx_;
+std::atomic<LogLevel::Level> LoggerConfig::loglevel_{LogLevel::DISABLED};
+std::atomic<bool> LoggerConfig::binary_active_{false};
+std::atomic<bool> LoggerConfig::timestamps_{false};
+
+void LoggerConfig::destroy() {
+  // Records waiting for deferred formatting are written first
+  DeferredLog::flush();
+
+  std::lock_guard<std::mutex> lock(instance_mtx_);
+  LoggerConfig *config = instance_.exchange(nullptr);
+  if (!config) {
+    return;
+  }
+  loglevel_ = LogLevel::DISABLED;
+  binary_active_ = false;
+  timestamps_ = false;
+  {
+    ThresholdRegistry &registry = threshold_registry();
+    std::lock_guard<std::mutex> registry_lock(registry.mtx);
+    registry.overrides.clear();
+  }
+  update_thresholds();
+
+  // No new line can reach the config now; let in-flight ones finish
+  wait_for_writers();
+  config->stop_async();
+  {
+    std::lock_guard<std::mutex> async_lock(config->async_mtx_);
+    config->stop_flusher();
+  }
+  config->flush_output();
+  delete config->mapped_file_.exchange(nullptr);
+  delete config->sharded_file_.exchange(nullptr);
+  delete config->binary_writer_.exchange(nullptr);
+  for (size_t i = 0; i < config->sink_count_; i++) {
+    delete config->sinks_[i];
+  }
+  if (config->logfile_) {
+    fclose(config->logfile_);
+  }
+  delete[] config->file_buffer_;
+  delete config;
+}
+
+bool LoggerConfig::set_loglevel(LogLevel::Level level) noexcept {
+  if (!LogLevel::is_valid_log_level(level)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(instance_mtx_);
+  if (!instance_) {
+    return false;
+  }
+  loglevel_ = level;
+  update_thresholds();
+  return true;
+}
+
+bool LoggerConfig::set_logger_level(const char *name, LogLevel::Level level) {
+  if (!name || !LogLevel::is_valid_log_level(level)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(instance_mtx_);
+  if (!instance_) {
+    return false;
+  }
+  {
+    ThresholdRegistry &registry = threshold_registry();
+    std::lock_guard<std::mutex> registry_lock(registry.mtx);
+    registry.overrides[name] = level;
+  }
+  update_thresholds();
+  return true;
+}
+
+void LoggerConfig::clear_logger_level(const char *name) {
+  if (!name) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(instance_mtx_);
+  {
+    ThresholdRegistry &registry = threshold_registry();
+    std::lock_guard<std::mutex> registry_lock(registry.mtx);
+    registry.overrides.erase(name);
+  }
+  update_thresholds();
+}
+
+void LoggerConfig::write(LogLevel::Level level, const char *line,
+                         size_t length, uint64_t ticks) noexcept {
+  if (QLE_UNLIKELY(timestamps_.load(std::memory_order_relaxed)) &&
+      (ticks == 0)) {
+    ticks = LogClock::now();
+  }
+
+  // Announce the writer before reading the instance
+  const WriterScope scope;
+  LoggerConfig *config = instance_.load();
+  if (config) {
+    AsyncLogWriter *writer =
+        config->async_writer_.load(std::memory_order_acquire);
+    if (writer) {
+      writer->push(level, line, length, ticks);
+    } else {
+      config->write_line(level, line, length, ticks);
+    }
+  }
+}
+
+bool LoggerConfig::start_async(size_t capacity, LogOverflowPolicy policy) {
+  std::lock_guard<std::mutex> lock(async_mtx_);
+  if (async_writer_) {
+    return false;
+  }
+  auto *writer = new AsyncLogWriter(*this, capacity, policy);
+  if (!writer->start()) {
+    delete writer;
+    return false;
+  }
+  async_writer_.store(writer, std::memory_order_release);
+  return true;
+}
+
+void LoggerConfig::stop_async() noexcept {
+  std::lock_guard<std::mutex> lock(async_mtx_);
+  AsyncLogWriter *writer = async_writer_.exchange(nullptr);
+  if (!writer) {
+    return;
+  }
+
+  // Lines pushed by in-flight writers are drained when the thread stops
+  wait_for_writers();
+  delete writer;
+  flush_output();
+}
+
+bool LoggerConfig::open_mapped_file(const char *path,
+                                    const MappedLogFileOptions &options) {
+  std::lock_guard<std::mutex> lock(async_mtx_);
+  if (mapped_file_) {
+    return false;
+  }
+  auto *file = new MappedLogFile(path, options);
+  if (!file->open()) {
+    delete file;
+    return false;
+  }
+  mapped_file_.store(file, std::memory_order_release);
+  return true;
+}
+
+LogSink *LoggerConfig::add_sink(std::unique_ptr<LogSink> sink) {
+  std::lock_guard<std::mutex> lock(async_mtx_);
+  const size_t count = sink_count_.load(std::memory_order_relaxed);
+  if (!sink || (count == cMaxLogSinks)) {
+    return nullptr;
+  }
+  // Published by the count, so writers never see a partial list
+  sinks_[count] = sink.release();
+  sink_count_.store(count + 1, std::memory_order_release);
+  return sinks_[count];
+}
+
+void LoggerConfig::set_timestamps(bool enabled) noexcept {
+  if (enabled) {
+    LogClock::calibrate();
+  }
+  timestamps_ = enabled;
+}
+
+bool LoggerConfig::open_sharded_file(const char *path) {
+  std::lock_guard<std::mutex> lock(async_mtx_);
+  if (sharded_file_ || !path) {
+    return false;
+  }
+  sharded_file_.store(new ShardedLogFile(path), std::memory_order_release);
+  return true;
+}
+
+bool LoggerConfig::open_binary_file(const char *path, size_t block_size) {
+  std::lock_guard<std::mutex> lock(async_mtx_);
+  if (binary_writer_) {
+    return false;
+  }
+  auto *writer = new BinaryLogWriter(block_size);
+  if (!writer->open(path)) {
+    delete writer;
+    return false;
+  }
+  binary_writer_.store(writer, std::memory_order_release);
+  binary_active_ = true;
+  return true;
+}
+
+void LoggerConfig::write_binary(LogLevel::Level level, const char *name,
+                                const char *format, const uint8_t *args,
+                                size_t size) noexcept {
+  // Same protocol as write() against destroy()
+  const WriterScope scope;
+  LoggerConfig *config = instance_.load();
+  if (config) {
+    BinaryLogWriter *writer =
+        config->binary_writer_.load(std::memory_order_acquire);
+    if (writer) {
+      writer->write(level, name, format, args, size);
+    }
+  }
+}
+
+bool LoggerConfig::set_flush_policy(const LogFlushPolicy &policy) {
+  std::lock_guard<std::mutex> lock(async_mtx_);
+  stop_flusher();
+  {
+    std::lock_guard<std::mutex> guard(logmutex);
+    flush_policy_ = policy;
+  }
+  if (policy.interval_ms == 0) {
+    return true;
+  }
+  auto *flusher = new LogFlusher(*this, policy.interval_ms);
+  if (!flusher->start()) {
+    delete flusher;
+    return false;
+  }
+  flusher_ = flusher;
+  return true;
+}
+
+void LoggerConfig::flush() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(async_mtx_);
+    AsyncLogWriter *writer = async_writer_;
+    if (writer) {
+      writer->flush();
+    }
+    MappedLogFile *file = mapped_file_;
+    if (file) {
+      file->sync();
+    }
+    ShardedLogFile *sharded_file = sharded_file_;
+    if (sharded_file) {
+      sharded_file->flush();
+    }
+    const size_t sink_count = sink_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < sink_count; i++) {
+      sinks_[i]->flush();
+    }
+    BinaryLogWriter *binary_writer = binary_writer_;
+    if (binary_writer) {
+      binary_writer->flush();
+    }
+  }
+  flush_output();
+}
+
+uint64_t LoggerConfig::dropped_count() noexcept {
+  std::lock_guard<std::mutex> lock(async_mtx_);
+  AsyncLogWriter *writer = async_writer_;
+  return writer ? writer->dropped_count() : 0;
+}
+
+uint64_t LoggerConfig::overwritten_count() noexcept {
+  std::lock_guard<std::mutex> lock(async_mtx_);
+  AsyncLogWriter *writer = async_writer_;
+  return writer ? writer->overwritten_count() : 0;
+}
+
+void LoggerConfig::write_line(LogLevel::Level level, const char *line,
+                              size_t length, uint64_t ticks) noexcept {
+  if (ticks != 0) {
+    // Prefix the line with its time in a reused per-thread buffer
+    static thread_local std::string stamped;
+    stamped.resize(cLogTimeLength + 1);
+    LogClock::format(LogClock::to_ns(ticks), &stamped[0]);
+    stamped[cLogTimeLength] = ' ';
+    stamped.append(line, length);
+    line = stamped.data();
+    length = stamped.size();
+  }
+
+  const size_t sink_count = sink_count_.load(std::memory_order_acquire);
+  if (sink_count != 0) {
+    for (size_t i = 0; i < sink_count; i++) {
+      if (sinks_[i]->accepts(level)) {
+        sinks_[i]->write(level, line, length);
+      }
+    }
+    return;
+  }
+
+  MappedLogFile *file = mapped_file_.load(std::memory_order_acquire);
+  if (file) {
+    if (level != LogLevel::DISABLED) {
+      file->append(line, length);
+    }
+    return;
+  }
+  ShardedLogFile *sharded_file = sharded_file_.load(std::memory_order_acquire);
+  if (sharded_file) {
+    if (level != LogLevel::DISABLED) {
+      sharded_file->append(line, length, ticks);
+    }
+    return;
+  }
+
+  FILE *stream{nullptr};
+  if (logfile_) {
+    stream = logfile_;
+  } else {
+    switch (level) {
+      case LogLevel::TRACE:
+      case LogLevel::DEBUG:
+      case LogLevel::INFO:
+        stream = stdout;
+        break;
+      case LogLevel::WARNING:
+      case LogLevel::ERROR:
+        stream = stderr;
+        break;
+      case LogLevel::DISABLED:
+      default:
+        return;
+    }
+  }
+  if (level == LogLevel::DISABLED) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(logmutex);
+  fprintf(stream, "%.*s\n", static_cast<int>(length), line);
+  unflushed_bytes_ += length + 1;
+
+  const bool urgent =
+      flush_policy_.flush_on_warning && (level >= LogLevel::WARNING);
+  const size_t threshold = flush_policy_.byte_threshold;
+  if (urgent || ((threshold != 0) && (unflushed_bytes_ >= threshold))) {
+    fflush(stream);
+    unflushed_bytes_ = 0;
+  }
+}
+
+void LoggerConfig::flush_output() noexcept {
+  std::lock_guard<std::mutex> guard(logmutex);
+  if (logfile_) {
+    fflush(logfile_);
+  } else {
+    fflush(stdout);
+    fflush(stderr);
+  }
+  unflushed_bytes_ = 0;
+}
+
+void LoggerConfig::flush_pending() noexcept {
+  // Sinks and the sharded file are only deleted once the flusher stopped
+  const size_t sink_count = sink_count_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < sink_count; i++) {
+    sinks_[i]->flush();
+  }
+  ShardedLogFile *sharded_file = sharded_file_.load(std::memory_order_acquire);
+  if (sharded_file) {
+    sharded_file->flush();
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(logmutex);
+    if (unflushed_bytes_ == 0) {
+      return;
+    }
+  }
+  flush_output();
+}
+
+void LoggerConfig::flush_batch() noexcept {
+  {
+    std::lock_guard<std::mutex> guard(logmutex);
+    if ((flush_policy_.byte_threshold != 0) ||
+        (flush_policy_.interval_ms != 0)) {
+      return;
+    }
+  }
+  flush_output();
+}
+
+void LoggerConfig::stop_flusher() noexcept {
+  delete flusher_;
+  flusher_ = nullptr;
+}
+
+void LoggerConfig::update_thresholds() noexcept {
+  ThresholdRegistry &registry = threshold_registry();
+  std::lock_guard<std::mutex> lock(registry.mtx);
+  for (LogThreshold *threshold : registry.thresholds) {
+    threshold->level_.store(resolve_level(threshold->name_),
+                            std::memory_order_relaxed);
+  }
+}
+
+LogLevel::Level LoggerConfig::resolve_level(const char *name) {
+  if (!instance_) {
+    return LogLevel::DISABLED;
+  }
+  const auto &overrides = threshold_registry().overrides;
+  if (name && !overrides.empty()) {
+    auto it = overrides.find(name);
+    if (it != overrides.end()) {
+      return it->second;
+    }
+  }
+  return loglevel_.load(std::memory_order_relaxed);
+}
+
+void LoggerConfig::wait_for_writers() noexcept {
+  // Pairs with the fence of WriterScope
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  WriterRegistry &registry = writer_registry();
+  std::lock_guard<std::mutex> lock(registry.mtx);
+  for (const WriterSlot *slot = registry.head; slot; slot = slot->next) {
+    while (slot->active.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+  }
+  while (registry.shared.load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+}
 
 }  // namespace qle
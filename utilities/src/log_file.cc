@@ -0,0 +1,269 @@
+#include <utilities/log_file.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief Attempts of a line to find room before it is dropped
+ */
+constexpr size_t cMaxAppendAttempts{256};
+
+/**
+ * @brief Sleep of the background thread between two passes
+ */
+constexpr auto cIdleSleep = std::chrono::milliseconds(1);
+
+}  // namespace
+
+MappedLogFile::~MappedLogFile() {
+  deinit();
+  if (!opened_) {
+    return;
+  }
+
+  const uint64_t sequence = current_.load(std::memory_order_acquire);
+  while (retired_.load(std::memory_order_relaxed) < sequence) {
+    retire(retired_.load(std::memory_order_relaxed));
+  }
+  const size_t offset =
+      slot(sequence).reserved.fetch_add(options_.segment_size + 1);
+  seal(sequence, std::min(offset, options_.segment_size));
+  retire(sequence);
+
+  // Segments prepared ahead were never written
+  for (uint64_t next = sequence + 1; next < prepared_; next++) {
+    Segment &segment = slot(next);
+    munmap(segment.base, options_.segment_size);
+    close(segment.fd);
+    unlink(segment_path(next).c_str());
+  }
+}
+
+bool MappedLogFile::open() noexcept {
+  if (opened_ || path_.empty() || (options_.segment_size == 0)) {
+    return false;
+  }
+
+  uint64_t first{0};
+  while (access(segment_path(first).c_str(), F_OK) == 0) {
+    first++;
+  }
+  current_ = first;
+  prepared_ = first;
+  retired_ = first;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!prepare(first)) {
+      return false;
+    }
+  }
+  slot(first).opened = std::chrono::steady_clock::now();
+  opened_ = true;
+  init();
+  return true;
+}
+
+bool MappedLogFile::append(const char *line, size_t length) noexcept {
+  const size_t size = length + 1;
+  if (!opened_ || (size > options_.segment_size)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  for (size_t attempt = 0; attempt < cMaxAppendAttempts; attempt++) {
+    uint64_t sequence{0};
+    Segment *segment = enter(sequence);
+    if (!segment) {
+      continue;
+    }
+    const size_t offset =
+        segment->reserved.fetch_add(size, std::memory_order_relaxed);
+    if (offset + size <= options_.segment_size) {
+      memcpy(segment->base + offset, line, length);
+      segment->base[offset + length] = '\n';
+      segment->writers.fetch_sub(1, std::memory_order_release);
+      return true;
+    }
+    segment->writers.fetch_sub(1, std::memory_order_release);
+
+    // The first writer past the end seals the segment, others wait for the
+    // switch to the next one
+    if (offset <= options_.segment_size) {
+      seal(sequence, offset);
+    }
+    if (!rotate(sequence)) {
+      std::this_thread::yield();
+    }
+  }
+  dropped_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void MappedLogFile::sync() noexcept {
+  if (!opened_) {
+    return;
+  }
+  uint64_t sequence{0};
+  Segment *segment{nullptr};
+  while (!(segment = enter(sequence))) {
+  }
+  const size_t length =
+      std::min(segment->reserved.load(), options_.segment_size);
+  msync(segment->base, length, MS_SYNC);
+  segment->writers.fetch_sub(1, std::memory_order_release);
+
+  // Earlier segments are synced when retired
+  while (running() && (retired_.load(std::memory_order_acquire) < sequence)) {
+    std::this_thread::yield();
+  }
+}
+
+std::string MappedLogFile::segment_path(uint64_t sequence) const {
+  return path_ + "." + std::to_string(sequence);
+}
+
+void MappedLogFile::run() {
+  const auto sync_interval =
+      std::chrono::milliseconds(options_.sync_interval_ms);
+  const auto rotate_interval =
+      std::chrono::milliseconds(options_.rotate_interval_ms);
+  auto next_sync = std::chrono::steady_clock::now() + sync_interval;
+
+  while (running()) {
+    const uint64_t sequence = current_.load(std::memory_order_acquire);
+    while (retired_.load(std::memory_order_relaxed) < sequence) {
+      retire(retired_.load(std::memory_order_relaxed));
+    }
+    if (prepared_.load(std::memory_order_acquire) <= sequence + 1) {
+      std::lock_guard<std::mutex> lock(mtx_);
+      prepare(sequence + 1);
+    }
+
+    Segment &segment = slot(sequence);
+    const auto now = std::chrono::steady_clock::now();
+    if (sealed_.load(std::memory_order_acquire) == sequence + 1) {
+      // Sealed by a writer that could not prepare the next segment
+      rotate(sequence);
+    } else if ((options_.rotate_interval_ms != 0) &&
+               (now - segment.opened >= rotate_interval) &&
+               (segment.reserved.load(std::memory_order_relaxed) != 0)) {
+      const size_t offset =
+          segment.reserved.fetch_add(options_.segment_size + 1);
+      if (offset <= options_.segment_size) {
+        seal(sequence, offset);
+        rotate(sequence);
+      }
+    }
+
+    if ((options_.sync_interval_ms != 0) && (now >= next_sync)) {
+      const size_t length =
+          std::min(segment.reserved.load(std::memory_order_relaxed),
+                   options_.segment_size);
+      msync(segment.base, length, MS_ASYNC);
+      next_sync = now + sync_interval;
+    }
+    std::this_thread::sleep_for(cIdleSleep);
+  }
+}
+
+MappedLogFile::Segment *MappedLogFile::enter(uint64_t &sequence) noexcept {
+  // Pairs with rotate() storing the next sequence before retire() reads the
+  // writer count, so either the writer sees the switch or retire() sees the
+  // writer
+  sequence = current_.load();
+  Segment &segment = slot(sequence);
+  segment.writers.fetch_add(1);
+  if (current_.load() != sequence) {
+    segment.writers.fetch_sub(1, std::memory_order_release);
+    return nullptr;
+  }
+  return &segment;
+}
+
+bool MappedLogFile::prepare(uint64_t sequence) noexcept {
+  if (sequence < prepared_.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  if (sequence >= retired_.load(std::memory_order_acquire) + cSegmentSlots) {
+    return false;
+  }
+
+  const std::string path = segment_path(sequence);
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                        0644);
+  if (fd < 0) {
+    return false;
+  }
+  const auto size = static_cast<off_t>(options_.segment_size);
+  void *base{MAP_FAILED};
+  if (posix_fallocate(fd, 0, size) == 0) {
+    base = mmap(nullptr, options_.segment_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd, 0);
+  }
+  if (base == MAP_FAILED) {
+    close(fd);
+    unlink(path.c_str());
+    return false;
+  }
+
+  Segment &segment = slot(sequence);
+  segment.base = static_cast<char *>(base);
+  segment.fd = fd;
+  segment.reserved.store(0, std::memory_order_relaxed);
+  segment.used.store(0, std::memory_order_relaxed);
+  prepared_.store(sequence + 1, std::memory_order_release);
+  return true;
+}
+
+void MappedLogFile::seal(uint64_t sequence, size_t used) noexcept {
+  slot(sequence).used.store(used, std::memory_order_release);
+  sealed_.store(sequence + 1, std::memory_order_release);
+}
+
+bool MappedLogFile::rotate(uint64_t sequence) noexcept {
+  if (current_.load(std::memory_order_acquire) != sequence) {
+    return true;
+  }
+  if (sealed_.load(std::memory_order_acquire) != sequence + 1) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (current_.load(std::memory_order_relaxed) != sequence) {
+    return true;
+  }
+  if (!prepare(sequence + 1)) {
+    return false;
+  }
+  slot(sequence + 1).opened = std::chrono::steady_clock::now();
+  current_.store(sequence + 1);
+  return true;
+}
+
+void MappedLogFile::retire(uint64_t sequence) noexcept {
+  Segment &segment = slot(sequence);
+  while (segment.writers.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  munmap(segment.base, options_.segment_size);
+  if (ftruncate(segment.fd,
+                static_cast<off_t>(segment.used.load(
+                    std::memory_order_acquire))) == 0) {
+    fdatasync(segment.fd);
+  }
+  close(segment.fd);
+  segment.base = nullptr;
+  segment.fd = -1;
+  retired_.store(sequence + 1, std::memory_order_release);
+}
+
+}  // namespace qle
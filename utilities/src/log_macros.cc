@@ -0,0 +1 @@
+#include <utilities/log_macros.h>
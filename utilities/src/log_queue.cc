@@ -0,0 +1,63 @@
+#include <utilities/log_queue.h>
+
+#include <algorithm>
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief Round \p value up to a power of 2
+ */
+size_t round_up_pow2(size_t value) noexcept {
+  size_t result{1};
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace
+
+LogQueue::LogQueue(size_t capacity) noexcept
+    : buffer_(round_up_pow2(std::max<size_t>(capacity, 2)) * sizeof(Cell)) {
+  if (!buffer_.valid()) {
+    return;
+  }
+  const size_t cells = round_up_pow2(std::max<size_t>(capacity, 2));
+  cells_ = reinterpret_cast<Cell *>(buffer_.Data());
+  mask_ = cells - 1;
+  for (size_t i = 0; i < cells; i++) {
+    new (&cells_[i].sequence) std::atomic<size_t>(i);
+  }
+}
+
+bool LogQueue::push(LogLevel::Level level, const char *line, size_t length,
+                    uint64_t ticks) noexcept {
+  Cell *cell{nullptr};
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &cells_[pos & mask_];
+    const size_t seq = cell->sequence.load(std::memory_order_acquire);
+    const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->record.level = level;
+  cell->record.ticks = ticks;
+  cell->record.length = std::min(length, cMaxLogLineLength);
+  memcpy(cell->record.text, line, cell->record.length);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+}  // namespace qle
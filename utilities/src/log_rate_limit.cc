@@ -0,0 +1,22 @@
+#include <utilities/log_rate_limit.h>
+
+namespace qle {
+
+uint64_t LogRateLimit::summary() noexcept {
+  const uint64_t now = now_ns();
+  uint64_t due = next_summary_.load(std::memory_order_relaxed);
+  if (due == 0) {
+    // First suppressed line: the first summary is one interval later
+    next_summary_.compare_exchange_strong(due, now + summary_interval_ns_,
+                                          std::memory_order_relaxed);
+    return 0;
+  }
+  if ((now < due) ||
+      !next_summary_.compare_exchange_strong(due, now + summary_interval_ns_,
+                                             std::memory_order_relaxed)) {
+    return 0;
+  }
+  return suppressed_.exchange(0, std::memory_order_relaxed);
+}
+
+}  // namespace qle
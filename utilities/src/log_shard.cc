@@ -0,0 +1,192 @@
+#include <utilities/log_clock.h>
+#include <utilities/log_shard.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <new>
+#include <unordered_map>
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief Source of unique ShardedLogFile ids, so that a shard cached by a
+ * thread is never mistaken for one of a later instance
+ */
+std::atomic<uint64_t> next_sharded_file_id{1};
+
+/**
+ * @brief Live ShardedLogFile instances by id, so that an exiting thread
+ * hands its shard back only to an instance not destroyed yet
+ */
+struct LiveFiles {
+  std::mutex mtx;                                        ///< Mutex
+  std::unordered_map<uint64_t, ShardedLogFile *> files;  ///< Instances
+};
+
+/**
+ * @brief Get the live instances, never destroyed so that threads exiting
+ * during static destruction can release their shard
+ *
+ * @return LiveFiles&
+ */
+LiveFiles &live_files() noexcept {
+  static LiveFiles *files = new LiveFiles();
+  return *files;
+}
+
+}  // namespace
+
+thread_local ShardedLogFile::ThreadShard ShardedLogFile::thread_shard_;
+
+ShardedLogFile::ShardedLogFile(const char *path) noexcept
+    : path_(path ? path : ""), id_(next_sharded_file_id.fetch_add(1)) {
+  LogClock::calibrate();
+  LiveFiles &live = live_files();
+  std::lock_guard<std::mutex> lock(live.mtx);
+  try {
+    live.files.emplace(id_, this);
+  } catch (const std::bad_alloc &) {
+    // Shards of exited threads are then not reused
+  }
+}
+
+ShardedLogFile::~ShardedLogFile() {
+  {
+    LiveFiles &live = live_files();
+    std::lock_guard<std::mutex> lock(live.mtx);
+    live.files.erase(id_);
+  }
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (auto &shard : shards_) {
+    fclose(shard->file);
+  }
+}
+
+bool ShardedLogFile::append(const char *line, size_t length,
+                            uint64_t ticks) noexcept {
+  Shard *current = shard();
+  if (!current) {
+    return false;
+  }
+  // The merge key is the time the line was logged, on the log clock
+  const uint64_t timestamp = LogClock::to_ns(ticks ? ticks : LogClock::now());
+  return fprintf(current->file, "%" PRIu64 " %.*s\n", timestamp,
+                 static_cast<int>(length), line) > 0;
+}
+
+void ShardedLogFile::flush() noexcept {
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (auto &shard : shards_) {
+    fflush(shard->file);
+  }
+}
+
+size_t ShardedLogFile::shard_count() noexcept {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return shards_.size();
+}
+
+std::string ShardedLogFile::shard_path(size_t index) const {
+  return path_ + "." + std::to_string(index);
+}
+
+void ShardedLogFile::ThreadShard::release() noexcept {
+  if (!shard) {
+    return;
+  }
+  LiveFiles &live = live_files();
+  std::lock_guard<std::mutex> lock(live.mtx);
+  auto it = live.files.find(owner);
+  if (it != live.files.end()) {
+    ShardedLogFile *file = it->second;
+    std::lock_guard<std::mutex> file_lock(file->mtx_);
+    try {
+      file->free_shards_.push_back(shard);
+    } catch (const std::bad_alloc &) {
+    }
+  }
+  owner = 0;
+  shard = nullptr;
+}
+
+ShardedLogFile::Shard *ShardedLogFile::shard() noexcept {
+  if (thread_shard_.owner == id_) {
+    return thread_shard_.shard;
+  }
+
+  // First line of this thread: only taking a shard takes the mutex. A
+  // shard cached for another instance goes back to it first.
+  thread_shard_.release();
+  std::lock_guard<std::mutex> lock(mtx_);
+  Shard *taken{nullptr};
+  if (!free_shards_.empty()) {
+    taken = free_shards_.back();
+    free_shards_.pop_back();
+  } else {
+    try {
+      auto created = std::make_unique<Shard>();
+      created->file = fopen(shard_path(shards_.size()).c_str(), "w");
+      if (!created->file) {
+        return nullptr;
+      }
+      created->buffer = std::make_unique<char[]>(cLogShardBufferSize);
+      setvbuf(created->file, created->buffer.get(), _IOFBF,
+              cLogShardBufferSize);
+      shards_.push_back(std::move(created));
+      // Reserved now, so that releasing it cannot fail
+      free_shards_.reserve(shards_.size());
+    } catch (const std::bad_alloc &) {
+      return nullptr;
+    }
+    taken = shards_.back().get();
+  }
+  thread_shard_.owner = id_;
+  thread_shard_.shard = taken;
+  return taken;
+}
+
+size_t LogShardMerger::open(const char *path) {
+  for (size_t index = 0;; index++) {
+    auto file = std::make_unique<std::ifstream>(std::string(path) + "." +
+                                                std::to_string(index));
+    if (!file->is_open()) {
+      break;
+    }
+    files_.push_back(std::move(file));
+    lines_.emplace_back();
+    advance(files_.size() - 1);
+  }
+  return files_.size();
+}
+
+bool LogShardMerger::next(uint64_t &timestamp, std::string &line) {
+  if (heap_.empty()) {
+    return false;
+  }
+  const Entry entry = heap_.top();
+  heap_.pop();
+  timestamp = entry.first;
+  line.swap(lines_[entry.second]);
+  advance(entry.second);
+  return true;
+}
+
+void LogShardMerger::advance(size_t index) {
+  std::string &pending = lines_[index];
+  while (std::getline(*files_[index], pending)) {
+    char *end{nullptr};
+    const uint64_t timestamp = strtoull(pending.c_str(), &end, 10);
+    if ((end == pending.c_str()) || (*end != ' ')) {
+      // Not written by ShardedLogFile, e.g. a torn last line
+      continue;
+    }
+    pending.erase(0, static_cast<size_t>(end - pending.c_str()) + 1);
+    heap_.emplace(timestamp, index);
+    return;
+  }
+}
+
+}  // namespace qle
@@ -0,0 +1,165 @@
+#include <utilities/log_sink.h>
+
+#include <chrono>
+#include <thread>
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief Sleep of the sink thread when the queue is empty
+ */
+constexpr auto cIdleSleep = std::chrono::microseconds(200);
+
+}  // namespace
+
+void ConsoleLogSink::write(LogLevel::Level level, const char *line,
+                           size_t length) noexcept {
+  FILE *stream = (level >= LogLevel::WARNING) ? stderr : stdout;
+  std::lock_guard<std::mutex> lock(mtx_);
+  fprintf(stream, "%.*s\n", static_cast<int>(length), line);
+}
+
+void ConsoleLogSink::flush() noexcept {
+  std::lock_guard<std::mutex> lock(mtx_);
+  fflush(stdout);
+  fflush(stderr);
+}
+
+FileLogSink::FileLogSink(const char *path) noexcept {
+  if (!path) {
+    return;
+  }
+  file_ = fopen(path, "w");
+  if (!file_) {
+    return;
+  }
+  buffer_.reset(new (std::nothrow) char[cLogFileBufferSize]);
+  if (buffer_) {
+    setvbuf(file_, buffer_.get(), _IOFBF, cLogFileBufferSize);
+  }
+}
+
+FileLogSink::~FileLogSink() {
+  if (file_) {
+    fclose(file_);
+  }
+}
+
+void FileLogSink::write(LogLevel::Level, const char *line,
+                        size_t length) noexcept {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (file_) {
+    fprintf(file_, "%.*s\n", static_cast<int>(length), line);
+  }
+}
+
+void FileLogSink::flush() noexcept {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (file_) {
+    fflush(file_);
+  }
+}
+
+void MemoryLogSink::write(LogLevel::Level, const char *line,
+                          size_t length) noexcept {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (capacity_ == 0) {
+    return;
+  }
+  try {
+    if (lines_.size() == capacity_) {
+      // Reuse the storage of the oldest line
+      std::string oldest = std::move(lines_.front());
+      lines_.pop_front();
+      oldest.assign(line, length);
+      lines_.push_back(std::move(oldest));
+    } else {
+      lines_.emplace_back(line, length);
+    }
+  } catch (const std::bad_alloc &) {
+  }
+}
+
+std::vector<std::string> MemoryLogSink::lines() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return std::vector<std::string>(lines_.begin(), lines_.end());
+}
+
+bool AsyncLogSink::start() noexcept {
+  if (!sink_ || !queue_.valid()) {
+    return false;
+  }
+  init();
+  while (!started_.load(std::memory_order_acquire) && running()) {
+    std::this_thread::yield();
+  }
+  return started_.load(std::memory_order_acquire);
+}
+
+void AsyncLogSink::write(LogLevel::Level level, const char *line,
+                         size_t length) noexcept {
+  if (length > cMaxLogLineLength) {
+    // Keep the order of the lines of this thread
+    flush();
+    sink_->write(level, line, length);
+    return;
+  }
+  switch (policy_) {
+    case LogOverflowPolicy::BLOCK:
+      while (!queue_.push(level, line, length)) {
+        std::this_thread::yield();
+      }
+      break;
+    case LogOverflowPolicy::DROP_NEWEST:
+      if (!queue_.push(level, line, length)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+      }
+      break;
+    case LogOverflowPolicy::OVERWRITE_OLDEST:
+      while (!queue_.push(level, line, length)) {
+        if (queue_.pop([](const LogRecord &) {})) {
+          dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void AsyncLogSink::flush() noexcept {
+  const uint64_t target = queue_.pushed_count();
+  while (running() && (queue_.popped_count() < target)) {
+    std::this_thread::yield();
+  }
+  if (sink_) {
+    sink_->flush();
+  }
+}
+
+void AsyncLogSink::run() {
+  started_.store(true, std::memory_order_release);
+  while (running()) {
+    if (!drain()) {
+      std::this_thread::sleep_for(cIdleSleep);
+    }
+  }
+  drain();
+  sink_->flush();
+}
+
+bool AsyncLogSink::drain() noexcept {
+  bool written{false};
+  while (queue_.pop([this](const LogRecord &record) {
+    if (sink_->accepts(record.level)) {
+      sink_->write(record.level, record.text, record.length);
+    }
+  })) {
+    written = true;
+  }
+  return written;
+}
+
+}  // namespace qle
@@ -0,0 +1,341 @@
+#include <utilities/log.h>
+#include <utilities/log_site.h>
+
+#include <fnmatch.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief Longest sleep of the watcher, so that it stops promptly
+ */
+constexpr auto cWatchSleep = std::chrono::milliseconds(10);
+
+/**
+ * @brief Parsed LogSiteRegistry rule
+ */
+struct Rule {
+  std::string file;                      ///< File glob, empty for any
+  std::string function;                  ///< Function glob, empty for any
+  int first_line{0};                     ///< First line matched
+  int last_line{INT_MAX};                ///< Last line matched
+  std::string format;                    ///< Format text, empty for any
+  LogSite::Mode mode{LogSite::DEFAULT};  ///< Mode of the matched sites
+};
+
+/**
+ * @brief Enrolled sites and rules, guarded by mtx
+ */
+struct Registry {
+  std::mutex mtx;                   ///< Registry mutex
+  LogSite *head{nullptr};           ///< Last enrolled site
+  size_t size{0};                   ///< Enrolled sites
+  std::vector<Rule> rules;          ///< Rules, oldest first
+  std::deque<std::string> formats;  ///< Formats of the enrolled sites
+};
+
+/**
+ * @brief Get the registry, never destroyed so that sites may enroll during
+ * static destruction
+ *
+ * @return Registry&
+ */
+Registry &registry() noexcept {
+  static Registry *state = new Registry();
+  return *state;
+}
+
+/**
+ * @brief Get the LogSiteWatcher logger
+ *
+ * @return Logger&
+ */
+Logger &logger() {
+  static Logger watcher_logger("LogSiteWatcher");
+  return watcher_logger;
+}
+
+/**
+ * @brief Parse "N" or "N-M"
+ *
+ * @return bool false if invalid
+ */
+bool parse_lines(const std::string &text, Rule &rule) {
+  char *end{nullptr};
+  const long first = strtol(text.c_str(), &end, 10);
+  long last = first;
+  if (*end == '-') {
+    const char *next = end + 1;
+    last = strtol(next, &end, 10);
+    if (end == next) {
+      return false;
+    }
+  }
+  if ((end == text.c_str()) || (*end != '\0') || (first < 0) ||
+      (last < first) || (last > INT_MAX)) {
+    return false;
+  }
+  rule.first_line = static_cast<int>(first);
+  rule.last_line = static_cast<int>(last);
+  return true;
+}
+
+/**
+ * @brief Parse "[file GLOB] [func GLOB] [line N[-M]] [format TEXT] FLAG"
+ *
+ * @return bool false if invalid
+ */
+bool parse(const char *text, Rule &rule) {
+  std::istringstream stream(text);
+  std::vector<std::string> tokens;
+  std::string token;
+  while (stream >> token) {
+    tokens.push_back(token);
+  }
+  if (tokens.empty() || (tokens.size() % 2 == 0)) {
+    return false;
+  }
+
+  const std::string &flag = tokens.back();
+  if (flag == "+") {
+    rule.mode = LogSite::ENABLED;
+  } else if (flag == "-") {
+    rule.mode = LogSite::DISABLED;
+  } else if (flag == "=") {
+    rule.mode = LogSite::DEFAULT;
+  } else {
+    return false;
+  }
+
+  for (size_t i = 0; i + 1 < tokens.size(); i += 2) {
+    const std::string &key = tokens[i];
+    const std::string &value = tokens[i + 1];
+    if (key == "file") {
+      rule.file = value;
+    } else if (key == "func") {
+      rule.function = value;
+    } else if (key == "line") {
+      if (!parse_lines(value, rule)) {
+        return false;
+      }
+    } else if (key == "format") {
+      rule.format = value;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Check if \p rule matches \p site
+ */
+bool matches(const Rule &rule, const LogSite &site) noexcept {
+  if (!rule.file.empty()) {
+    const char *file = site.file();
+    if (rule.file.find('/') == std::string::npos) {
+      const char *base = strrchr(file, '/');
+      file = base ? base + 1 : file;
+    }
+    if (fnmatch(rule.file.c_str(), file, 0) != 0) {
+      return false;
+    }
+  }
+  if (!rule.function.empty() &&
+      (fnmatch(rule.function.c_str(), site.function(), 0) != 0)) {
+    return false;
+  }
+  if ((site.line() < rule.first_line) || (site.line() > rule.last_line)) {
+    return false;
+  }
+  return rule.format.empty() ||
+         (site.format() && strstr(site.format(), rule.format.c_str()));
+}
+
+/**
+ * @brief Mode flag of a site in dumps
+ */
+char mode_flag(LogSite::Mode mode) noexcept {
+  switch (mode) {
+    case LogSite::ENABLED:
+      return '+';
+    case LogSite::DISABLED:
+      return '-';
+    default:
+      return '=';
+  }
+}
+
+}  // namespace
+
+LogSite::Mode LogSiteRegistry::enroll(LogSite &site,
+                                      const char *format) noexcept {
+  Registry &state = registry();
+  std::lock_guard<std::mutex> lock(state.mtx);
+  const LogSite::Mode current = site.mode_.load(std::memory_order_relaxed);
+  if (current != LogSite::UNREGISTERED) {
+    return current;
+  }
+  if (format) {
+    // Copied, as a runtime format may not outlive the call
+    try {
+      state.formats.emplace_back(format);
+      site.format_ = state.formats.back().c_str();
+    } catch (const std::bad_alloc &) {
+    }
+  }
+  site.next_ = state.head;
+  state.head = &site;
+  state.size++;
+
+  LogSite::Mode mode{LogSite::DEFAULT};
+  for (const Rule &rule : state.rules) {
+    if (matches(rule, site)) {
+      mode = rule.mode;
+    }
+  }
+  site.mode_.store(mode, std::memory_order_release);
+  return mode;
+}
+
+bool LogSiteRegistry::apply(const char *rule, size_t *matched) noexcept {
+  if (!rule) {
+    return false;
+  }
+  try {
+    Rule parsed;
+    if (!parse(rule, parsed)) {
+      return false;
+    }
+    Registry &state = registry();
+    std::lock_guard<std::mutex> lock(state.mtx);
+    size_t count{0};
+    for (LogSite *site = state.head; site; site = site->next_) {
+      if (matches(parsed, *site)) {
+        site->mode_.store(parsed.mode, std::memory_order_relaxed);
+        count++;
+      }
+    }
+    state.rules.push_back(std::move(parsed));
+    if (matched) {
+      *matched = count;
+    }
+    return true;
+  } catch (const std::bad_alloc &) {
+    return false;
+  }
+}
+
+void LogSiteRegistry::reset() noexcept {
+  Registry &state = registry();
+  std::lock_guard<std::mutex> lock(state.mtx);
+  state.rules.clear();
+  for (LogSite *site = state.head; site; site = site->next_) {
+    site->mode_.store(LogSite::DEFAULT, std::memory_order_relaxed);
+  }
+}
+
+size_t LogSiteRegistry::size() noexcept {
+  Registry &state = registry();
+  std::lock_guard<std::mutex> lock(state.mtx);
+  return state.size;
+}
+
+void LogSiteRegistry::dump(FILE *stream) noexcept {
+  try {
+    Registry &state = registry();
+    std::lock_guard<std::mutex> lock(state.mtx);
+    std::vector<const LogSite *> sites;
+    for (const LogSite *site = state.head; site; site = site->next_) {
+      sites.push_back(site);
+    }
+    std::sort(sites.begin(), sites.end(),
+              [](const LogSite *a, const LogSite *b) {
+                const int order = strcmp(a->file(), b->file());
+                return (order != 0) ? (order < 0) : (a->line() < b->line());
+              });
+    for (const LogSite *site : sites) {
+      fprintf(stream, "%s:%d [%s] %s =%c \"%s\"\n", site->file(),
+              site->line(), site->function(),
+              LogLevel::log_level_to_string(site->level()),
+              mode_flag(site->mode()), site->format() ? site->format() : "");
+    }
+    fflush(stream);
+  } catch (const std::bad_alloc &) {
+  }
+}
+
+void LogSiteWatcher::start() noexcept {
+  version_ = file_version();
+  reload();
+  init();
+}
+
+size_t LogSiteWatcher::reload() noexcept {
+  size_t applied{0};
+  LogSiteRegistry::reset();
+  try {
+    std::ifstream file(path_);
+    std::string line;
+    while (std::getline(file, line)) {
+      const size_t first = line.find_first_not_of(" \t\r");
+      if ((first == std::string::npos) || (line[first] == '#')) {
+        continue;
+      }
+      if (LogSiteRegistry::apply(line.c_str())) {
+        applied++;
+      } else {
+        logger().warn("Invalid rule \"%s\" in %s", line.c_str(),
+                      path_.c_str());
+      }
+    }
+  } catch (const std::bad_alloc &) {
+  }
+  reloads_.fetch_add(1, std::memory_order_release);
+  return applied;
+}
+
+void LogSiteWatcher::run() {
+  const auto interval = std::chrono::milliseconds(interval_ms_);
+  auto next = std::chrono::steady_clock::now() + interval;
+  while (running()) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= next) {
+      const std::string version = file_version();
+      if (version != version_) {
+        version_ = version;
+        reload();
+      }
+      next = now + interval;
+      continue;
+    }
+    std::this_thread::sleep_for(
+        std::min<std::chrono::steady_clock::duration>(next - now, cWatchSleep));
+  }
+}
+
+std::string LogSiteWatcher::file_version() const {
+  struct stat info {};
+  if (stat(path_.c_str(), &info) != 0) {
+    return std::string();
+  }
+  return std::to_string(info.st_mtim.tv_sec) + "." +
+         std::to_string(info.st_mtim.tv_nsec) + "/" +
+         std::to_string(info.st_size);
+}
+
+}  // namespace qle
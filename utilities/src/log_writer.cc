@@ -0,0 +1,121 @@
+#include <utilities/log_writer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace qle {
+
+namespace {
+
+/**
+ * @brief Sleep of the writer thread when the queue is empty
+ */
+constexpr auto cIdleSleep = std::chrono::microseconds(200);
+
+/**
+ * @brief Longest sleep of the flush thread, bounding how long stopping takes
+ */
+constexpr auto cFlushSleep = std::chrono::milliseconds(10);
+
+}  // namespace
+
+bool AsyncLogWriter::start() noexcept {
+  if (!queue_.valid()) {
+    return false;
+  }
+  init();
+  while (!started_.load(std::memory_order_acquire) && running()) {
+    std::this_thread::yield();
+  }
+  return started_.load(std::memory_order_acquire);
+}
+
+void AsyncLogWriter::push(LogLevel::Level level, const char *line,
+                          size_t length, uint64_t ticks) noexcept {
+  if (length > cMaxLogLineLength) {
+    // Keep the order of the lines of this thread
+    flush();
+    config_.write_line(level, line, length, ticks);
+    config_.flush_batch();
+    return;
+  }
+  switch (policy_) {
+    case LogOverflowPolicy::BLOCK:
+      while (!queue_.push(level, line, length, ticks)) {
+        std::this_thread::yield();
+      }
+      break;
+    case LogOverflowPolicy::DROP_NEWEST:
+      if (!queue_.push(level, line, length, ticks)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+      }
+      break;
+    case LogOverflowPolicy::OVERWRITE_OLDEST:
+      while (!queue_.push(level, line, length, ticks)) {
+        if (queue_.pop([](const LogRecord &) {})) {
+          overwritten_.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void AsyncLogWriter::flush() noexcept {
+  const uint64_t target = queue_.pushed_count();
+  while (queue_.popped_count() < target) {
+    std::this_thread::yield();
+  }
+}
+
+void AsyncLogWriter::run() {
+  started_.store(true, std::memory_order_release);
+  while (running()) {
+    if (!drain()) {
+      std::this_thread::sleep_for(cIdleSleep);
+    }
+  }
+  drain();
+}
+
+bool AsyncLogWriter::drain() noexcept {
+  bool written{false};
+  while (queue_.pop([this](const LogRecord &record) {
+    config_.write_line(record.level, record.text, record.length,
+                       record.ticks);
+  })) {
+    written = true;
+  }
+  if (written) {
+    config_.flush_batch();
+  }
+  return written;
+}
+
+bool LogFlusher::start() noexcept {
+  init();
+  while (!started_.load(std::memory_order_acquire) && running()) {
+    std::this_thread::yield();
+  }
+  return started_.load(std::memory_order_acquire);
+}
+
+void LogFlusher::run() {
+  started_.store(true, std::memory_order_release);
+  const auto interval = std::chrono::milliseconds(interval_ms_);
+  auto next = std::chrono::steady_clock::now() + interval;
+  while (running()) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= next) {
+      config_.flush_pending();
+      next = now + interval;
+      continue;
+    }
+    std::this_thread::sleep_for(
+        std::min<std::chrono::steady_clock::duration>(next - now, cFlushSleep));
+  }
+}
+
+}  // namespace qle
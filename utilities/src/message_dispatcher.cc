@@ -0,0 +1 @@
+#include <utilities/message_dispatcher.h>
@@ -0,0 +1,65 @@
+#include <utilities/object_pool.h>
+
+namespace qle {
+
+constexpr size_t ThreadSlot::cMaxThreads;
+constexpr size_t ThreadSlot::cNoSlot;
+
+namespace {
+
+static_assert(ThreadSlot::cMaxThreads <= 64, "Slots must fit in a bitmap");
+
+/**
+ * @brief Bitmap of slots held by running threads
+ */
+std::atomic<uint64_t> used_slots{0};
+
+/**
+ * @brief Holds the slot of one thread for its lifetime
+ */
+class SlotHolder {
+ public:
+  /**
+   * @brief Take the lowest free slot
+   */
+  SlotHolder() noexcept {
+    uint64_t used = used_slots.load(std::memory_order_relaxed);
+    while (~used != 0) {
+      const auto slot = static_cast<size_t>(__builtin_ctzll(~used));
+      if (used_slots.compare_exchange_weak(used, used | (1ULL << slot),
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+        id_ = slot;
+        break;
+      }
+    }
+  }
+
+  /**
+   * @brief Give the slot back
+   */
+  ~SlotHolder() noexcept {
+    if (id_ != ThreadSlot::cNoSlot) {
+      used_slots.fetch_and(~(1ULL << id_), std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Get slot
+   *
+   * @return size_t
+   */
+  size_t id() const noexcept { return id_; }
+
+ private:
+  size_t id_{ThreadSlot::cNoSlot};  ///< Slot
+};
+
+}  // namespace
+
+size_t ThreadSlot::id() noexcept {
+  static thread_local SlotHolder holder;
+  return holder.id();
+}
+
+}  // namespace qle
@@ -4,32 +4,50 @@
 #include <cstring>
 #include <memory>
 
-static const auto logger = std::make_unique<qle::Logger>("Thread");
-
 namespace qle {
 
+namespace {
+
+/**
+ * @brief Get the Thread logger
+ *
+ * Created on first use rather than at load time, so that linking Thread
+ * does not create a LoggerConfig before the application configures one.
+ *
+ * @return Logger&
+ */
+Logger &logger() {
+  static Logger thread_logger("Thread");
+  return thread_logger;
+}
+
+}  // namespace
+
 void Thread::init() noexcept {
+  // Mark running before the thread starts, so that a deinit() right after
+  // init() is not overwritten by the new thread
+  running_ = true;
   thread_ = std::thread([this]() {
+    // thread_ may not be assigned yet, so name the thread from inside
     if ((thread_name_ != nullptr) && (strlen(thread_name_) != 0) &&
-        (pthread_setname_np(thread_.native_handle(), thread_name_) != 0)) {
-      logger->error("Fail to set up thread name \"%s\"", thread_name_);
+        (pthread_setname_np(pthread_self(), thread_name_) != 0)) {
+      logger().error("Fail to set up thread name \"%s\"", thread_name_);
       running_ = false;
       return;
     }
-    running_ = true;
-    logger->debug("Start thread %s", thread_name_);
+    logger().debug("Start thread %s", thread_name_);
     run();
-    logger->debug("End thread %s", thread_name_);
+    logger().debug("End thread %s", thread_name_);
   });
 }
 
 void Thread::deinit() noexcept {
   running_ = false;
   if (thread_.joinable()) {
-    logger->debug("Joining thread %s", thread_name_);
+    logger().debug("Joining thread %s", thread_name_);
     thread_.join();
   } else {
-    logger->debug("Thread %s is not joinable", thread_name_);
+    logger().debug("Thread %s is not joinable", thread_name_);
   }
 }
 
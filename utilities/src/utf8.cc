@@ -0,0 +1,268 @@
+#include <utilities/cpu_features.h>
+#include <utilities/utf8.h>
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define QLE_UTF8_HAS_AVX2_IMPL 1
+#endif
+
+namespace qle {
+
+namespace {
+
+/// Mask of the high bit of every byte in a 64-bit word
+constexpr uint64_t cAsciiMask64{0x8080808080808080ULL};
+
+#if defined(QLE_UTF8_HAS_AVX2_IMPL)
+
+// Error classes of the lookup algorithm (Keiser & Lemire, "Validating UTF-8
+// In Less Than One Instruction Per Byte"). A pair of consecutive bytes is
+// classified by the high nibble of the first byte, the low nibble of the
+// first byte and the high nibble of the second byte; the three table lookups
+// are ANDed together and any remaining bit is an error.
+constexpr uint8_t cTooShort{1 << 0};   // 11______ 0_______ / 11______ 11______
+constexpr uint8_t cTooLong{1 << 1};    // 0_______ 10______
+constexpr uint8_t cOverlong3{1 << 2};  // 11100000 100_____
+constexpr uint8_t cTooLarge{1 << 3};   // 11110100 1001____ and above
+constexpr uint8_t cSurrogate{1 << 4};  // 11101101 101_____
+constexpr uint8_t cOverlong2{1 << 5};  // 1100000_ 10______
+constexpr uint8_t cTooLarge1000{1 << 6};  // 11110101 1000____ and above
+constexpr uint8_t cOverlong4{1 << 6};     // 11110000 1000____
+constexpr uint8_t cTwoConts{1 << 7};      // 10______ 10______
+constexpr uint8_t cCarry{cTooShort | cTooLong | cTwoConts};
+
+__attribute__((target("avx2"))) inline __m256i lookup16(__m256i index,
+                                                        __m256i table) {
+  return _mm256_shuffle_epi8(table, index);
+}
+
+__attribute__((target("avx2"))) inline __m256i high_nibbles(__m256i v) {
+  return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+/**
+ * @brief Shift \p input right by N bytes, filling in from \p prev
+ *
+ * Returns for each byte position the byte that was N positions before it in
+ * the stream.
+ */
+template <int N>
+__attribute__((target("avx2"))) inline __m256i prev_bytes(__m256i input,
+                                                          __m256i prev) {
+  return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21),
+                            16 - N);
+}
+
+__attribute__((target("avx2"))) inline __m256i check_special_cases(
+    __m256i input, __m256i prev1) {
+  const __m256i byte_1_high_table = _mm256_setr_epi8(
+      cTooLong, cTooLong, cTooLong, cTooLong, cTooLong, cTooLong, cTooLong,
+      cTooLong, cTwoConts, cTwoConts, cTwoConts, cTwoConts,
+      cTooShort | cOverlong2, cTooShort, cTooShort | cOverlong3 | cSurrogate,
+      cTooShort | cTooLarge | cTooLarge1000 | cOverlong4,
+      // Same table repeated for the upper 128-bit lane
+      cTooLong, cTooLong, cTooLong, cTooLong, cTooLong, cTooLong, cTooLong,
+      cTooLong, cTwoConts, cTwoConts, cTwoConts, cTwoConts,
+      cTooShort | cOverlong2, cTooShort, cTooShort | cOverlong3 | cSurrogate,
+      cTooShort | cTooLarge | cTooLarge1000 | cOverlong4);
+
+  constexpr uint8_t cLarge{cCarry | cTooLarge | cTooLarge1000};
+  const __m256i byte_1_low_table = _mm256_setr_epi8(
+      cCarry | cOverlong3 | cOverlong2 | cOverlong4, cCarry | cOverlong2,
+      cCarry, cCarry, cCarry | cTooLarge, cLarge, cLarge, cLarge, cLarge,
+      cLarge, cLarge, cLarge, cLarge, cLarge | cSurrogate, cLarge, cLarge,
+      // Same table repeated for the upper 128-bit lane
+      cCarry | cOverlong3 | cOverlong2 | cOverlong4, cCarry | cOverlong2,
+      cCarry, cCarry, cCarry | cTooLarge, cLarge, cLarge, cLarge, cLarge,
+      cLarge, cLarge, cLarge, cLarge, cLarge | cSurrogate, cLarge, cLarge);
+
+  constexpr uint8_t cCont1000{cTooLong | cOverlong2 | cTwoConts | cOverlong3 |
+                              cTooLarge1000 | cOverlong4};
+  constexpr uint8_t cCont1001{cTooLong | cOverlong2 | cTwoConts | cOverlong3 |
+                              cTooLarge};
+  constexpr uint8_t cCont101{cTooLong | cOverlong2 | cTwoConts | cSurrogate |
+                             cTooLarge};
+  const __m256i byte_2_high_table = _mm256_setr_epi8(
+      cTooShort, cTooShort, cTooShort, cTooShort, cTooShort, cTooShort,
+      cTooShort, cTooShort, cCont1000, cCont1001, cCont101, cCont101,
+      cTooShort, cTooShort, cTooShort, cTooShort,
+      // Same table repeated for the upper 128-bit lane
+      cTooShort, cTooShort, cTooShort, cTooShort, cTooShort, cTooShort,
+      cTooShort, cTooShort, cCont1000, cCont1001, cCont101, cCont101,
+      cTooShort, cTooShort, cTooShort, cTooShort);
+
+  const __m256i byte_1_high = lookup16(high_nibbles(prev1), byte_1_high_table);
+  const __m256i byte_1_low = lookup16(
+      _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)), byte_1_low_table);
+  const __m256i byte_2_high = lookup16(high_nibbles(input), byte_2_high_table);
+  return _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low),
+                          byte_2_high);
+}
+
+__attribute__((target("avx2"))) inline __m256i check_multibyte_lengths(
+    __m256i input, __m256i prev_input, __m256i special_cases) {
+  const __m256i prev2 = prev_bytes<2>(input, prev_input);
+  const __m256i prev3 = prev_bytes<3>(input, prev_input);
+  // Only 111_____ (resp. 1111____) leaves the high bit set after subtraction
+  const __m256i is_third_byte =
+      _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+  const __m256i is_fourth_byte =
+      _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+  const __m256i must23_80 =
+      _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte),
+                       _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(must23_80, special_cases);
+}
+
+/**
+ * @brief Non-zero where the block ends in the middle of a multi-byte sequence
+ */
+__attribute__((target("avx2"))) inline __m256i is_incomplete(__m256i input) {
+  const __m256i max_value = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, static_cast<char>(0xF0 - 1),
+      static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+  return _mm256_subs_epu8(input, max_value);
+}
+
+/**
+ * @brief Validation state carried across 32-byte blocks
+ */
+struct Avx2State {
+  __m256i error;
+  __m256i prev_input;
+  __m256i prev_incomplete;
+};
+
+__attribute__((target("avx2"))) inline void check_block(Avx2State &state,
+                                                        __m256i input) {
+  if (_mm256_movemask_epi8(input) == 0) {
+    // ASCII block: only a sequence left open by the previous block can fail
+    state.error = _mm256_or_si256(state.error, state.prev_incomplete);
+    state.prev_input = input;
+    state.prev_incomplete = _mm256_setzero_si256();
+    return;
+  }
+  const __m256i prev1 = prev_bytes<1>(input, state.prev_input);
+  const __m256i special_cases = check_special_cases(input, prev1);
+  state.error = _mm256_or_si256(
+      state.error,
+      check_multibyte_lengths(input, state.prev_input, special_cases));
+  state.prev_input = input;
+  state.prev_incomplete = is_incomplete(input);
+}
+
+#endif  // QLE_UTF8_HAS_AVX2_IMPL
+
+}  // namespace
+
+bool Utf8Validator::is_valid(const uint8_t *data, size_t size) noexcept {
+  if (avx2_supported()) {
+    return is_valid_avx2(data, size);
+  }
+  return is_valid_scalar(data, size);
+}
+
+bool Utf8Validator::is_valid_scalar(const uint8_t *data, size_t size) noexcept {
+  size_t i = 0;
+  while (i < size) {
+    // ASCII fast path, 8 bytes at a time
+    if (i + sizeof(uint64_t) <= size) {
+      uint64_t word{0};
+      memcpy(&word, data + i, sizeof(word));
+      if ((word & cAsciiMask64) == 0) {
+        i += sizeof(word);
+        continue;
+      }
+    }
+
+    const uint8_t lead = data[i];
+    if (lead < 0x80) {
+      i++;
+      continue;
+    }
+
+    size_t len{0};
+    uint32_t code_point{0};
+    uint32_t min_code_point{0};
+    if ((lead & 0xE0) == 0xC0) {
+      len = 2;
+      code_point = lead & 0x1F;
+      min_code_point = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+      len = 3;
+      code_point = lead & 0x0F;
+      min_code_point = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+      len = 4;
+      code_point = lead & 0x07;
+      min_code_point = 0x10000;
+    } else {
+      return false;
+    }
+
+    if (i + len > size) {
+      return false;
+    }
+    for (size_t k = 1; k < len; k++) {
+      const uint8_t cont = data[i + k];
+      if ((cont & 0xC0) != 0x80) {
+        return false;
+      }
+      code_point = (code_point << 6) | (cont & 0x3F);
+    }
+
+    if ((code_point < min_code_point) || (code_point > 0x10FFFF) ||
+        ((code_point >= 0xD800) && (code_point <= 0xDFFF))) {
+      return false;
+    }
+    i += len;
+  }
+  return true;
+}
+
+#if defined(QLE_UTF8_HAS_AVX2_IMPL)
+
+__attribute__((target("avx2"))) bool Utf8Validator::is_valid_avx2(
+    const uint8_t *data, size_t size) noexcept {
+  constexpr size_t cBlockSize{sizeof(__m256i)};
+
+  Avx2State state{_mm256_setzero_si256(), _mm256_setzero_si256(),
+                  _mm256_setzero_si256()};
+
+  size_t i = 0;
+  for (; i + cBlockSize <= size; i += cBlockSize) {
+    check_block(state, _mm256_loadu_si256(
+                           reinterpret_cast<const __m256i *>(data + i)));
+  }
+
+  if (i < size) {
+    // Zero padding is ASCII, so a truncated trailing sequence is reported as
+    // too short by the block check itself
+    uint8_t tail[cBlockSize]{};
+    memcpy(tail, data + i, size - i);
+    check_block(state,
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(tail)));
+  }
+
+  state.error = _mm256_or_si256(state.error, state.prev_incomplete);
+  return _mm256_testz_si256(state.error, state.error) != 0;
+}
+
+bool Utf8Validator::avx2_supported() noexcept {
+  return CpuFeatures::has_avx2();
+}
+
+#else
+
+bool Utf8Validator::is_valid_avx2(const uint8_t *data, size_t size) noexcept {
+  return is_valid_scalar(data, size);
+}
+
+bool Utf8Validator::avx2_supported() noexcept { return false; }
+
+#endif  // QLE_UTF8_HAS_AVX2_IMPL
+
+}  // namespace qle
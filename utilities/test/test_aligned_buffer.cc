@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+
+#include <utilities/aligned_buffer.h>
+
+using AlignedBuffer = qle::AlignedBuffer;
+using PageBacking = qle::PageBacking;
+
+namespace {
+
+class TestAlignedBuffer : public ::testing::Test {
+ protected:
+  /**
+   * @brief Assert buffer is valid, aligned and writable
+   *
+   * @param buffer Buffer
+   * @param size Minimum size
+   * @param alignment Alignment
+   */
+  void assert_usable(const AlignedBuffer &buffer, size_t size,
+                     size_t alignment) {
+    ASSERT_TRUE(buffer.valid());
+    ASSERT_GE(buffer.Size(), size);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(buffer.Data()) % alignment, 0U);
+    memset(buffer.Data(), 0xA5, buffer.Size());
+    ASSERT_EQ(buffer.span()[buffer.Size() - 1], 0xA5);
+  }
+};
+
+TEST_F(TestAlignedBuffer, TestHeapBacking) {
+  const std::array<size_t, 4> alignments{8, qle::cCacheLineSize, 256,
+                                         qle::cPageSize};
+  for (auto alignment : alignments) {
+    AlignedBuffer buffer(1000, alignment);
+    assert_usable(buffer, 1000, alignment);
+    EXPECT_EQ(buffer.backing(), PageBacking::DEFAULT);
+    EXPECT_EQ(buffer.Size(), 1000U);
+  }
+}
+
+TEST_F(TestAlignedBuffer, TestHugePageBacking) {
+  AlignedBuffer thp(100, qle::cCacheLineSize, PageBacking::TRANSPARENT_HUGE);
+  assert_usable(thp, qle::cHugePageSize, qle::cHugePageSize);
+  EXPECT_EQ(thp.backing(), PageBacking::TRANSPARENT_HUGE);
+
+  // Falls back to transparent huge pages if no huge page is reserved
+  AlignedBuffer hugetlb(qle::cHugePageSize + 1, qle::cCacheLineSize,
+                        PageBacking::HUGETLB);
+  assert_usable(hugetlb, 2 * qle::cHugePageSize, qle::cHugePageSize);
+}
+
+TEST_F(TestAlignedBuffer, TestInvalidArguments) {
+  EXPECT_FALSE(AlignedBuffer(0).valid());
+  EXPECT_FALSE(AlignedBuffer(100, 0).valid());
+  EXPECT_FALSE(AlignedBuffer(100, 48).valid());  // Not a power of 2
+  EXPECT_FALSE(AlignedBuffer().valid());
+}
+
+TEST_F(TestAlignedBuffer, TestMove) {
+  AlignedBuffer buffer(128);
+  uint8_t *data = buffer.Data();
+
+  AlignedBuffer moved(std::move(buffer));
+  EXPECT_FALSE(buffer.valid());
+  EXPECT_EQ(moved.Data(), data);
+
+  AlignedBuffer assigned(64, qle::cCacheLineSize,
+                         PageBacking::TRANSPARENT_HUGE);
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.Data(), data);
+  EXPECT_EQ(assigned.backing(), PageBacking::DEFAULT);
+
+  assigned.reset();
+  EXPECT_FALSE(assigned.valid());
+}
+
+}  // namespace
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utilities/arena.h>
+
+using Arena = qle::Arena;
+template <typename T>
+using ArenaAllocator = qle::ArenaAllocator<T>;
+
+namespace {
+
+class TestArena : public ::testing::Test {};
+
+TEST_F(TestArena, TestAllocate) {
+  Arena arena(1024);
+  EXPECT_EQ(arena.block_count(), 0U);
+
+  void *a = arena.allocate(10, 1);
+  void *b = arena.allocate(8, 8);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0U);
+  EXPECT_GE(reinterpret_cast<uintptr_t>(b),
+            reinterpret_cast<uintptr_t>(a) + 10);
+  EXPECT_EQ(arena.allocated_bytes(), 18U);
+  EXPECT_EQ(arena.block_count(), 1U);
+
+  void *c = arena.allocate(32, 64);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(c) % 64, 0U);
+}
+
+TEST_F(TestArena, TestChainedBlocks) {
+  Arena arena(256);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_NE(arena.allocate(100), nullptr);
+  }
+  EXPECT_GT(arena.block_count(), 1U);
+  const size_t blocks = arena.block_count();
+
+  // Oversized allocation gets a dedicated block
+  void *large = arena.allocate(4096);
+  ASSERT_NE(large, nullptr);
+  memset(large, 0xAB, 4096);
+  EXPECT_EQ(arena.block_count(), blocks + 1);
+
+  // Reset keeps chained blocks and frees dedicated ones
+  arena.reset();
+  EXPECT_EQ(arena.allocated_bytes(), 0U);
+  EXPECT_EQ(arena.block_count(), blocks);
+
+  // Warm arena reuses its blocks
+  for (int i = 0; i < 10; i++) {
+    ASSERT_NE(arena.allocate(100), nullptr);
+  }
+  EXPECT_EQ(arena.block_count(), blocks);
+}
+
+TEST_F(TestArena, TestAllocator) {
+  Arena arena(512);
+  {
+    std::vector<int, ArenaAllocator<int>> vec{ArenaAllocator<int>(arena)};
+    for (int i = 0; i < 1000; i++) {
+      vec.push_back(i);
+    }
+    EXPECT_EQ(vec[999], 999);
+
+    using String =
+        std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+    String str("a string long enough to skip small string optimization",
+               ArenaAllocator<char>(arena));
+    EXPECT_EQ(str.size(), 54U);
+  }
+  EXPECT_GT(arena.allocated_bytes(), 1000 * sizeof(int));
+
+  ArenaAllocator<int> int_alloc(arena);
+  ArenaAllocator<double> double_alloc(int_alloc);
+  EXPECT_TRUE(int_alloc == double_alloc);
+  Arena other;
+  EXPECT_TRUE(int_alloc != ArenaAllocator<int>(other));
+}
+
+TEST_F(TestArena, TestThreadLocalInstance) {
+  Arena *main_arena = &Arena::thread_local_instance();
+  EXPECT_EQ(main_arena, &Arena::thread_local_instance());
+  EXPECT_EQ(ArenaAllocator<int>().arena(), main_arena);
+
+  Arena *thread_arena{nullptr};
+  std::thread thread([&thread_arena] {
+    thread_arena = &Arena::thread_local_instance();
+    thread_arena->allocate(64);
+  });
+  thread.join();
+  EXPECT_NE(thread_arena, main_arena);
+}
+
+}  // namespace
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <utilities/binary_log.h>
+#include <utilities/clog.h>
+#include <utilities/log.h>
+
+using BinaryLogReader = qle::BinaryLogReader;
+using BinaryLogRecord = qle::BinaryLogRecord;
+using BinaryLogWriter = qle::BinaryLogWriter;
+using LogLevel = qle::LogLevel;
+using Reader = qle::ByteReader<qle::Endianess::LITTLE_END>;
+
+namespace {
+
+class TestBinaryLog : public ::testing::Test {
+ protected:
+  static constexpr const char *cFile{"/tmp/test_binary_log.bin"};
+
+  void SetUp() override { remove(cFile); }
+
+  void TearDown() override { remove(cFile); }
+
+  /**
+   * @brief Encode arguments and render them with \p format
+   */
+  template <typename... Args>
+  static std::string render(const char *format, const Args &...args) {
+    std::vector<uint8_t> encoded(qle::detail::binary_size(args...));
+    qle::detail::binary_encode(encoded.data(), args...);
+    return BinaryLogReader::render(format,
+                                   Reader(encoded.data(), encoded.size()));
+  }
+
+  /**
+   * @brief Write a record through \p writer
+   */
+  template <typename... Args>
+  static void write(BinaryLogWriter &writer, LogLevel::Level level,
+                    const char *format, const Args &...args) {
+    std::vector<uint8_t> encoded(qle::detail::binary_size(args...));
+    qle::detail::binary_encode(encoded.data(), args...);
+    EXPECT_TRUE(writer.write(level, "writer", format, encoded.data(),
+                             encoded.size()));
+  }
+
+  /**
+   * @brief Read all records matching \p filter
+   */
+  static std::vector<BinaryLogRecord> read_all(
+      const qle::BinaryLogFilter &filter, size_t *blocks_skipped = nullptr) {
+    BinaryLogReader reader(filter);
+    EXPECT_TRUE(reader.open(cFile));
+    std::vector<BinaryLogRecord> records;
+    BinaryLogRecord record;
+    while (reader.next(record)) {
+      records.push_back(record);
+    }
+    if (blocks_skipped) {
+      *blocks_skipped = reader.blocks_skipped();
+    }
+    return records;
+  }
+};
+
+constexpr const char *TestBinaryLog::cFile;
+
+TEST_F(TestBinaryLog, Render) {
+  EXPECT_EQ(render("no args"), "no args");
+  EXPECT_EQ(render("{} {} {} {}", -42, 42U, true, 'c'), "-42 42 true c");
+  EXPECT_EQ(render("{:.2f}|{:>4}|{:x}", 3.14159, "ab", 255), "3.14|  ab|ff");
+  EXPECT_EQ(render("{1} {0}", std::string("world"), "hello"), "hello world");
+  EXPECT_EQ(render("{{{}}}", 1), "{1}");
+  EXPECT_EQ(render("{} {}", static_cast<const char *>(nullptr)), "(null) {}");
+}
+
+TEST_F(TestBinaryLog, BlockIndex) {
+  {
+    BinaryLogWriter writer(256);
+    ASSERT_TRUE(writer.open(cFile));
+    EXPECT_FALSE(writer.open(cFile));
+    for (int i = 0; i < 100; i++) {
+      write(writer, LogLevel::DEBUG, "debug {}", i);
+    }
+    write(writer, LogLevel::ERROR, "error {}", 100);
+    writer.flush();
+    for (int i = 0; i < 100; i++) {
+      write(writer, LogLevel::INFO, "info {}", i);
+    }
+  }
+
+  auto records = read_all(qle::BinaryLogFilter());
+  ASSERT_EQ(records.size(), 201U);
+  EXPECT_EQ(records[0].logger, "writer");
+  EXPECT_EQ(records[0].level, LogLevel::DEBUG);
+  EXPECT_EQ(records[0].message, "debug 0");
+  EXPECT_EQ(records[100].message, "error 100");
+  EXPECT_EQ(records[200].message, "info 99");
+  for (size_t i = 1; i < records.size(); i++) {
+    EXPECT_LE(records[i - 1].timestamp, records[i].timestamp);
+  }
+
+  // Blocks of debug records only are skipped by their index
+  qle::BinaryLogFilter filter;
+  filter.min_level = LogLevel::ERROR;
+  size_t skipped{0};
+  records = read_all(filter, &skipped);
+  ASSERT_EQ(records.size(), 1U);
+  EXPECT_EQ(records[0].message, "error 100");
+  EXPECT_GT(skipped, 5U);
+
+  filter = qle::BinaryLogFilter();
+  filter.from = records[0].timestamp;
+  records = read_all(filter);
+  ASSERT_GE(records.size(), 101U);
+  EXPECT_EQ(records.back().message, "info 99");
+}
+
+TEST_F(TestBinaryLog, ReusedBuffers) {
+  {
+    BinaryLogWriter writer;
+    ASSERT_TRUE(writer.open(cFile));
+    // Same addresses, other contents: definitions follow the contents
+    char name[16]{"first"};
+    char format[16]{"one {}"};
+    std::vector<uint8_t> encoded(qle::detail::binary_size(1));
+    qle::detail::binary_encode(encoded.data(), 1);
+    EXPECT_TRUE(writer.write(LogLevel::INFO, name, format, encoded.data(),
+                             encoded.size()));
+    snprintf(name, sizeof(name), "second");
+    snprintf(format, sizeof(format), "two {}");
+    EXPECT_TRUE(writer.write(LogLevel::INFO, name, format, encoded.data(),
+                             encoded.size()));
+    snprintf(name, sizeof(name), "first");
+    snprintf(format, sizeof(format), "one {}");
+    EXPECT_TRUE(writer.write(LogLevel::INFO, name, format, encoded.data(),
+                             encoded.size()));
+  }
+
+  auto records = read_all(qle::BinaryLogFilter());
+  ASSERT_EQ(records.size(), 3U);
+  EXPECT_EQ(records[0].logger, "first");
+  EXPECT_EQ(records[0].message, "one 1");
+  EXPECT_EQ(records[1].logger, "second");
+  EXPECT_EQ(records[1].message, "two 1");
+  EXPECT_EQ(records[2].logger, "first");
+  EXPECT_EQ(records[2].message, "one 1");
+}
+
+TEST_F(TestBinaryLog, Loggers) {
+  {
+    qle::LoggerConfigHandler handler(LogLevel::INFO);
+    ASSERT_TRUE(handler.get_config()->open_binary_file(cFile));
+    EXPECT_FALSE(handler.get_config()->open_binary_file(cFile));
+    EXPECT_TRUE(qle::LoggerConfig::binary_active());
+
+    qle::CLogger clogger("clog");
+    qle::Logger logger("log");
+    clogger.info("value {} of {}", 1, "clog");
+    clogger.warn("text {}", fmt::string_view("view"));
+    clogger.debug("filtered {}", 0);
+    logger.error("printf %d", 2);
+    clogger.info(QLE_FMT("compiled {}"), 3);
+    // Runtime formats are written as text, the buffer may be reused
+    std::string format("runtime {}");
+    clogger.info(format.c_str(), 4);
+    format.assign("reused {}");
+    clogger.info(format.c_str(), 5);
+  }
+  EXPECT_FALSE(qle::LoggerConfig::binary_active());
+
+  auto records = read_all(qle::BinaryLogFilter());
+  ASSERT_EQ(records.size(), 6U);
+  EXPECT_EQ(records[0].logger, "clog");
+  EXPECT_EQ(records[0].level, LogLevel::INFO);
+  EXPECT_EQ(records[0].message, "value 1 of clog");
+  EXPECT_EQ(records[1].level, LogLevel::WARNING);
+  EXPECT_EQ(records[1].message, "text view");
+  EXPECT_EQ(records[2].logger, "log");
+  EXPECT_EQ(records[2].message, "printf 2");
+  EXPECT_EQ(records[3].message, "compiled 3");
+  EXPECT_EQ(records[4].message, "runtime 4");
+  EXPECT_EQ(records[5].message, "reused 5");
+}
+
+}  // namespace
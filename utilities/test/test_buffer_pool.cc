@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <utilities/buffer_pool.h>
+
+using BufferPool = qle::BufferPool;
+using PooledBuffer = qle::PooledBuffer;
+
+namespace {
+
+class TestBufferPool : public ::testing::Test {};
+
+TEST_F(TestBufferPool, TestSizeClasses) {
+  BufferPool pool(100, 4096);
+
+  auto small = pool.acquire(10);
+  ASSERT_TRUE(small.valid());
+  EXPECT_EQ(small.Size(), 10U);
+  EXPECT_EQ(small.Capacity(), 128U);
+  EXPECT_EQ(small.span().Size(), 10U);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(small.Data()) % qle::cCacheLineSize,
+            0U);
+
+  auto medium = pool.acquire(1000);
+  EXPECT_EQ(medium.Capacity(), 1024U);
+
+  // Bigger than the biggest size class
+  auto large = pool.acquire(10000);
+  ASSERT_TRUE(large.valid());
+  EXPECT_EQ(large.Capacity(), 10000U);
+
+  EXPECT_EQ(pool.allocation_count(), 3U);
+  large.release();
+  EXPECT_EQ(pool.idle_count(), 0U);  // Oversized buffers are not kept
+}
+
+TEST_F(TestBufferPool, TestHugeSizeClasses) {
+  // Size classes stop at the biggest power of 2 instead of wrapping
+  BufferPool pool(64, SIZE_MAX);
+  auto buffer = pool.acquire(100);
+  ASSERT_TRUE(buffer.valid());
+  EXPECT_EQ(buffer.Capacity(), 128U);
+
+  BufferPool top(SIZE_MAX, SIZE_MAX);
+  EXPECT_EQ(top.idle_count(), 0U);
+  BufferPool empty(SIZE_MAX / 2 + 2, SIZE_MAX / 2);
+  EXPECT_EQ(empty.idle_count(), 0U);
+}
+
+TEST_F(TestBufferPool, TestRecycling) {
+  BufferPool pool(256, 64 * 1024);
+
+  uint8_t *first{nullptr};
+  {
+    auto buffer = pool.acquire(1500);
+    first = buffer.Data();
+  }
+  EXPECT_EQ(pool.idle_count(), 1U);
+
+  // Steady state: every frame reuses the same buffer
+  for (size_t i = 0; i < 100; i++) {
+    auto buffer = pool.acquire(1200 + i);
+    ASSERT_EQ(buffer.Data(), first);
+  }
+  EXPECT_EQ(pool.allocation_count(), 1U);
+  EXPECT_EQ(pool.reuse_count(), 100U);
+
+  // Moving a buffer transfers the return-to-pool duty
+  auto buffer = pool.acquire(1500);
+  PooledBuffer moved = std::move(buffer);
+  EXPECT_FALSE(buffer.valid());
+  EXPECT_EQ(pool.idle_count(), 0U);
+  moved.release();
+  EXPECT_EQ(pool.idle_count(), 1U);
+}
+
+TEST_F(TestBufferPool, TestReserve) {
+  BufferPool pool(64, 1024);
+  pool.reserve(512, 4);
+  EXPECT_EQ(pool.idle_count(), 4U);
+  EXPECT_EQ(pool.allocation_count(), 4U);
+
+  std::vector<PooledBuffer> buffers;
+  for (size_t i = 0; i < 4; i++) {
+    buffers.push_back(pool.acquire(500));
+  }
+  EXPECT_EQ(pool.allocation_count(), 4U);
+  EXPECT_EQ(pool.idle_count(), 0U);
+}
+
+TEST_F(TestBufferPool, TestConcurrentUse) {
+  BufferPool pool(64, 4096);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; t++) {
+    threads.emplace_back([&pool, t]() {
+      for (size_t i = 0; i < 1000; i++) {
+        auto buffer = pool.acquire(64 << ((t + i) % 6));
+        ASSERT_TRUE(buffer.valid());
+        buffer.span()[0] = static_cast<uint8_t>(i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(pool.idle_count(), pool.allocation_count());
+  EXPECT_LE(pool.allocation_count(), 4U * 6U);
+}
+
+}  // namespace
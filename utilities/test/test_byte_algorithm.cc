@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include <utilities/byte_algorithm.h>
+
+using ByteAlgorithm = qle::ByteAlgorithm;
+using SimdLevel = qle::SimdLevel;
+using ByteSpan = qle::Span<const uint8_t>;
+
+namespace {
+
+class TestByteAlgorithm : public ::testing::Test {
+ protected:
+  /// All implementations, unsupported ones are clamped to supported ones
+  const std::array<SimdLevel, 3> levels_{SimdLevel::SCALAR, SimdLevel::SSE42,
+                                         SimdLevel::AVX2};
+
+  /**
+   * @brief Build a random buffer over a small alphabet to get many matches
+   *
+   * @param size Buffer size
+   * @param seed Random seed
+   * @return std::vector<uint8_t>
+   */
+  static std::vector<uint8_t> random_buffer(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> buffer(size);
+    for (auto &byte : buffer) {
+      byte = static_cast<uint8_t>(rng() % 4);
+    }
+    return buffer;
+  }
+};
+
+TEST_F(TestByteAlgorithm, TestFindByte) {
+  uint8_t buffer[100]{};
+  buffer[70] = 0x47;
+  buffer[90] = 0x47;
+  for (auto level : levels_) {
+    EXPECT_EQ(ByteAlgorithm::find_byte(ByteSpan(buffer), 0x47, level), 70U);
+    EXPECT_EQ(ByteAlgorithm::find_byte(ByteSpan(buffer), 0x48, level), 100U);
+    EXPECT_EQ(ByteAlgorithm::find_byte(ByteSpan(buffer).first(70), 0x47, level),
+              70U);
+    EXPECT_EQ(ByteAlgorithm::find_byte(ByteSpan(), 0x47, level), 0U);
+  }
+}
+
+TEST_F(TestByteAlgorithm, TestFindPattern) {
+  const uint8_t sync[]{0x1A, 0xCF, 0xFC, 0x1D};
+  std::vector<uint8_t> buffer(200, 0x1A);
+  std::copy(std::begin(sync), std::end(sync), buffer.begin() + 150);
+  ByteSpan span(buffer.data(), buffer.size());
+
+  for (auto level : levels_) {
+    EXPECT_EQ(ByteAlgorithm::find_pattern(span, ByteSpan(sync), level), 150U);
+    // Pattern cut by the end of the span is not found
+    EXPECT_EQ(
+        ByteAlgorithm::find_pattern(span.first(152), ByteSpan(sync), level),
+        152U);
+    EXPECT_EQ(ByteAlgorithm::find_pattern(ByteSpan(sync), ByteSpan(), level),
+              0U);
+    EXPECT_EQ(ByteAlgorithm::find_pattern(ByteSpan(sync).first(2),
+                                          ByteSpan(sync), level),
+              2U);
+  }
+}
+
+TEST_F(TestByteAlgorithm, TestCount) {
+  // More than 255 blocks to exercise accumulator folding
+  std::vector<uint8_t> buffer(20000, 0x0A);
+  buffer[5] = 0x00;
+  for (auto level : levels_) {
+    EXPECT_EQ(ByteAlgorithm::count(ByteSpan(buffer.data(), buffer.size()), 0x0A,
+                                   level),
+              buffer.size() - 1);
+    EXPECT_EQ(ByteAlgorithm::count(ByteSpan(buffer.data(), buffer.size()), 0x00,
+                                   level),
+              1U);
+  }
+}
+
+TEST_F(TestByteAlgorithm, TestMismatchAndEqual) {
+  std::vector<uint8_t> lhs(100, 0x55);
+  std::vector<uint8_t> rhs(lhs);
+  ByteSpan lhs_span(lhs.data(), lhs.size());
+  ByteSpan rhs_span(rhs.data(), rhs.size());
+
+  for (auto level : levels_) {
+    EXPECT_EQ(ByteAlgorithm::mismatch(lhs_span, rhs_span, level), 100U);
+    EXPECT_TRUE(ByteAlgorithm::equal(lhs_span, rhs_span, level));
+    EXPECT_FALSE(ByteAlgorithm::equal(lhs_span, rhs_span.first(99), level));
+    EXPECT_EQ(ByteAlgorithm::mismatch(lhs_span, rhs_span.first(40), level),
+              40U);
+  }
+
+  rhs[77] = 0x00;
+  for (auto level : levels_) {
+    EXPECT_EQ(ByteAlgorithm::mismatch(lhs_span, rhs_span, level), 77U);
+    EXPECT_FALSE(ByteAlgorithm::equal(lhs_span, rhs_span, level));
+  }
+}
+
+TEST_F(TestByteAlgorithm, TestRandomAgainstScalar) {
+  for (uint32_t seed = 0; seed < 200; seed++) {
+    const auto buffer = random_buffer(seed * 3, seed);
+    const auto other = random_buffer(seed * 3, seed + 1);
+    const uint8_t pattern[]{1, 2, 3};
+    ByteSpan span(buffer.data(), buffer.size());
+    ByteSpan other_span(other.data(), other.size());
+
+    for (auto level : levels_) {
+      ASSERT_EQ(ByteAlgorithm::find_byte(span, 3, level),
+                ByteAlgorithm::find_byte(span, 3, SimdLevel::SCALAR));
+      ASSERT_EQ(ByteAlgorithm::find_pattern(span, ByteSpan(pattern), level),
+                ByteAlgorithm::find_pattern(span, ByteSpan(pattern),
+                                            SimdLevel::SCALAR));
+      ASSERT_EQ(ByteAlgorithm::count(span, 2, level),
+                ByteAlgorithm::count(span, 2, SimdLevel::SCALAR));
+      ASSERT_EQ(ByteAlgorithm::mismatch(span, other_span, level),
+                ByteAlgorithm::mismatch(span, other_span, SimdLevel::SCALAR));
+    }
+  }
+}
+
+}  // namespace
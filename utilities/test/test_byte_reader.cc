@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <thread>
+#include <vector>
+
+#include <utilities/byte_reader.h>
+
+namespace {
+
+class TestByteReader : public ::testing::Test {
+ protected:
+  /**
+   * @brief Assert ByteReader::get() matches Bytestream::get() for type T
+   *
+   * @tparam T
+   * @tparam E Endianess
+   */
+  template <typename T, qle::Endianess E = qle::Endianess::BIG_END>
+  void assert_get_types() {
+    uint8_t buffer[]{0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    size_t buffer_len = sizeof(buffer) / sizeof(buffer[0]);
+
+    for (size_t i = 0; i <= buffer_len - sizeof(T); i++) {
+      qle::Bytestream bs(buffer, buffer_len, E);
+      ASSERT_TRUE(bs.move(i));
+      qle::ByteReader<E> reader(buffer + i, buffer_len - i);
+
+      T expected{0};
+      T dest{0};
+      ASSERT_TRUE(bs.get(expected));
+      ASSERT_TRUE(reader.get(dest));
+      EXPECT_EQ(memcmp(&dest, &expected, sizeof(T)), 0);
+      EXPECT_EQ(reader.remaining(), buffer_len - i - sizeof(T));
+    }
+  }
+};
+
+TEST_F(TestByteReader, TestBasic) {
+  static_assert(std::is_trivially_copyable<qle::ByteReader<>>::value, "");
+
+  uint8_t buffer[]{0x00, 0x01, 0x02, 0x03};
+  qle::ByteReader<> reader(buffer, sizeof(buffer));
+  ASSERT_EQ(reader.remaining(), sizeof(buffer));
+  ASSERT_FALSE(reader.empty());
+  ASSERT_TRUE(reader.is_overflow(sizeof(buffer) + 1));
+
+  ASSERT_TRUE(reader.skip(1));
+  ASSERT_EQ(reader.data(), &buffer[1]);
+
+  uint32_t value{0};
+  ASSERT_FALSE(reader.get(value));  // Only 3 bytes left
+  ASSERT_TRUE(reader.get(value, 3));
+  EXPECT_EQ(value, 0x010203U);
+  ASSERT_TRUE(reader.empty());
+  ASSERT_FALSE(reader.skip(1));
+
+  qle::ByteReader<> empty;
+  ASSERT_TRUE(empty.empty());
+
+  qle::ByteReader<> from_span(qle::Span<const uint8_t>(buffer).subspan(2));
+  ASSERT_EQ(from_span.remaining(), 2U);
+  ASSERT_EQ(from_span.span().Data(), &buffer[2]);
+}
+
+TEST_F(TestByteReader, TestGetVariousTypes) {
+  assert_get_types<uint8_t>();
+  assert_get_types<uint16_t>();
+  assert_get_types<uint32_t>();
+  assert_get_types<uint64_t>();
+  assert_get_types<int16_t>();
+  assert_get_types<int64_t>();
+  assert_get_types<float>();
+  assert_get_types<double>();
+
+  assert_get_types<uint8_t, qle::Endianess::LITTLE_END>();
+  assert_get_types<uint16_t, qle::Endianess::LITTLE_END>();
+  assert_get_types<uint32_t, qle::Endianess::LITTLE_END>();
+  assert_get_types<uint64_t, qle::Endianess::LITTLE_END>();
+  assert_get_types<int16_t, qle::Endianess::LITTLE_END>();
+  assert_get_types<int64_t, qle::Endianess::LITTLE_END>();
+  assert_get_types<float, qle::Endianess::LITTLE_END>();
+  assert_get_types<double, qle::Endianess::LITTLE_END>();
+}
+
+TEST_F(TestByteReader, TestForkAndTake) {
+  uint8_t buffer[]{0x02, 0xAA, 0xBB, 0x01, 0xCC};
+  qle::ByteReader<> reader(buffer, sizeof(buffer));
+
+  // Speculative parse on a fork leaves the original untouched
+  auto fork = reader.fork();
+  uint16_t header{0};
+  ASSERT_TRUE(fork.get(header));
+  EXPECT_EQ(header, 0x02AA);
+  EXPECT_EQ(reader.remaining(), sizeof(buffer));
+
+  // Length-prefixed records split into bounded sub-readers
+  std::vector<qle::ByteReader<>> records;
+  uint8_t len{0};
+  while (reader.get(len)) {
+    qle::ByteReader<> record;
+    ASSERT_TRUE(reader.take(record, len));
+    records.push_back(record);
+  }
+  ASSERT_EQ(records.size(), 2U);
+  EXPECT_EQ(records[0].remaining(), 2U);
+  EXPECT_EQ(records[1].remaining(), 1U);
+
+  const uint8_t *bytes{nullptr};
+  ASSERT_TRUE(records[0].get_bytes(bytes, 2));
+  EXPECT_EQ(bytes, &buffer[1]);
+
+  qle::ByteReader<> too_long;
+  qle::ByteReader<> short_reader(buffer, 1);
+  ASSERT_FALSE(short_reader.take(too_long, 2));
+}
+
+TEST_F(TestByteReader, TestConcurrentReaders) {
+  std::array<uint8_t, 4096> buffer;
+  for (size_t i = 0; i < buffer.size(); i++) {
+    buffer[i] = static_cast<uint8_t>(i);
+  }
+  const qle::ByteReader<> shared(buffer.data(), buffer.size());
+
+  std::array<uint64_t, 4> sums{};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < sums.size(); t++) {
+    threads.emplace_back([shared, &sums, t]() {
+      auto reader = shared;  // Each thread owns its cursor
+      uint8_t byte{0};
+      while (reader.get(byte)) {
+        sums[t] += byte;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (auto sum : sums) {
+    EXPECT_EQ(sum, 16U * (255U * 256U / 2U));
+  }
+}
+
+}  // namespace
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <array>
 #include <memory>
+#include <string>
 
 #include <utilities/clog.h>
 #include <utilities/test_fixture.h>
@@ -29,14 +30,17 @@ TEST_F(TestClog, LogVariousLevels) {
         capture_output([&](const char *msg) { logger->trace(msg); }, msg);
     char buff[1024]{};
     snprintf(buff, sizeof(buff), "[%s] %s: %s\n", "trace", cCLoggerName, msg);
-    EXPECT_EQ(out["stdout"], buff);
+    // Levels below QLE_LOG_ACTIVE_LEVEL are compiled out
+    EXPECT_EQ(out["stdout"],
+              qle::LogLevel::is_compiled_in(qle::LogLevel::TRACE) ? buff : "");
   }
   {
     auto out =
         capture_output([&](const char *msg) { logger->debug(msg); }, msg);
     char buff[1024]{};
     snprintf(buff, sizeof(buff), "[%s] %s: %s\n", "debug", cCLoggerName, msg);
-    EXPECT_EQ(out["stdout"], buff);
+    EXPECT_EQ(out["stdout"],
+              qle::LogLevel::is_compiled_in(qle::LogLevel::DEBUG) ? buff : "");
   }
   {
     auto out = capture_output([&](const char *msg) { logger->info(msg); }, msg);
@@ -178,7 +182,9 @@ TEST_F(TestClog, LogComplexFormat) {
     char buff[1024]{};
     snprintf(buff, sizeof(buff), expected_format, "trace", cCLoggerName, msg,
              size_var, int_var, &tmp);
-    EXPECT_EQ(out["stdout"], buff);
+    // Levels below QLE_LOG_ACTIVE_LEVEL are compiled out
+    EXPECT_EQ(out["stdout"],
+              qle::LogLevel::is_compiled_in(qle::LogLevel::TRACE) ? buff : "");
   }
 
   {
@@ -190,7 +196,8 @@ TEST_F(TestClog, LogComplexFormat) {
     char buff[1024]{};
     snprintf(buff, sizeof(buff), expected_format, "debug", cCLoggerName, msg,
              size_var, int_var, &tmp);
-    EXPECT_EQ(out["stdout"], buff);
+    EXPECT_EQ(out["stdout"],
+              qle::LogLevel::is_compiled_in(qle::LogLevel::DEBUG) ? buff : "");
   }
 
   {
@@ -230,4 +237,54 @@ TEST_F(TestClog, LogComplexFormat) {
   }
 }
 
+TEST_F(TestClog, LogReusesLineBuffer) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  auto logger_cfg_handler =
+      std::make_unique<qle::LoggerConfigHandler>(qle::LogLevel::INFO);
+  auto logger = std::make_unique<qle::CLogger>(cCLoggerName);
+
+  // A long line followed by a short one: no leftovers from the first
+  const std::string long_text(2000, 'x');
+  auto out = capture_output([&]() {
+    logger->info("{}", long_text);
+    logger->info("{} {}", std::string("temporary"), 42);
+  });
+  EXPECT_EQ(out["stdout"], "[info] " + std::string(cCLoggerName) + ": " +
+                               long_text + "\n[info] " + cCLoggerName +
+                               ": temporary 42\n");
+}
+
+TEST_F(TestClog, LogCompileTimeFormat) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  auto logger_cfg_handler =
+      std::make_unique<qle::LoggerConfigHandler>(qle::LogLevel::TRACE);
+  auto logger = std::make_unique<qle::CLogger>(cCLoggerName);
+
+  // Same lines as runtime formats
+  auto out = capture_output([&]() {
+    logger->trace(QLE_FMT("{} {:>4}"), "trace", 1);
+    logger->debug(QLE_FMT("{} {:.2f}"), "debug", 2.0);
+    logger->info(QLE_FMT("{} {}"), std::string("info"), 3U);
+    logger->warn(QLE_FMT("warn"));
+    logger->error(QLE_FMT("{} {:#x}"), "error", 255);
+  });
+  std::string expected;
+  if (qle::LogLevel::is_compiled_in(qle::LogLevel::TRACE)) {
+    expected += fmt::format("[trace] {}: trace    1\n", cCLoggerName);
+  }
+  if (qle::LogLevel::is_compiled_in(qle::LogLevel::DEBUG)) {
+    expected += fmt::format("[debug] {}: debug 2.00\n", cCLoggerName);
+  }
+  expected += fmt::format("[info] {}: info 3\n", cCLoggerName);
+  EXPECT_EQ(out["stdout"], expected);
+  EXPECT_EQ(out["stderr"], fmt::format("[warn] {0}: warn\n"
+                                       "[error] {0}: error 0xff\n",
+                                       cCLoggerName));
+
+  // Deferred and binary records get the text of the format
+  EXPECT_STREQ(qle::detail::format_c_str(QLE_FMT("id {}")), "id {}");
+}
+
 }  // namespace
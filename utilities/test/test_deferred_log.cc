@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utilities/clog.h>
+#include <utilities/deferred_log.h>
+#include <utilities/test_fixture.h>
+
+namespace {
+
+static const char *cCLoggerName{"TestDeferred"};
+
+class TestDeferredLog : public qle::TestFixture {
+ protected:
+  void SetUp() override {}
+
+  void TearDown() override { qle::DeferredLog::stop(); }
+
+  /**
+   * @brief Count lines of \p path
+   */
+  static size_t count_lines(const char *path) {
+    std::ifstream file(path);
+    size_t lines{0};
+    for (std::string line; std::getline(file, line);) {
+      lines++;
+    }
+    return lines;
+  }
+
+  std::mutex &mtx_ = qle::TestFixture::mtx_;
+};
+
+TEST_F(TestDeferredLog, Deferrable) {
+  EXPECT_TRUE((qle::detail::AllDeferrable<>::value));
+  EXPECT_TRUE((qle::detail::AllDeferrable<int, double, const char *,
+                                          std::string, char[4]>::value));
+  EXPECT_FALSE((qle::detail::AllDeferrable<int, std::vector<int>>::value));
+  EXPECT_FALSE((qle::detail::CanDefer<const char *, int>::value));
+  const auto format = QLE_FMT("{}");
+  EXPECT_TRUE(
+      (qle::detail::CanDefer<decltype(format), fmt::string_view>::value));
+}
+
+TEST_F(TestDeferredLog, LogFormatsLater) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  // INFO keeps debug lines of the formatter thread out of the output
+  auto logger_cfg_handler =
+      std::make_unique<qle::LoggerConfigHandler>(qle::LogLevel::INFO);
+  auto logger = std::make_unique<qle::CLogger>(cCLoggerName);
+  ASSERT_TRUE(qle::DeferredLog::start());
+  EXPECT_FALSE(qle::DeferredLog::start());
+  EXPECT_TRUE(qle::DeferredLog::active());
+
+  auto out = capture_output([&]() {
+    {
+      // Strings are copied, so they may die before formatting
+      std::string text("copied text");
+      char buffer[16]{"char buffer"};
+      std::string viewed("viewed");
+      logger->info(QLE_FMT("{} {} {:.2f} {} {}"), text, buffer, 1.5, -42,
+                   fmt::string_view(viewed));
+      text.assign("overwritten");
+      buffer[0] = 'X';
+      viewed.assign("VIEWED");
+    }
+    const char *null_str{nullptr};
+    logger->error(QLE_FMT("null is {}"), null_str);
+    qle::DeferredLog::flush();
+  });
+
+  EXPECT_EQ(out["stdout"],
+            fmt::format("[info] {}: copied text char buffer 1.50 -42 viewed\n",
+                        cCLoggerName));
+  EXPECT_EQ(out["stderr"],
+            fmt::format("[error] {}: null is (null)\n", cCLoggerName));
+}
+
+TEST_F(TestDeferredLog, RuntimeFormatNotDeferred) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  auto logger_cfg_handler =
+      std::make_unique<qle::LoggerConfigHandler>(qle::LogLevel::INFO);
+  auto logger = std::make_unique<qle::CLogger>(cCLoggerName);
+  ASSERT_TRUE(qle::DeferredLog::start());
+
+  // The format buffer changes before the formatter thread could read it
+  auto out = capture_output([&]() {
+    std::string format("value {}");
+    logger->info(format.c_str(), 1);
+    format.assign("XXXXX {}");
+    qle::DeferredLog::flush();
+  });
+  EXPECT_EQ(out["stdout"], fmt::format("[info] {}: value 1\n", cCLoggerName));
+}
+
+TEST_F(TestDeferredLog, MultipleThreads) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  static constexpr int cThreads{4};
+  static constexpr int cLines{1000};
+
+  const char *tmpfile = "/tmp/test_deferred_log.txt";
+  remove(tmpfile);
+  {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO, tmpfile);
+    auto logger = std::make_unique<qle::CLogger>(cCLoggerName);
+    ASSERT_TRUE(qle::DeferredLog::start(4096));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < cThreads; t++) {
+      threads.emplace_back([&logger, t] {
+        for (int i = 0; i < cLines; i++) {
+          logger->info(QLE_FMT("thread {} line {}"), t, i);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    // Destroying the config writes what is still pending
+  }
+  EXPECT_EQ(qle::DeferredLog::dropped_count(), 0U);
+  EXPECT_EQ(count_lines(tmpfile), static_cast<size_t>(cThreads * cLines));
+}
+
+TEST_F(TestDeferredLog, StopWhileLogging) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  static constexpr int cThreads{4};
+  static constexpr int cLines{2000};
+
+  const char *tmpfile = "/tmp/test_deferred_log_stop.txt";
+  remove(tmpfile);
+  const uint64_t dropped_before = qle::DeferredLog::dropped_count();
+  {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO, tmpfile);
+    auto logger = std::make_unique<qle::CLogger>(cCLoggerName);
+    ASSERT_TRUE(qle::DeferredLog::start(4096));
+
+    // Every line is either deferred and drained by stop() or, once stopped,
+    // formatted by the calling thread
+    std::atomic<int> ready{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < cThreads; t++) {
+      threads.emplace_back([&logger, &ready, t] {
+        ready++;
+        for (int i = 0; i < cLines; i++) {
+          logger->info(QLE_FMT("thread {} line {}"), t, i);
+        }
+      });
+    }
+    while (ready.load() < cThreads) {
+      std::this_thread::yield();
+    }
+    qle::DeferredLog::stop();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+  EXPECT_EQ(qle::DeferredLog::dropped_count(), dropped_before);
+  EXPECT_EQ(count_lines(tmpfile), static_cast<size_t>(cThreads * cLines));
+}
+
+TEST_F(TestDeferredLog, InvalidFormatRecord) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  auto logger_cfg_handler =
+      std::make_unique<qle::LoggerConfigHandler>(qle::LogLevel::INFO);
+  ASSERT_TRUE(qle::DeferredLog::start());
+
+  // The formatter thread survives a record it cannot format
+  auto out = capture_output([&]() {
+    EXPECT_TRUE(qle::DeferredLog::log(qle::LogLevel::INFO, cCLoggerName,
+                                      "bad {:d", 1));
+    EXPECT_TRUE(qle::DeferredLog::log(qle::LogLevel::INFO, cCLoggerName,
+                                      "good {}", 2));
+    qle::DeferredLog::flush();
+  });
+  EXPECT_EQ(out["stdout"],
+            fmt::format("bad {{:d\n[info] {}: good 2\n", cCLoggerName));
+}
+
+TEST_F(TestDeferredLog, DropNewest) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  static constexpr int cLines{2000};
+
+  const char *tmpfile = "/tmp/test_deferred_log_drop.txt";
+  remove(tmpfile);
+  const uint64_t dropped_before = qle::DeferredLog::dropped_count();
+  {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO, tmpfile);
+    auto logger = std::make_unique<qle::CLogger>(cCLoggerName);
+    ASSERT_TRUE(
+        qle::DeferredLog::start(256, qle::LogOverflowPolicy::DROP_NEWEST));
+
+    std::thread thread([&logger] {
+      for (int i = 0; i < cLines; i++) {
+        logger->info(QLE_FMT("line {}"), i);
+      }
+    });
+    thread.join();
+  }
+  const uint64_t dropped = qle::DeferredLog::dropped_count() - dropped_before;
+  EXPECT_EQ(count_lines(tmpfile) + dropped, static_cast<size_t>(cLines));
+}
+
+}  // namespace
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utilities/clog.h>
+#include <utilities/flight_recorder.h>
+#include <utilities/log.h>
+#include <utilities/log_macros.h>
+#include <utilities/test_fixture.h>
+
+using FlightRecorder = qle::FlightRecorder;
+
+namespace {
+
+static const char *cLoggerName{"TestFlight"};
+
+class TestFlightRecorder : public qle::TestFixture {
+ protected:
+  void SetUp() override { FlightRecorder::clear(); }
+
+  void TearDown() override {
+    FlightRecorder::stop();
+    FlightRecorder::clear();
+  }
+
+  /**
+   * @brief Dump and return the lines without their "[flight N] <time> "
+   * prefix
+   */
+  static std::vector<std::string> dump(size_t *count = nullptr) {
+    FILE *file = tmpfile();
+    EXPECT_TRUE(file);
+    const size_t dumped = FlightRecorder::dump(file);
+    if (count) {
+      *count = dumped;
+    }
+    rewind(file);
+    std::vector<std::string> lines;
+    char buffer[256]{};
+    while (fgets(buffer, sizeof(buffer), file)) {
+      std::string line(buffer);
+      line.pop_back();
+      EXPECT_EQ(line.compare(0, 8, "[flight "), 0);
+      lines.push_back(line.substr(line.find(' ', 8) + 31));
+    }
+    fclose(file);
+    return lines;
+  }
+
+  std::mutex &mtx_ = qle::TestFixture::mtx_;
+};
+
+TEST_F(TestFlightRecorder, RecordsDisabledLevels) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+  qle::CLogger clogger(cLoggerName);
+  qle::Logger logger(cLoggerName);
+  clogger.trace("not recorded {}", 0);
+  FlightRecorder::start(16, false);
+
+  const std::string long_text(200, 'x');
+  auto out = capture_output([&]() {
+    clogger.trace("value {} {}", 1, "one");
+    logger.debug("printf %d", 2);
+    QLE_LOG_DEBUG(clogger, "macro {:.1f}", 3.14);
+    clogger.debug("{}", long_text);
+    clogger.info("info {}", 4);
+  });
+  EXPECT_EQ(out["stdout"], fmt::format("[info] {}: info 4\n", cLoggerName));
+
+  // Macros below QLE_LOG_ACTIVE_LEVEL are compiled out, so never recorded
+  std::vector<std::string> expected{
+      fmt::format("[trace] {}: value 1 one", cLoggerName),
+      fmt::format("[debug] {}: printf 2", cLoggerName)};
+  if (qle::LogLevel::is_compiled_in(qle::LogLevel::DEBUG)) {
+    expected.push_back(fmt::format("[debug] {}: macro 3.1", cLoggerName));
+  }
+  const std::string truncated =
+      long_text.substr(0, qle::cFlightRecordArgsSize);
+  expected.push_back(fmt::format("[debug] {}: {}", cLoggerName, truncated));
+
+  size_t count{0};
+  const auto lines = dump(&count);
+  EXPECT_EQ(count, expected.size());
+  EXPECT_EQ(lines, expected);
+  EXPECT_TRUE(dump().empty());
+}
+
+TEST_F(TestFlightRecorder, RingKeepsLatest) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+  FlightRecorder::start(4, false);
+  // A new thread gets a ring of the current size
+  std::thread thread([]() {
+    qle::CLogger clogger(cLoggerName);
+    for (int i = 0; i < 10; i++) {
+      clogger.trace("record {}", i);
+    }
+  });
+  thread.join();
+
+  const auto lines = dump();
+  ASSERT_EQ(lines.size(), 4U);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(lines[i], fmt::format("[trace] {}: record {}", cLoggerName,
+                                    i + 6));
+  }
+}
+
+TEST_F(TestFlightRecorder, ReuseRings) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+  FlightRecorder::start(4, false);
+  // More threads than rings over time: exited threads release theirs
+  for (size_t i = 0; i < qle::cMaxFlightRecorderThreads + 10; i++) {
+    std::thread thread([i]() {
+      qle::CLogger clogger(cLoggerName);
+      clogger.trace(QLE_FMT("thread {}"), i);
+    });
+    thread.join();
+    const auto lines = dump();
+    ASSERT_EQ(lines.size(), 1U);
+    EXPECT_EQ(lines[0], fmt::format("[trace] {}: thread {}", cLoggerName, i));
+  }
+}
+
+TEST_F(TestFlightRecorder, RuntimeFormatAsText) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+  qle::CLogger clogger(cLoggerName);
+  FlightRecorder::start(16, false);
+
+  // The format buffer may change before the dump
+  std::string format("runtime {}");
+  clogger.trace(format.c_str(), 1);
+  format.assign("XXXXXXX {}");
+
+  const auto lines = dump();
+  ASSERT_EQ(lines.size(), 1U);
+  EXPECT_EQ(lines[0], fmt::format("[trace] {}: runtime 1", cLoggerName));
+}
+
+TEST_F(TestFlightRecorder, DumpOnError) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+  qle::CLogger clogger(cLoggerName);
+  FlightRecorder::start(16, true);
+
+  auto out = capture_output([&]() {
+    clogger.debug("context {}", 1);
+    clogger.error("failure {}", 2);
+    clogger.error("failure {}", 3);
+  });
+  EXPECT_EQ(out["stderr"], fmt::format("[error] {0}: failure 2\n"
+                                       "[error] {0}: failure 3\n",
+                                       cLoggerName));
+  EXPECT_NE(out["stdout"].find(
+                fmt::format("[debug] {}: context 1\n", cLoggerName)),
+            std::string::npos);
+  EXPECT_EQ(out["stdout"].find("[flight"), out["stdout"].rfind("[flight"));
+}
+
+TEST_F(TestFlightRecorder, FatalSignal) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  EXPECT_DEATH(
+      {
+        qle::CLogger clogger(cLoggerName);
+        qle::Logger logger(cLoggerName);
+        FlightRecorder::start(16, false);
+        ASSERT_TRUE(FlightRecorder::install_signal_handlers());
+        logger.trace("before crash %d", 42);
+        clogger.trace(QLE_FMT("encoded {}"), 43);
+        raise(SIGABRT);
+      },
+      "\\[trace\\] TestFlight: before crash 42\n"
+      "\\[flight\\] 1 records with encoded arguments not decoded");
+}
+
+}  // namespace
@@ -29,14 +29,17 @@ TEST_F(TestLog, LogVariousLevels) {
         capture_output([&](const char *msg) { logger->trace(msg); }, msg);
     char buff[1024]{};
     snprintf(buff, sizeof(buff), "[%s] %s: %s\n", "trace", cLoggerName, msg);
-    EXPECT_EQ(out["stdout"], buff);
+    // Levels below QLE_LOG_ACTIVE_LEVEL are compiled out
+    EXPECT_EQ(out["stdout"],
+              qle::LogLevel::is_compiled_in(qle::LogLevel::TRACE) ? buff : "");
   }
   {
     auto out =
         capture_output([&](const char *msg) { logger->debug(msg); }, msg);
     char buff[1024]{};
     snprintf(buff, sizeof(buff), "[%s] %s: %s\n", "debug", cLoggerName, msg);
-    EXPECT_EQ(out["stdout"], buff);
+    EXPECT_EQ(out["stdout"],
+              qle::LogLevel::is_compiled_in(qle::LogLevel::DEBUG) ? buff : "");
   }
   {
     auto out = capture_output([&](const char *msg) { logger->info(msg); }, msg);
@@ -178,7 +181,9 @@ TEST_F(TestLog, LogComplexFormat) {
     char buff[1024]{};
     snprintf(buff, sizeof(buff), expected_format, "trace", cLoggerName, msg,
              size_var, int_var, &tmp);
-    EXPECT_EQ(out["stdout"], buff);
+    // Levels below QLE_LOG_ACTIVE_LEVEL are compiled out
+    EXPECT_EQ(out["stdout"],
+              qle::LogLevel::is_compiled_in(qle::LogLevel::TRACE) ? buff : "");
   }
 
   {
@@ -190,7 +195,8 @@ TEST_F(TestLog, LogComplexFormat) {
     char buff[1024]{};
     snprintf(buff, sizeof(buff), expected_format, "debug", cLoggerName, msg,
              size_var, int_var, &tmp);
-    EXPECT_EQ(out["stdout"], buff);
+    EXPECT_EQ(out["stdout"],
+              qle::LogLevel::is_compiled_in(qle::LogLevel::DEBUG) ? buff : "");
   }
 
   {
@@ -230,4 +236,62 @@ TEST_F(TestLog, LogComplexFormat) {
   }
 }
 
+TEST_F(TestLog, LogAsync) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  auto logger_cfg_handler =
+      std::make_unique<qle::LoggerConfigHandler>(qle::LogLevel::TRACE);
+  ASSERT_TRUE(logger_cfg_handler->get_config()->start_async());
+  auto logger = std::make_unique<qle::Logger>(cLoggerName);
+  const char *msg{"Sample text"};
+
+  auto out = capture_output(
+      [&](const char *msg) {
+        logger->info(msg);
+        logger->error(msg);
+        logger_cfg_handler->get_config()->flush();
+      },
+      msg);
+
+  char buff_out[1024]{};
+  snprintf(buff_out, sizeof(buff_out), "[%s] %s: %s\n", "info", cLoggerName,
+           msg);
+  EXPECT_EQ(out["stdout"], buff_out);
+  char buff_err[1024]{};
+  snprintf(buff_err, sizeof(buff_err), "[%s] %s: %s\n", "error", cLoggerName,
+           msg);
+  EXPECT_EQ(out["stderr"], buff_err);
+}
+
+TEST_F(TestLog, LogLevelOverride) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  auto logger_cfg_handler =
+      std::make_unique<qle::LoggerConfigHandler>(qle::LogLevel::INFO);
+  auto logger = std::make_unique<qle::Logger>(cLoggerName);
+  auto other = std::make_unique<qle::Logger>("Other");
+  const char *msg{"Sample text"};
+
+  // Turn up one logger at runtime, others keep the global level
+  ASSERT_TRUE(
+      qle::LoggerConfig::set_logger_level(cLoggerName, qle::LogLevel::DEBUG));
+  // Levels below QLE_LOG_ACTIVE_LEVEL are compiled out
+  const bool compiled_in = qle::LogLevel::is_compiled_in(qle::LogLevel::DEBUG);
+  EXPECT_EQ(logger->is_enabled(qle::LogLevel::DEBUG), compiled_in);
+  EXPECT_FALSE(other->is_enabled(qle::LogLevel::DEBUG));
+
+  auto out = capture_output(
+      [&](const char *msg) {
+        logger->debug(msg);
+        other->debug(msg);
+      },
+      msg);
+  char buff[1024]{};
+  snprintf(buff, sizeof(buff), "[%s] %s: %s\n", "debug", cLoggerName, msg);
+  EXPECT_EQ(out["stdout"], compiled_in ? buff : "");
+
+  qle::LoggerConfig::clear_logger_level(cLoggerName);
+  EXPECT_FALSE(logger->is_enabled(qle::LogLevel::DEBUG));
+}
+
 }  // namespace
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <thread>
+
+#include <utilities/log_clock.h>
+
+using LogClock = qle::LogClock;
+
+namespace {
+
+class TestLogClock : public ::testing::Test {
+ protected:
+  /**
+   * @brief Get system_clock time in nanoseconds since epoch
+   */
+  static int64_t system_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+  }
+};
+
+TEST_F(TestLogClock, ToWallTime) {
+  LogClock::calibrate();
+  const int64_t before = system_ns();
+  const uint64_t ticks = LogClock::now();
+  const int64_t after = system_ns();
+  const auto ns = static_cast<int64_t>(LogClock::to_ns(ticks));
+  EXPECT_GT(ns, before - 1000000);
+  EXPECT_LT(ns, after + 1000000);
+
+  // Conversion is lazy: old ticks still convert to their own time
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  LogClock::calibrate();
+  const auto later = static_cast<int64_t>(LogClock::to_ns(LogClock::now()));
+  EXPECT_EQ(static_cast<int64_t>(LogClock::to_ns(ticks)) / 1000000,
+            ns / 1000000);
+  EXPECT_GE(later - ns, 20000000);
+  EXPECT_LT(later - ns, 1000000000);
+}
+
+TEST_F(TestLogClock, Monotonic) {
+  uint64_t last = LogClock::to_ns(LogClock::now());
+  for (int i = 0; i < 1000; i++) {
+    const uint64_t ns = LogClock::to_ns(LogClock::now());
+    EXPECT_GE(ns + 1000, last);
+    last = ns;
+  }
+}
+
+TEST_F(TestLogClock, Format) {
+  char out[qle::cLogTimeLength]{};
+  LogClock::format(1700000000123456789ULL, out);
+  EXPECT_EQ(std::string(out, sizeof(out)), "2023-11-14 22:13:20.123456789");
+  LogClock::format(1700000000000000042ULL, out);
+  EXPECT_EQ(std::string(out, sizeof(out)), "2023-11-14 22:13:20.000000042");
+  LogClock::format(1700000001000000000ULL, out);
+  EXPECT_EQ(std::string(out, sizeof(out)), "2023-11-14 22:13:21.000000000");
+}
+
+TEST_F(TestLogClock, FormatUncached) {
+  // Dates around epoch, leap days and century years match gmtime_r()
+  for (const int64_t second :
+       {0LL, 59LL, 86399LL, 951782400LL, 951868800LL, 1709164800LL,
+        1709251199LL, 4107542400LL, 4102444799LL, 1700000000LL}) {
+    const auto seconds = static_cast<time_t>(second);
+    struct tm utc {};
+    gmtime_r(&seconds, &utc);
+    char expected[32]{};
+    strftime(expected, sizeof(expected), "%Y-%m-%d %H:%M:%S", &utc);
+
+    char out[qle::cLogTimeLength]{};
+    LogClock::format_uncached(second * 1000000000ULL + 7, out);
+    EXPECT_EQ(std::string(out, sizeof(out)),
+              std::string(expected) + ".000000007");
+  }
+}
+
+TEST_F(TestLogClock, ToNsNowait) {
+  LogClock::calibrate();
+  const uint64_t ticks = LogClock::now();
+  uint64_t ns{0};
+  ASSERT_TRUE(LogClock::to_ns_nowait(ticks, ns));
+  EXPECT_EQ(ns / 1000000, LogClock::to_ns(ticks) / 1000000);
+}
+
+}  // namespace
@@ -1,7 +1,17 @@
 #include <gtest/gtest.h>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <utilities/log_config.h>
+#include <utilities/log_sink.h>
 
 namespace {
 
@@ -88,4 +98,402 @@ TEST_F(TestLoggerConfigHandler, Initialization) {
   }
 }
 
+TEST_F(TestLoggerConfigHandler, DestroyWhileWriting) {
+  const char *tmpfile = "/tmp/test_log_config_writers.txt";
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 4; t++) {
+    writers.emplace_back([&stop]() {
+      // Short-lived threads take and release writer slots
+      while (!stop.load()) {
+        std::thread writer([]() {
+          const std::string line(50, 'x');
+          for (int i = 0; i < 100; i++) {
+            qle::LoggerConfig::write(qle::LogLevel::INFO, line.data(),
+                                     line.size());
+          }
+        });
+        writer.join();
+      }
+    });
+  }
+  for (int i = 0; i < 50; i++) {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO, tmpfile);
+    ASSERT_TRUE(handler.get_config());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  stop = true;
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  remove(tmpfile);
+}
+
+class TestLoggerConfigAsync : public ::testing::Test {
+ protected:
+  /**
+   * @brief Log \p count lines asynchronously to a file and count lines
+   * written
+   */
+  static size_t log_to_file(qle::LogOverflowPolicy policy, size_t count,
+                            uint64_t &discarded) {
+    const char *tmpfile = "/tmp/test_log_config_async.txt";
+    remove(tmpfile);
+    {
+      qle::LoggerConfigHandler handler(qle::LogLevel::INFO, tmpfile);
+      auto *config = handler.get_config();
+      EXPECT_TRUE(config->start_async(4, policy));
+      EXPECT_TRUE(config->is_async());
+      EXPECT_FALSE(config->start_async());
+
+      const std::string line(100, 'x');
+      for (size_t i = 0; i < count; i++) {
+        qle::LoggerConfig::write(qle::LogLevel::INFO, line.data(),
+                                 line.size());
+      }
+      discarded = config->dropped_count() + config->overwritten_count();
+    }
+
+    std::ifstream file(tmpfile);
+    size_t lines{0};
+    for (std::string line; std::getline(file, line);) {
+      lines++;
+    }
+    return lines;
+  }
+};
+
+TEST_F(TestLoggerConfigAsync, OverflowPolicies) {
+  static constexpr size_t cCount{2000};
+  uint64_t discarded{0};
+
+  EXPECT_EQ(log_to_file(qle::LogOverflowPolicy::BLOCK, cCount, discarded),
+            cCount);
+  EXPECT_EQ(discarded, 0U);
+
+  // Every line is either written or counted as discarded
+  size_t lines =
+      log_to_file(qle::LogOverflowPolicy::DROP_NEWEST, cCount, discarded);
+  EXPECT_EQ(lines + discarded, cCount);
+
+  lines =
+      log_to_file(qle::LogOverflowPolicy::OVERWRITE_OLDEST, cCount, discarded);
+  EXPECT_EQ(lines + discarded, cCount);
+}
+
+TEST_F(TestLoggerConfigAsync, LongLines) {
+  const char *tmpfile = "/tmp/test_log_config_async.txt";
+  remove(tmpfile);
+  const std::string long_line(qle::cMaxLogLineLength + 100, 'x');
+  {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO, tmpfile);
+    ASSERT_TRUE(handler.get_config()->start_async(4));
+    qle::LoggerConfig::write(qle::LogLevel::INFO, "first", 5);
+    qle::LoggerConfig::write(qle::LogLevel::INFO, long_line.data(),
+                             long_line.size());
+    qle::LoggerConfig::write(qle::LogLevel::INFO, "last", 4);
+  }
+
+  // Written whole and in order
+  std::ifstream file(tmpfile);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(file, line);) {
+    lines.push_back(line);
+  }
+  EXPECT_EQ(lines, (std::vector<std::string>{"first", long_line, "last"}));
+  remove(tmpfile);
+}
+
+TEST_F(TestLoggerConfigAsync, StopAsync) {
+  qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+  auto *config = handler.get_config();
+  ASSERT_TRUE(config->start_async());
+  config->stop_async();
+  EXPECT_FALSE(config->is_async());
+  EXPECT_EQ(config->dropped_count(), 0U);
+  config->stop_async();
+}
+
+class TestLoggerConfigFlush : public ::testing::Test {
+ protected:
+  static constexpr const char *cFile{"/tmp/test_log_config_flush.txt"};
+
+  /**
+   * @brief Write a 99 character line, 100 bytes with the newline
+   */
+  static void write_line(qle::LogLevel::Level level = qle::LogLevel::INFO) {
+    const std::string line(99, 'x');
+    qle::LoggerConfig::write(level, line.data(), line.size());
+  }
+
+  /**
+   * @brief Get number of bytes that reached the file
+   */
+  static size_t file_size() {
+    std::ifstream file(cFile, std::ios::binary | std::ios::ate);
+    return file ? static_cast<size_t>(file.tellg()) : 0;
+  }
+};
+
+constexpr const char *TestLoggerConfigFlush::cFile;
+
+TEST_F(TestLoggerConfigFlush, ByteThreshold) {
+  remove(cFile);
+  {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO, cFile);
+    auto *config = handler.get_config();
+
+    // By default lines stay in the stdio buffer
+    write_line();
+    EXPECT_EQ(file_size(), 0U);
+
+    qle::LogFlushPolicy policy;
+    policy.byte_threshold = 1000;
+    ASSERT_TRUE(config->set_flush_policy(policy));
+    EXPECT_EQ(config->flush_policy().byte_threshold, 1000U);
+    for (int i = 0; i < 8; i++) {
+      write_line();
+    }
+    EXPECT_EQ(file_size(), 0U);
+    write_line();
+    EXPECT_EQ(file_size(), 1000U);
+    write_line();
+    EXPECT_EQ(file_size(), 1000U);
+  }
+
+  // Shutdown flushes the rest
+  EXPECT_EQ(file_size(), 1100U);
+}
+
+TEST_F(TestLoggerConfigFlush, FlushOnWarning) {
+  remove(cFile);
+  qle::LoggerConfigHandler handler(qle::LogLevel::INFO, cFile);
+  qle::LogFlushPolicy policy;
+  policy.flush_on_warning = true;
+  ASSERT_TRUE(handler.get_config()->set_flush_policy(policy));
+
+  write_line();
+  EXPECT_EQ(file_size(), 0U);
+  write_line(qle::LogLevel::WARNING);
+  EXPECT_EQ(file_size(), 200U);
+}
+
+TEST_F(TestLoggerConfigFlush, Interval) {
+  remove(cFile);
+  qle::LoggerConfigHandler handler(qle::LogLevel::INFO, cFile);
+  qle::LogFlushPolicy policy;
+  policy.interval_ms = 5;
+  ASSERT_TRUE(handler.get_config()->set_flush_policy(policy));
+
+  write_line();
+  for (int i = 0; (i < 1000) && (file_size() == 0); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(file_size(), 100U);
+
+  ASSERT_TRUE(handler.get_config()->set_flush_policy(qle::LogFlushPolicy()));
+}
+
+TEST_F(TestLoggerConfigFlush, IntervalSinksAndShards) {
+  const std::string shard = std::string(cFile) + ".0";
+  remove(cFile);
+  remove(shard.c_str());
+  qle::LogFlushPolicy policy;
+  policy.interval_ms = 5;
+  {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+    auto *config = handler.get_config();
+    ASSERT_TRUE(config->add_sink(std::make_unique<qle::FileLogSink>(cFile)));
+    ASSERT_TRUE(config->set_flush_policy(policy));
+
+    write_line();
+    for (int i = 0; (i < 1000) && (file_size() == 0); i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(file_size(), 100U);
+  }
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+  auto *config = handler.get_config();
+  ASSERT_TRUE(config->open_sharded_file(cFile));
+  ASSERT_TRUE(config->set_flush_policy(policy));
+  write_line();
+  std::ifstream file;
+  for (int i = 0; (i < 1000) && !file.is_open(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    file.open(shard, std::ios::binary | std::ios::ate);
+    if (file.is_open() && (file.tellg() <= 0)) {
+      file.close();
+    }
+  }
+  EXPECT_TRUE(file.is_open());
+  remove(shard.c_str());
+}
+
+TEST_F(TestLoggerConfigFlush, MappedFile) {
+  const std::string segment = std::string(cFile) + ".0";
+  remove(segment.c_str());
+  {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+    auto *config = handler.get_config();
+    qle::MappedLogFileOptions options;
+    options.segment_size = 4096;
+    ASSERT_TRUE(config->open_mapped_file(cFile, options));
+    EXPECT_FALSE(config->open_mapped_file(cFile, options));
+    ASSERT_TRUE(config->mapped_file());
+
+    write_line();
+    write_line(qle::LogLevel::ERROR);
+    config->flush();
+  }
+
+  std::ifstream file(segment, std::ios::binary | std::ios::ate);
+  EXPECT_EQ(static_cast<size_t>(file.tellg()), 200U);
+  remove(segment.c_str());
+  remove((std::string(cFile) + ".1").c_str());
+}
+
+TEST_F(TestLoggerConfigFlush, ShardedFile) {
+  const std::string shard = std::string(cFile) + ".0";
+  remove(shard.c_str());
+  {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+    auto *config = handler.get_config();
+    ASSERT_TRUE(config->open_sharded_file(cFile));
+    EXPECT_FALSE(config->open_sharded_file(cFile));
+    ASSERT_TRUE(config->sharded_file());
+
+    write_line();
+    write_line(qle::LogLevel::ERROR);
+    config->flush();
+    EXPECT_EQ(config->sharded_file()->shard_count(), 1U);
+  }
+
+  qle::LogShardMerger merger;
+  ASSERT_EQ(merger.open(cFile), 1U);
+  uint64_t timestamp{0};
+  std::string line;
+  size_t count{0};
+  while (merger.next(timestamp, line)) {
+    EXPECT_EQ(line, std::string(99, 'x'));
+    count++;
+  }
+  EXPECT_EQ(count, 2U);
+  remove(shard.c_str());
+}
+
+class TestLoggerConfigTimestamps : public ::testing::Test {
+ protected:
+  static constexpr const char *cFile{"/tmp/test_log_config_time.txt"};
+
+  void SetUp() override { remove(cFile); }
+
+  void TearDown() override { remove(cFile); }
+
+  /**
+   * @brief Read the lines of the log file
+   */
+  static std::vector<std::string> read_lines() {
+    std::ifstream file(cFile);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+      lines.push_back(line);
+    }
+    return lines;
+  }
+};
+
+constexpr const char *TestLoggerConfigTimestamps::cFile;
+
+TEST_F(TestLoggerConfigTimestamps, Prefix) {
+  const auto now = std::chrono::system_clock::to_time_t(
+      std::chrono::system_clock::now());
+  char date[16]{};
+  struct tm utc {};
+  gmtime_r(&now, &utc);
+  strftime(date, sizeof(date), "%Y-%m-%d", &utc);
+  {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO, cFile);
+    auto *config = handler.get_config();
+    EXPECT_FALSE(qle::LoggerConfig::timestamps());
+    qle::LoggerConfig::write(qle::LogLevel::INFO, "plain", 5);
+    config->set_timestamps(true);
+    EXPECT_TRUE(qle::LoggerConfig::timestamps());
+    qle::LoggerConfig::write(qle::LogLevel::INFO, "sync", 4);
+    ASSERT_TRUE(config->start_async());
+    qle::LoggerConfig::write(qle::LogLevel::INFO, "async", 5);
+    config->stop_async();
+  }
+  EXPECT_FALSE(qle::LoggerConfig::timestamps());
+
+  const auto lines = read_lines();
+  ASSERT_EQ(lines.size(), 3U);
+  EXPECT_EQ(lines[0], "plain");
+  for (size_t i = 1; i < lines.size(); i++) {
+    ASSERT_EQ(lines[i].size(), qle::cLogTimeLength + 1 + (i == 1 ? 4 : 5));
+    EXPECT_EQ(lines[i][qle::cLogTimeLength], ' ');
+    EXPECT_EQ(lines[i].compare(10, 1, " "), 0);
+    EXPECT_EQ(lines[i].compare(19, 1, "."), 0);
+  }
+  // Allow for a date change while the test runs
+  EXPECT_LE(lines[1].substr(0, 10), lines[2].substr(0, 10));
+  EXPECT_GE(lines[1].substr(0, 10), std::string(date));
+  EXPECT_LE(lines[1].substr(0, 29), lines[2].substr(0, 29));
+  EXPECT_EQ(lines[2].substr(30), "async");
+}
+
+class TestLoggerConfigLevels : public ::testing::Test {};
+
+TEST_F(TestLoggerConfigLevels, RuntimeLevel) {
+  qle::LogThreshold threshold("component");
+  EXPECT_EQ(threshold.level(), qle::LogLevel::DISABLED);
+  EXPECT_FALSE(qle::LoggerConfig::set_loglevel(qle::LogLevel::DEBUG));
+
+  {
+    qle::LoggerConfigHandler handler(qle::LogLevel::INFO);
+    EXPECT_EQ(threshold.level(), qle::LogLevel::INFO);
+
+    EXPECT_FALSE(qle::LoggerConfig::set_loglevel(qle::LogLevel::Level(-1)));
+    EXPECT_TRUE(qle::LoggerConfig::set_loglevel(qle::LogLevel::DEBUG));
+    EXPECT_EQ(qle::LoggerConfig::loglevel(), qle::LogLevel::DEBUG);
+    EXPECT_EQ(threshold.level(), qle::LogLevel::DEBUG);
+    // Levels below QLE_LOG_ACTIVE_LEVEL are compiled out
+    EXPECT_EQ(threshold.is_enabled(qle::LogLevel::DEBUG),
+              qle::LogLevel::is_compiled_in(qle::LogLevel::DEBUG));
+    EXPECT_FALSE(threshold.is_enabled(qle::LogLevel::TRACE));
+  }
+
+  EXPECT_EQ(threshold.level(), qle::LogLevel::DISABLED);
+}
+
+TEST_F(TestLoggerConfigLevels, LoggerOverride) {
+  EXPECT_FALSE(
+      qle::LoggerConfig::set_logger_level("component", qle::LogLevel::DEBUG));
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::WARNING);
+  qle::LogThreshold component("component");
+  qle::LogThreshold other("other");
+
+  EXPECT_FALSE(
+      qle::LoggerConfig::set_logger_level(nullptr, qle::LogLevel::DEBUG));
+  EXPECT_TRUE(
+      qle::LoggerConfig::set_logger_level("component", qle::LogLevel::DEBUG));
+  EXPECT_EQ(component.level(), qle::LogLevel::DEBUG);
+  EXPECT_EQ(other.level(), qle::LogLevel::WARNING);
+
+  // Thresholds created later resolve the override too
+  {
+    qle::LogThreshold late("component");
+    EXPECT_EQ(late.level(), qle::LogLevel::DEBUG);
+  }
+
+  // Global changes do not affect overridden loggers
+  EXPECT_TRUE(qle::LoggerConfig::set_loglevel(qle::LogLevel::ERROR));
+  EXPECT_EQ(component.level(), qle::LogLevel::DEBUG);
+  EXPECT_EQ(other.level(), qle::LogLevel::ERROR);
+
+  qle::LoggerConfig::clear_logger_level("component");
+  EXPECT_EQ(component.level(), qle::LogLevel::ERROR);
+}
+
 }  // namespace
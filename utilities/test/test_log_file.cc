@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utilities/log_file.h>
+
+using MappedLogFile = qle::MappedLogFile;
+using MappedLogFileOptions = qle::MappedLogFileOptions;
+
+namespace {
+
+class TestMappedLogFile : public ::testing::Test {
+ protected:
+  static constexpr const char *cPath{"/tmp/test_log_file"};
+
+  void SetUp() override { remove_segments(); }
+
+  void TearDown() override { remove_segments(); }
+
+  static void remove_segments() {
+    for (int i = 0; i < 100; i++) {
+      remove((std::string(cPath) + "." + std::to_string(i)).c_str());
+    }
+  }
+
+  /**
+   * @brief Read back the lines of segments [0, count)
+   */
+  static std::vector<std::string> read_lines(size_t count,
+                                             std::vector<size_t> &sizes) {
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < count; i++) {
+      std::ifstream file(std::string(cPath) + "." + std::to_string(i),
+                         std::ios::binary);
+      std::string content((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+      sizes.push_back(content.size());
+      size_t start{0};
+      for (size_t end; (end = content.find('\n', start)) != std::string::npos;
+           start = end + 1) {
+        lines.push_back(content.substr(start, end - start));
+      }
+      EXPECT_EQ(start, content.size());
+    }
+    return lines;
+  }
+};
+
+constexpr const char *TestMappedLogFile::cPath;
+
+TEST_F(TestMappedLogFile, RotateBySize) {
+  MappedLogFileOptions options;
+  options.segment_size = 1024;
+  {
+    MappedLogFile file(cPath, options);
+    ASSERT_TRUE(file.open());
+    EXPECT_FALSE(file.open());
+    EXPECT_EQ(file.sequence(), 0U);
+
+    const std::string line(99, 'x');
+    for (int i = 0; i < 25; i++) {
+      EXPECT_TRUE(file.append(line.data(), line.size()));
+    }
+    EXPECT_EQ(file.sequence(), 2U);
+
+    // Lines longer than a segment are dropped
+    const std::string long_line(2000, 'x');
+    EXPECT_FALSE(file.append(long_line.data(), long_line.size()));
+    EXPECT_EQ(file.dropped_count(), 1U);
+    file.sync();
+  }
+
+  // Segments are truncated to their lines, and the one prepared ahead of
+  // time is removed
+  std::vector<size_t> sizes;
+  auto lines = read_lines(3, sizes);
+  EXPECT_EQ(lines.size(), 25U);
+  EXPECT_EQ(sizes, (std::vector<size_t>{1000, 1000, 500}));
+  std::ifstream unused(std::string(cPath) + ".3");
+  EXPECT_FALSE(unused.good());
+
+  // A new file continues after the existing segments
+  MappedLogFile file(cPath, options);
+  ASSERT_TRUE(file.open());
+  EXPECT_EQ(file.sequence(), 3U);
+}
+
+TEST_F(TestMappedLogFile, RotateByTime) {
+  MappedLogFileOptions options;
+  options.segment_size = 4096;
+  options.rotate_interval_ms = 5;
+  MappedLogFile file(cPath, options);
+  ASSERT_TRUE(file.open());
+
+  // Empty segments are not rotated
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(file.sequence(), 0U);
+
+  EXPECT_TRUE(file.append("line", 4));
+  for (int i = 0; (i < 1000) && (file.sequence() == 0); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(file.sequence(), 1U);
+}
+
+TEST_F(TestMappedLogFile, ConcurrentAppend) {
+  static constexpr size_t cThreads{4};
+  static constexpr size_t cLines{2000};
+  MappedLogFileOptions options;
+  options.segment_size = 64 * 1024;
+  uint64_t dropped{0};
+  uint64_t sequence{0};
+  {
+    MappedLogFile file(cPath, options);
+    ASSERT_TRUE(file.open());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < cThreads; t++) {
+      threads.emplace_back([&file, t]() {
+        for (size_t i = 0; i < cLines; i++) {
+          const std::string line =
+              "thread " + std::to_string(t) + " line " + std::to_string(i);
+          file.append(line.data(), line.size());
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    dropped = file.dropped_count();
+    sequence = file.sequence();
+  }
+
+  // Every line is written whole or counted as dropped
+  std::vector<size_t> sizes;
+  auto lines = read_lines(sequence + 1, sizes);
+  EXPECT_EQ(lines.size() + dropped, cThreads * cLines);
+  for (const auto &line : lines) {
+    EXPECT_EQ(line.compare(0, 7, "thread "), 0) << line;
+  }
+}
+
+}  // namespace
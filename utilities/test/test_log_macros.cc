@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include <utilities/log_macros.h>
+#include <utilities/test_fixture.h>
+
+namespace {
+
+static const char *cLoggerName{"TestMacros"};
+
+class TestLogMacros : public qle::TestFixture {
+ protected:
+  void SetUp() override {}
+
+  std::mutex &mtx_ = qle::TestFixture::mtx_;
+};
+
+TEST_F(TestLogMacros, CompiledInLevels) {
+  EXPECT_EQ(qle::LogLevel::is_compiled_in(qle::LogLevel::TRACE),
+            QLE_LOG_ACTIVE_LEVEL <= 0);
+  EXPECT_TRUE(qle::LogLevel::is_compiled_in(qle::LogLevel::DISABLED));
+  static_assert(qle::LogLevel::is_compiled_in(qle::LogLevel::DISABLED),
+                "Usable in constant expressions");
+}
+
+TEST_F(TestLogMacros, LogThroughMacros) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  auto logger_cfg_handler =
+      std::make_unique<qle::LoggerConfigHandler>(qle::LogLevel::INFO);
+  qle::Logger logger(cLoggerName);
+  qle::CLogger clogger(cLoggerName);
+
+  auto out = capture_output([&]() {
+    QLE_LOG_INFO(logger, "value %d", 1);
+    QLE_LOG_WARN(clogger, "value {}", 2);
+  });
+  EXPECT_EQ(out["stdout"], fmt::format("[info] {}: value 1\n", cLoggerName));
+  EXPECT_EQ(out["stderr"], fmt::format("[warn] {}: value 2\n", cLoggerName));
+}
+
+TEST_F(TestLogMacros, DisabledArgumentsNotEvaluated) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  auto logger_cfg_handler =
+      std::make_unique<qle::LoggerConfigHandler>(qle::LogLevel::INFO);
+  qle::Logger logger(cLoggerName);
+  qle::CLogger clogger(cLoggerName);
+  int evaluated{0};
+  auto expensive = [&evaluated]() {
+    evaluated++;
+    return std::string("expensive");
+  };
+
+  auto out = capture_output([&]() {
+    QLE_LOG_TRACE(logger, "%s", expensive().c_str());
+    QLE_LOG_DEBUG(clogger, "{}", expensive());
+    if (true) QLE_LOG_DEBUG(logger, "%s", expensive().c_str());
+  });
+  EXPECT_EQ(evaluated, 0);
+  EXPECT_EQ(out["stdout"], "");
+
+  out = capture_output([&]() { QLE_LOG_ERROR(clogger, "{}", expensive()); });
+  EXPECT_EQ(evaluated, 1);
+  EXPECT_EQ(out["stderr"], fmt::format("[error] {}: expensive\n", cLoggerName));
+}
+
+TEST_F(TestLogMacros, RateLimited) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  auto logger_cfg_handler =
+      std::make_unique<qle::LoggerConfigHandler>(qle::LogLevel::INFO);
+  qle::Logger logger(cLoggerName);
+  qle::CLogger clogger(cLoggerName);
+  int evaluated{0};
+
+  auto out = capture_output([&]() {
+    for (int i = 0; i < 10; i++) {
+      QLE_LOG_EVERY_N(logger, INFO, 4, "every %d", i);
+      QLE_LOG_FIRST_N(clogger, WARN, 2, "first {}", i);
+      QLE_LOG_PER_SECOND(clogger, ERROR, 1, "rate {}", i);
+      QLE_LOG_FIRST_N(logger, DEBUG, 10, "%d", ++evaluated);
+    }
+  });
+  EXPECT_EQ(evaluated, 0);
+  EXPECT_EQ(out["stdout"], fmt::format("[info] {0}: every 0\n"
+                                       "[info] {0}: every 4\n"
+                                       "[info] {0}: every 8\n",
+                                       cLoggerName));
+  EXPECT_EQ(out["stderr"], fmt::format("[warn] {0}: first 0\n"
+                                       "[error] {0}: rate 0\n"
+                                       "[warn] {0}: first 1\n",
+                                       cLoggerName));
+}
+
+}  // namespace
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utilities/log_queue.h>
+
+using LogQueue = qle::LogQueue;
+using LogRecord = qle::LogRecord;
+using LogLevel = qle::LogLevel;
+
+namespace {
+
+class TestLogQueue : public ::testing::Test {
+ protected:
+  static std::string pop_text(LogQueue &queue) {
+    std::string text;
+    queue.pop([&text](const LogRecord &record) {
+      text.assign(record.text, record.length);
+    });
+    return text;
+  }
+};
+
+TEST_F(TestLogQueue, TestPushPop) {
+  LogQueue queue(3);
+  ASSERT_TRUE(queue.valid());
+  EXPECT_EQ(queue.capacity(), 4U);
+  EXPECT_FALSE(queue.pop([](const LogRecord &) {}));
+
+  for (int i = 0; i < 4; i++) {
+    const std::string line = "line " + std::to_string(i);
+    EXPECT_TRUE(queue.push(LogLevel::INFO, line.data(), line.size()));
+  }
+  EXPECT_FALSE(queue.push(LogLevel::INFO, "full", 4));
+  EXPECT_EQ(queue.pushed_count(), 4U);
+
+  LogLevel::Level level{LogLevel::DISABLED};
+  EXPECT_TRUE(queue.pop([&level](const LogRecord &record) {
+    level = record.level;
+    EXPECT_EQ(std::string(record.text, record.length), "line 0");
+  }));
+  EXPECT_EQ(level, LogLevel::INFO);
+  EXPECT_EQ(queue.popped_count(), 1U);
+
+  // A slot is free again
+  EXPECT_TRUE(queue.push(LogLevel::ERROR, "line 4", 6));
+  for (int i = 1; i <= 4; i++) {
+    EXPECT_EQ(pop_text(queue), "line " + std::to_string(i));
+  }
+  EXPECT_FALSE(queue.pop([](const LogRecord &) {}));
+}
+
+TEST_F(TestLogQueue, TestTruncation) {
+  LogQueue queue(2);
+  const std::string line(qle::cMaxLogLineLength + 100, 'x');
+  ASSERT_TRUE(queue.push(LogLevel::INFO, line.data(), line.size()));
+  EXPECT_EQ(pop_text(queue).size(), qle::cMaxLogLineLength);
+}
+
+TEST_F(TestLogQueue, TestMultipleProducers) {
+  static constexpr int cProducers{4};
+  static constexpr int cLines{5000};
+  LogQueue queue(64);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < cProducers; p++) {
+    producers.emplace_back([&queue, p] {
+      for (int i = 0; i < cLines; i++) {
+        const std::string line = std::to_string(p) + ":" + std::to_string(i);
+        while (!queue.push(LogLevel::INFO, line.data(), line.size())) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // Lines of each producer come out in order
+  std::vector<int> next(cProducers, 0);
+  int received{0};
+  bool ordered{true};
+  while (received < cProducers * cLines) {
+    const bool popped = queue.pop([&](const LogRecord &record) {
+      const std::string line(record.text, record.length);
+      const auto colon = line.find(':');
+      const int p = std::stoi(line.substr(0, colon));
+      const int i = std::stoi(line.substr(colon + 1));
+      ordered = ordered && (next[p] == i);
+      next[p] = i + 1;
+    });
+    if (popped) {
+      received++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(queue.popped_count(), static_cast<uint64_t>(cProducers * cLines));
+}
+
+}  // namespace
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <utilities/log_rate_limit.h>
+
+using LogRateLimit = qle::LogRateLimit;
+
+namespace {
+
+class TestLogRateLimit : public ::testing::Test {
+ protected:
+  /**
+   * @brief Count lines let through by \p limit out of \p lines
+   */
+  static size_t count_allowed(LogRateLimit &limit, size_t lines) {
+    size_t allowed{0};
+    for (size_t i = 0; i < lines; i++) {
+      allowed += limit.allow() ? 1 : 0;
+    }
+    return allowed;
+  }
+};
+
+TEST_F(TestLogRateLimit, EveryN) {
+  LogRateLimit limit(LogRateLimit::EVERY_N, 10);
+  EXPECT_TRUE(limit.allow());
+  EXPECT_EQ(count_allowed(limit, 99), 9U);
+  EXPECT_EQ(limit.suppressed_count(), 90U);
+
+  LogRateLimit every_line(LogRateLimit::EVERY_N, 0);
+  EXPECT_EQ(count_allowed(every_line, 10), 10U);
+}
+
+TEST_F(TestLogRateLimit, FirstN) {
+  LogRateLimit limit(LogRateLimit::FIRST_N, 5);
+  EXPECT_EQ(count_allowed(limit, 100), 5U);
+  EXPECT_EQ(limit.suppressed_count(), 95U);
+
+  // Concurrent call sites let exactly n lines through
+  LogRateLimit shared(LogRateLimit::FIRST_N, 1000);
+  std::vector<std::thread> threads;
+  std::atomic<size_t> allowed{0};
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back(
+        [&shared, &allowed]() { allowed += count_allowed(shared, 1000); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(allowed.load(), 1000U);
+}
+
+TEST_F(TestLogRateLimit, TokenBucket) {
+  // 10 lines per 100 ms: a burst of 10, then about one line per 10 ms
+  LogRateLimit limit(LogRateLimit::TOKEN_BUCKET, 10, 100000000ULL);
+  EXPECT_EQ(count_allowed(limit, 100), 10U);
+  std::this_thread::sleep_for(std::chrono::milliseconds(35));
+  const size_t refilled = count_allowed(limit, 100);
+  EXPECT_GE(refilled, 3U);
+  EXPECT_LE(refilled, 10U);
+}
+
+TEST_F(TestLogRateLimit, Summary) {
+  LogRateLimit limit(LogRateLimit::FIRST_N, 1, 0, 20000000ULL);
+  EXPECT_TRUE(limit.allow());
+  EXPECT_FALSE(limit.allow());
+  // The first suppressed line starts the summary interval
+  EXPECT_EQ(limit.summary(), 0U);
+  EXPECT_EQ(count_allowed(limit, 9), 0U);
+  EXPECT_EQ(limit.summary(), 0U);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  EXPECT_EQ(limit.summary(), 10U);
+  EXPECT_EQ(limit.summary(), 0U);
+  EXPECT_EQ(limit.suppressed_count(), 0U);
+}
+
+TEST_F(TestLogRateLimit, PollSummary) {
+  static constexpr uint64_t cCheck{qle::cLogRateSummaryCheckInterval};
+  LogRateLimit limit(LogRateLimit::FIRST_N, 1, 0, 20000000ULL);
+  EXPECT_TRUE(limit.allow());
+  EXPECT_EQ(limit.poll_summary(true), 0U);
+  // The first suppressed line reads the clock and starts the interval
+  EXPECT_FALSE(limit.allow());
+  EXPECT_EQ(limit.poll_summary(false), 0U);
+
+  // Past the interval, only every cCheck-th suppressed line reads the clock
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  for (uint64_t i = 1; i < cCheck; i++) {
+    EXPECT_FALSE(limit.allow());
+    EXPECT_EQ(limit.poll_summary(false), 0U);
+  }
+  EXPECT_FALSE(limit.allow());
+  EXPECT_EQ(limit.poll_summary(false), cCheck + 1);
+  EXPECT_EQ(limit.suppressed_count(), 0U);
+}
+
+TEST_F(TestLogRateLimit, SummaryOnAllowedLine) {
+  LogRateLimit limit(LogRateLimit::EVERY_N, 2, 0, 20000000ULL);
+  EXPECT_TRUE(limit.allow());
+  EXPECT_FALSE(limit.allow());
+  EXPECT_EQ(limit.poll_summary(false), 0U);
+
+  // The site is not suppressing any more, its next line reports
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  EXPECT_TRUE(limit.allow());
+  EXPECT_EQ(limit.poll_summary(true), 1U);
+  EXPECT_EQ(limit.poll_summary(true), 0U);
+}
+
+}  // namespace
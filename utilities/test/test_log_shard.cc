@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utilities/log_clock.h>
+#include <utilities/log_shard.h>
+
+using LogShardMerger = qle::LogShardMerger;
+using ShardedLogFile = qle::ShardedLogFile;
+
+namespace {
+
+class TestShardedLogFile : public ::testing::Test {
+ protected:
+  static constexpr const char *cPath{"/tmp/test_log_shard"};
+
+  void SetUp() override { remove_shards(); }
+
+  void TearDown() override { remove_shards(); }
+
+  static void remove_shards() {
+    for (int i = 0; i < 16; i++) {
+      remove((std::string(cPath) + "." + std::to_string(i)).c_str());
+    }
+  }
+
+  /**
+   * @brief Line \p index of thread \p thread
+   */
+  static std::string fmt_line(size_t thread, size_t index) {
+    return std::to_string(thread) + ":" + std::to_string(index);
+  }
+};
+
+constexpr const char *TestShardedLogFile::cPath;
+
+TEST_F(TestShardedLogFile, ShardPerThread) {
+  static constexpr size_t cThreads{4};
+  static constexpr size_t cLines{1000};
+  {
+    ShardedLogFile file(cPath);
+    EXPECT_EQ(file.shard_path(2), std::string(cPath) + ".2");
+    std::vector<std::thread> threads;
+    std::atomic<size_t> started{0};
+    for (size_t t = 0; t < cThreads; t++) {
+      threads.emplace_back([&file, &started, t]() {
+        for (size_t i = 0; i < cLines; i++) {
+          const std::string line = fmt_line(t, i);
+          EXPECT_TRUE(file.append(line.data(), line.size()));
+          // All threads hold a shard at once, so none is reused
+          if (i == 0) {
+            started.fetch_add(1);
+            while (started.load() < cThreads) {
+              std::this_thread::yield();
+            }
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(file.shard_count(), cThreads);
+  }
+
+  LogShardMerger merger;
+  ASSERT_EQ(merger.open(cPath), cThreads);
+  std::vector<size_t> next(cThreads, 0);
+  uint64_t last{0};
+  uint64_t timestamp{0};
+  std::string line;
+  size_t count{0};
+  while (merger.next(timestamp, line)) {
+    EXPECT_GE(timestamp, last);
+    last = timestamp;
+    // Lines of each thread come out in the order they were written
+    const size_t t = std::stoul(line.substr(0, line.find(':')));
+    ASSERT_LT(t, cThreads);
+    EXPECT_EQ(line, fmt_line(t, next[t]++));
+    count++;
+  }
+  EXPECT_EQ(count, cThreads * cLines);
+}
+
+TEST_F(TestShardedLogFile, ReuseShards) {
+  static constexpr size_t cThreads{10};
+  {
+    ShardedLogFile file(cPath);
+    // Each thread exits before the next starts and takes its shard
+    for (size_t t = 0; t < cThreads; t++) {
+      std::thread thread([&file, t]() {
+        for (size_t i = 0; i < 10; i++) {
+          const std::string line = fmt_line(t, i);
+          EXPECT_TRUE(file.append(line.data(), line.size()));
+        }
+      });
+      thread.join();
+    }
+    EXPECT_EQ(file.shard_count(), 1U);
+  }
+
+  LogShardMerger merger;
+  ASSERT_EQ(merger.open(cPath), 1U);
+  uint64_t timestamp{0};
+  std::string line;
+  for (size_t t = 0; t < cThreads; t++) {
+    for (size_t i = 0; i < 10; i++) {
+      ASSERT_TRUE(merger.next(timestamp, line));
+      EXPECT_EQ(line, fmt_line(t, i));
+    }
+  }
+  EXPECT_FALSE(merger.next(timestamp, line));
+}
+
+TEST_F(TestShardedLogFile, LineTicks) {
+  const uint64_t ticks = qle::LogClock::now();
+  {
+    ShardedLogFile file(cPath);
+    EXPECT_TRUE(file.append("line", 4, ticks));
+  }
+
+  // The merge key is the time of the line, not of the append
+  LogShardMerger merger;
+  ASSERT_EQ(merger.open(cPath), 1U);
+  uint64_t timestamp{0};
+  std::string line;
+  ASSERT_TRUE(merger.next(timestamp, line));
+  // A calibration in between may move the conversion slightly
+  const auto expected = static_cast<int64_t>(qle::LogClock::to_ns(ticks));
+  EXPECT_LT(std::abs(static_cast<int64_t>(timestamp) - expected), 1000000);
+  EXPECT_EQ(line, "line");
+}
+
+TEST_F(TestShardedLogFile, MergeOrder) {
+  // Shards written by hand, including a line without a timestamp
+  FILE *shard = fopen((std::string(cPath) + ".0").c_str(), "w");
+  ASSERT_TRUE(shard);
+  fprintf(shard, "10 a\n30 c\ngarbage\n50 e\n");
+  fclose(shard);
+  shard = fopen((std::string(cPath) + ".1").c_str(), "w");
+  ASSERT_TRUE(shard);
+  fprintf(shard, "20 b\n40 d\n");
+  fclose(shard);
+
+  LogShardMerger merger;
+  ASSERT_EQ(merger.open(cPath), 2U);
+  std::string merged;
+  uint64_t timestamp{0};
+  std::string line;
+  while (merger.next(timestamp, line)) {
+    merged += line;
+  }
+  EXPECT_EQ(merged, "abcde");
+  EXPECT_FALSE(merger.next(timestamp, line));
+
+  LogShardMerger empty;
+  EXPECT_EQ(empty.open("/tmp/test_log_shard_missing"), 0U);
+  EXPECT_FALSE(empty.next(timestamp, line));
+}
+
+}  // namespace
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utilities/clog.h>
+#include <utilities/log_sink.h>
+#include <utilities/test_fixture.h>
+
+using LogLevel = qle::LogLevel;
+
+namespace {
+
+static const char *cLoggerName{"TestSink"};
+
+class TestLogSink : public qle::TestFixture {
+ protected:
+  static constexpr const char *cFile{"/tmp/test_log_sink.txt"};
+
+  void SetUp() override { remove(cFile); }
+
+  void TearDown() override { remove(cFile); }
+
+  /**
+   * @brief Sink taking \p delay per line
+   */
+  class SlowSink : public qle::LogSink {
+   public:
+    explicit SlowSink(std::chrono::milliseconds delay) : delay_(delay) {}
+
+    void write(LogLevel::Level, const char *, size_t) noexcept override {
+      std::this_thread::sleep_for(delay_);
+      written++;
+    }
+
+    std::atomic<size_t> written{0};
+
+   private:
+    std::chrono::milliseconds delay_;
+  };
+
+  std::mutex &mtx_ = qle::TestFixture::mtx_;
+};
+
+constexpr const char *TestLogSink::cFile;
+
+TEST_F(TestLogSink, FanOut) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  std::map<std::string, std::string> out;
+  std::vector<std::string> tail;
+  {
+    qle::LoggerConfigHandler handler(LogLevel::DEBUG);
+    auto *config = handler.get_config();
+    auto *console = config->add_sink(std::make_unique<qle::ConsoleLogSink>());
+    ASSERT_TRUE(console);
+    console->set_level(LogLevel::WARNING);
+    auto file_sink = std::make_unique<qle::FileLogSink>(cFile);
+    ASSERT_TRUE(file_sink->is_open());
+    ASSERT_TRUE(config->add_sink(std::move(file_sink)));
+    auto *memory = static_cast<qle::MemoryLogSink *>(
+        config->add_sink(std::make_unique<qle::MemoryLogSink>(2)));
+    EXPECT_EQ(config->sink_count(), 3U);
+    EXPECT_FALSE(config->add_sink(nullptr));
+
+    qle::CLogger logger(cLoggerName);
+    out = capture_output([&]() {
+      logger.debug("line {}", 1);
+      logger.info("line {}", 2);
+      logger.error("line {}", 3);
+      config->flush();
+    });
+    tail = memory->lines();
+  }
+
+  EXPECT_EQ(out["stdout"], "");
+  EXPECT_EQ(out["stderr"], fmt::format("[error] {}: line 3\n", cLoggerName));
+  std::ifstream file(cFile);
+  const std::string content((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  // Levels below QLE_LOG_ACTIVE_LEVEL are compiled out
+  const std::string debug =
+      LogLevel::is_compiled_in(LogLevel::DEBUG)
+          ? fmt::format("[debug] {}: line 1\n", cLoggerName)
+          : "";
+  EXPECT_EQ(content, debug + fmt::format("[info] {0}: line 2\n"
+                                         "[error] {0}: line 3\n",
+                                         cLoggerName));
+  ASSERT_EQ(tail.size(), 2U);
+  EXPECT_EQ(tail[0], fmt::format("[info] {}: line 2", cLoggerName));
+  EXPECT_EQ(tail[1], fmt::format("[error] {}: line 3", cLoggerName));
+}
+
+TEST_F(TestLogSink, SlowSinkDoesNotBlock) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(LogLevel::INFO);
+  auto *config = handler.get_config();
+  auto slow = std::make_unique<SlowSink>(std::chrono::milliseconds(20));
+  SlowSink *slow_sink = slow.get();
+  auto async = std::make_unique<qle::AsyncLogSink>(std::move(slow), 4);
+  ASSERT_TRUE(async->start());
+  auto *async_sink =
+      static_cast<qle::AsyncLogSink *>(config->add_sink(std::move(async)));
+  auto *memory = static_cast<qle::MemoryLogSink *>(
+      config->add_sink(std::make_unique<qle::MemoryLogSink>()));
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 100; i++) {
+    qle::LoggerConfig::write(LogLevel::INFO, "line", 4);
+  }
+  // 100 lines through the slow sink alone would take 2 s
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(1000));
+  EXPECT_EQ(memory->lines().size(), 100U);
+  EXPECT_GT(async_sink->dropped_count(), 0U);
+
+  config->flush();
+  EXPECT_EQ(slow_sink->written + async_sink->dropped_count(), 100U);
+}
+
+TEST_F(TestLogSink, AsyncLongLines) {
+  auto memory = std::make_unique<qle::MemoryLogSink>();
+  qle::MemoryLogSink *memory_sink = memory.get();
+  qle::AsyncLogSink async(std::move(memory), 4);
+  ASSERT_TRUE(async.start());
+
+  // Written whole and in order
+  const std::string long_line(qle::cMaxLogLineLength + 100, 'x');
+  async.write(LogLevel::INFO, "first", 5);
+  async.write(LogLevel::INFO, long_line.data(), long_line.size());
+  async.write(LogLevel::INFO, "last", 4);
+  async.flush();
+  EXPECT_EQ(memory_sink->lines(),
+            (std::vector<std::string>{"first", long_line, "last"}));
+}
+
+}  // namespace
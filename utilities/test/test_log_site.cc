@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <utilities/log_macros.h>
+#include <utilities/log_site.h>
+#include <utilities/test_fixture.h>
+
+namespace {
+
+static const char *cLoggerName{"TestLogSite"};
+
+/**
+ * @brief Statements under test, one site each
+ */
+void log_order(qle::CLogger &logger, int id) {
+  QLE_LOG_INFO(logger, "order {}", id);
+}
+
+void log_fill(qle::Logger &logger, int id) {
+  QLE_LOG_INFO(logger, "fill %d", id);
+}
+
+void log_error(qle::CLogger &logger, int id) {
+  QLE_LOG_ERROR(logger, "reject {}", id);
+}
+
+void log_runtime(qle::Logger &logger, const char *format, int id) {
+  QLE_LOG_INFO(logger, format, id);
+}
+
+void log_limited(qle::CLogger &logger, int id) {
+  QLE_LOG_EVERY_N(logger, INFO, 2, "limited {}", id);
+}
+
+class TestLogSite : public qle::TestFixture {
+ protected:
+  void SetUp() override { qle::LogSiteRegistry::reset(); }
+
+  void TearDown() override {
+    qle::LogSiteRegistry::reset();
+    remove(cPath);
+  }
+
+  /**
+   * @brief Get the registry dump
+   */
+  static std::string dump() {
+    FILE *file = tmpfile();
+    EXPECT_TRUE(file);
+    qle::LogSiteRegistry::dump(file);
+    rewind(file);
+    std::string text;
+    char buffer[256]{};
+    while (fgets(buffer, sizeof(buffer), file)) {
+      text += buffer;
+    }
+    fclose(file);
+    return text;
+  }
+
+  static constexpr const char *cPath{"/tmp/test_log_site.control"};
+
+  std::mutex &mtx_ = qle::TestFixture::mtx_;
+};
+
+constexpr const char *TestLogSite::cPath;
+
+TEST_F(TestLogSite, EnrollOnce) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::WARNING);
+  qle::CLogger clogger(cLoggerName);
+
+  log_order(clogger, 1);
+  const size_t size = qle::LogSiteRegistry::size();
+  log_order(clogger, 2);
+  EXPECT_EQ(qle::LogSiteRegistry::size(), size);
+
+  const std::string text = dump();
+  EXPECT_NE(text.find("test_log_site.cc:"), std::string::npos);
+  EXPECT_NE(text.find("[log_order] info == \"order {}\""), std::string::npos);
+}
+
+TEST_F(TestLogSite, ToggleSites) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::WARNING);
+  qle::CLogger clogger(cLoggerName);
+  qle::Logger logger(cLoggerName);
+  log_order(clogger, 0);
+  log_fill(logger, 0);
+  log_error(clogger, 0);
+
+  size_t matched{0};
+  EXPECT_TRUE(qle::LogSiteRegistry::apply("func log_order +", &matched));
+  EXPECT_EQ(matched, 1U);
+  EXPECT_TRUE(qle::LogSiteRegistry::apply("file test_log_site.cc format "
+                                          "fill +"));
+  EXPECT_TRUE(qle::LogSiteRegistry::apply("file */test_log_site.cc "
+                                          "func log_error -"));
+  auto out = capture_output([&]() {
+    log_order(clogger, 1);
+    log_fill(logger, 2);
+    log_error(clogger, 3);
+  });
+  EXPECT_EQ(out["stdout"], fmt::format("[info] {0}: order 1\n"
+                                       "[info] {0}: fill 2\n",
+                                       cLoggerName));
+  EXPECT_EQ(out["stderr"], "");
+
+  // Back to the logger level
+  EXPECT_TRUE(qle::LogSiteRegistry::apply("file test_log_site.cc =", &matched));
+  EXPECT_GE(matched, 3U);
+  out = capture_output([&]() {
+    log_order(clogger, 4);
+    log_error(clogger, 5);
+  });
+  EXPECT_EQ(out["stdout"], "");
+  EXPECT_EQ(out["stderr"], fmt::format("[error] {}: reject 5\n", cLoggerName));
+}
+
+TEST_F(TestLogSite, RulesApplyToLaterSites) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::WARNING);
+  qle::CLogger clogger(cLoggerName);
+
+  // The site below is enrolled by its first call, after the rule
+  size_t matched{0};
+  EXPECT_TRUE(qle::LogSiteRegistry::apply("format later +", &matched));
+  EXPECT_EQ(matched, 0U);
+  auto out = capture_output([&]() {
+    for (int id = 0; id < 2; id++) {
+      QLE_LOG_INFO(clogger, "later {}", id);
+    }
+  });
+  EXPECT_EQ(out["stdout"], fmt::format("[info] {0}: later 0\n"
+                                       "[info] {0}: later 1\n",
+                                       cLoggerName));
+}
+
+TEST_F(TestLogSite, RuntimeFormatCopied) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::WARNING);
+  qle::Logger logger(cLoggerName);
+  {
+    std::string format("runtime %d");
+    log_runtime(logger, format.c_str(), 1);
+    format.assign(format.size(), '?');
+  }
+  EXPECT_NE(dump().find("[log_runtime] info == \"runtime %d\""),
+            std::string::npos);
+
+  size_t matched{0};
+  EXPECT_TRUE(qle::LogSiteRegistry::apply("format runtime +", &matched));
+  EXPECT_EQ(matched, 1U);
+}
+
+TEST_F(TestLogSite, ToggleRateLimitedSites) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::WARNING);
+  qle::CLogger clogger(cLoggerName);
+  log_limited(clogger, 0);
+  EXPECT_NE(dump().find("[log_limited] info == \"limited {}\""),
+            std::string::npos);
+
+  // Enabled below the logger level, still one line in 2
+  EXPECT_TRUE(qle::LogSiteRegistry::apply("func log_limited +"));
+  auto out = capture_output([&]() {
+    for (int id = 1; id <= 4; id++) {
+      log_limited(clogger, id);
+    }
+  });
+  EXPECT_EQ(out["stdout"], fmt::format("[info] {0}: limited 1\n"
+                                       "[info] {0}: limited 3\n",
+                                       cLoggerName));
+
+  handler.get_config()->set_loglevel(qle::LogLevel::INFO);
+  EXPECT_TRUE(qle::LogSiteRegistry::apply("func log_limited -"));
+  out = capture_output([&]() { log_limited(clogger, 5); });
+  EXPECT_EQ(out["stdout"], "");
+}
+
+TEST_F(TestLogSite, InvalidRules) {
+  EXPECT_FALSE(qle::LogSiteRegistry::apply(nullptr));
+  EXPECT_FALSE(qle::LogSiteRegistry::apply(""));
+  EXPECT_FALSE(qle::LogSiteRegistry::apply("file"));
+  EXPECT_FALSE(qle::LogSiteRegistry::apply("file a.cc"));
+  EXPECT_FALSE(qle::LogSiteRegistry::apply("file a.cc ?"));
+  EXPECT_FALSE(qle::LogSiteRegistry::apply("level debug +"));
+  EXPECT_FALSE(qle::LogSiteRegistry::apply("line 20-10 +"));
+  EXPECT_FALSE(qle::LogSiteRegistry::apply("line x +"));
+  EXPECT_TRUE(qle::LogSiteRegistry::apply("line 10-20 -"));
+  EXPECT_TRUE(qle::LogSiteRegistry::apply("="));
+}
+
+TEST_F(TestLogSite, WatchControlFile) {
+  std::lock_guard<std::mutex> guard(mtx_);
+
+  qle::LoggerConfigHandler handler(qle::LogLevel::WARNING);
+  qle::CLogger clogger(cLoggerName);
+  {
+    std::ofstream file(cPath);
+    file << "# enable orders\n\nfunc log_order +\n";
+  }
+  auto watcher = std::make_unique<qle::LogSiteWatcher>(cPath, 10);
+  watcher->start();
+  EXPECT_EQ(watcher->reload_count(), 1U);
+
+  auto out = capture_output([&]() { log_order(clogger, 1); });
+  EXPECT_EQ(out["stdout"], fmt::format("[info] {}: order 1\n", cLoggerName));
+
+  // A change replaces all rules
+  {
+    std::ofstream file(cPath);
+    file << "func log_error -\n";
+  }
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while ((watcher->reload_count() < 2) &&
+         (std::chrono::steady_clock::now() < deadline)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(watcher->reload_count(), 2U);
+  watcher.reset();
+
+  out = capture_output([&]() {
+    log_order(clogger, 2);
+    log_error(clogger, 3);
+  });
+  EXPECT_EQ(out["stdout"], "");
+  EXPECT_EQ(out["stderr"], "");
+}
+
+}  // namespace
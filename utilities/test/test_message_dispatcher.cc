@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <utilities/message_dispatcher.h>
+
+namespace {
+
+/// Handler state shared by all handlers
+struct Session {
+  std::vector<uint8_t> heartbeats;
+  std::vector<uint32_t> orders;
+  size_t payload_size{0};
+};
+
+struct HeartbeatHandler {
+  static constexpr uint8_t cType{0x01};
+  static void handle(Session &session, qle::ByteReader<> payload) {
+    uint8_t seq{0};
+    if (payload.get(seq)) {
+      session.heartbeats.push_back(seq);
+    }
+  }
+};
+
+struct OrderHandler {
+  static constexpr uint8_t cType{0x10};
+  static void handle(Session &session, qle::ByteReader<> payload) {
+    session.payload_size = payload.remaining();
+    uint32_t order_id{0};
+    if (payload.get(order_id)) {
+      session.orders.push_back(order_id);
+    }
+  }
+};
+
+struct LastHandler {
+  static constexpr uint8_t cType{0xFF};
+  static void handle(Session &, qle::ByteReader<>) {}
+};
+
+using Dispatcher = qle::MessageDispatcher<Session, qle::Endianess::BIG_END,
+                                          HeartbeatHandler, OrderHandler,
+                                          LastHandler>;
+
+class TestMessageDispatcher : public ::testing::Test {};
+
+TEST_F(TestMessageDispatcher, TestRouting) {
+  static_assert(Dispatcher::is_handled(0x01), "");
+  static_assert(Dispatcher::is_handled(0x10), "");
+  static_assert(Dispatcher::is_handled(0xFF), "");
+  static_assert(!Dispatcher::is_handled(0x02), "");
+
+  Dispatcher dispatcher;
+  Session session;
+
+  uint8_t heartbeat[]{0x01, 0x07};
+  qle::ByteReader<> reader(heartbeat, sizeof(heartbeat));
+  ASSERT_TRUE(dispatcher.dispatch(session, reader));
+  ASSERT_TRUE(reader.empty());
+
+  uint8_t order[]{0x10, 0x00, 0x00, 0x12, 0x34, 0xEE};
+  reader = qle::ByteReader<>(order, sizeof(order));
+  ASSERT_TRUE(dispatcher.dispatch(session, reader));
+
+  ASSERT_EQ(session.heartbeats.size(), 1U);
+  EXPECT_EQ(session.heartbeats[0], 0x07);
+  ASSERT_EQ(session.orders.size(), 1U);
+  EXPECT_EQ(session.orders[0], 0x1234U);
+  EXPECT_EQ(session.payload_size, sizeof(order) - 1);
+
+  // Empty message has no type byte
+  reader = qle::ByteReader<>();
+  ASSERT_FALSE(dispatcher.dispatch(session, reader));
+}
+
+TEST_F(TestMessageDispatcher, TestCounters) {
+  Dispatcher dispatcher;
+  Session session;
+
+  uint8_t seq{0};
+  for (size_t i = 0; i < 5; i++) {
+    dispatcher.dispatch(session, 0x01, qle::ByteReader<>(&seq, 1));
+  }
+  dispatcher.dispatch(session, 0x10, qle::ByteReader<>());
+  dispatcher.dispatch(session, 0x02, qle::ByteReader<>());  // Unhandled
+  dispatcher.dispatch(session, 0x03, qle::ByteReader<>());  // Unhandled
+
+  EXPECT_EQ(dispatcher.count(0x01), 5U);
+  EXPECT_EQ(dispatcher.count(0x10), 1U);
+  EXPECT_EQ(dispatcher.count(0x02), 1U);
+  EXPECT_EQ(dispatcher.unhandled_count(), 2U);
+  EXPECT_EQ(session.heartbeats.size(), 5U);
+  EXPECT_TRUE(session.orders.empty());  // Payload too short
+
+  dispatcher.reset_counters();
+  EXPECT_EQ(dispatcher.count(0x01), 0U);
+  EXPECT_EQ(dispatcher.unhandled_count(), 0U);
+}
+
+}  // namespace
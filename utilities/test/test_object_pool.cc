@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utilities/object_pool.h>
+
+namespace {
+
+/**
+ * @brief Object counting its live instances
+ */
+struct Message {
+  static std::atomic<int> live;
+
+  explicit Message(int id) : id(id) { live++; }
+  ~Message() { live--; }
+
+  int id;
+  std::string text{"payload"};
+};
+
+std::atomic<int> Message::live{0};
+
+using MessagePool = qle::ObjectPool<Message, 8>;
+
+class TestObjectPool : public ::testing::Test {
+ protected:
+  void SetUp() override { Message::live = 0; }
+};
+
+TEST_F(TestObjectPool, TestCreateDestroy) {
+  MessagePool pool(16);
+  ASSERT_TRUE(pool.valid());
+  EXPECT_EQ(pool.capacity(), 16U);
+
+  Message *msg = pool.create(42);
+  ASSERT_NE(msg, nullptr);
+  EXPECT_EQ(msg->id, 42);
+  EXPECT_EQ(Message::live, 1);
+
+  pool.destroy(msg);
+  EXPECT_EQ(Message::live, 0);
+  pool.destroy(nullptr);
+
+  {
+    auto ptr = pool.make(7);
+    ASSERT_TRUE(ptr);
+    EXPECT_EQ(ptr->id, 7);
+    EXPECT_EQ(Message::live, 1);
+  }
+  EXPECT_EQ(Message::live, 0);
+}
+
+TEST_F(TestObjectPool, TestRecyclingAndStatistics) {
+  MessagePool pool(16);
+
+  // First creation refills the magazine from the global list
+  Message *first = pool.create(1);
+  EXPECT_EQ(pool.miss_count(), 1U);
+  pool.destroy(first);
+
+  // The slot is served again from the magazine
+  Message *second = pool.create(2);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(pool.hit_count(), 1U);
+  pool.destroy(second);
+}
+
+TEST_F(TestObjectPool, TestExhaustion) {
+  MessagePool pool(4);
+  std::vector<Message *> msgs;
+  for (int i = 0; i < 4; i++) {
+    msgs.push_back(pool.create(i));
+    ASSERT_NE(msgs.back(), nullptr);
+  }
+  EXPECT_EQ(pool.create(4), nullptr);
+  EXPECT_FALSE(pool.make(4));
+  EXPECT_EQ(pool.exhausted_count(), 2U);
+
+  for (auto *msg : msgs) {
+    pool.destroy(msg);
+  }
+  EXPECT_NE(pool.make(5), nullptr);
+}
+
+TEST_F(TestObjectPool, TestCrossThreadRelease) {
+  static constexpr int cCount{20000};
+  static constexpr size_t cCapacity{64};
+  MessagePool pool(cCapacity);
+
+  std::atomic<Message *> queue[cCapacity];
+  for (auto &entry : queue) {
+    entry = nullptr;
+  }
+
+  // Producer creates objects, consumer destroys them
+  std::thread producer([&] {
+    for (int i = 0; i < cCount; i++) {
+      Message *msg{nullptr};
+      while (!(msg = pool.create(i))) {
+        std::this_thread::yield();
+      }
+      auto &entry = queue[i % cCapacity];
+      while (entry.load() != nullptr) {
+        std::this_thread::yield();
+      }
+      entry.store(msg);
+    }
+  });
+
+  int sum_ok{0};
+  std::thread consumer([&] {
+    for (int i = 0; i < cCount; i++) {
+      auto &entry = queue[i % cCapacity];
+      Message *msg{nullptr};
+      while (!(msg = entry.load())) {
+        std::this_thread::yield();
+      }
+      entry.store(nullptr);
+      sum_ok += (msg->id == i) ? 1 : 0;
+      pool.destroy(msg);
+    }
+  });
+
+  producer.join();
+  consumer.join();
+  EXPECT_EQ(sum_ok, cCount);
+  EXPECT_EQ(Message::live, 0);
+  EXPECT_EQ(pool.hit_count() + pool.miss_count(),
+            static_cast<uint64_t>(cCount));
+}
+
+TEST_F(TestObjectPool, TestFreedByOtherThread) {
+  // Fewer objects than a magazine holds, all freed by a thread that exits
+  static constexpr size_t cCapacity{16};
+  qle::ObjectPool<Message> pool(cCapacity);
+  std::vector<Message *> msgs;
+  for (int round = 0; round < 3; round++) {
+    for (size_t i = 0; i < cCapacity; i++) {
+      msgs.push_back(pool.create(static_cast<int>(i)));
+      ASSERT_NE(msgs.back(), nullptr);
+    }
+    std::thread consumer([&] {
+      for (auto *msg : msgs) {
+        pool.destroy(msg);
+      }
+    });
+    consumer.join();
+    msgs.clear();
+  }
+  EXPECT_EQ(pool.exhausted_count(), 0U);
+  EXPECT_EQ(Message::live, 0);
+}
+
+TEST_F(TestObjectPool, TestSmallPoolProducerConsumer) {
+  static constexpr int cCount{20000};
+  MessagePool pool(4);
+
+  // The consumer stays alive and frees the objects one at a time, fewer
+  // than fill its magazine
+  std::atomic<Message *> handoff{nullptr};
+  std::atomic<bool> done{false};
+  std::thread consumer([&] {
+    while (!done.load() || handoff.load()) {
+      Message *msg = handoff.exchange(nullptr);
+      if (msg) {
+        pool.destroy(msg);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int created{0};
+  for (int i = 0; i < cCount; i++) {
+    Message *msg = pool.create(i);
+    if (!msg) {
+      break;
+    }
+    created++;
+    while (handoff.load() != nullptr) {
+      std::this_thread::yield();
+    }
+    handoff.store(msg);
+  }
+  done.store(true);
+  consumer.join();
+  EXPECT_EQ(created, cCount);
+  EXPECT_EQ(pool.exhausted_count(), 0U);
+  EXPECT_EQ(Message::live, 0);
+}
+
+}  // namespace
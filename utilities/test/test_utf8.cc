@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <utilities/bytestream.h>
+#include <utilities/utf8.h>
+
+using Utf8Validator = qle::Utf8Validator;
+
+namespace {
+
+class TestUtf8 : public ::testing::Test {
+ protected:
+  /**
+   * @brief Assert all implementations agree on \p expected for \p str
+   *
+   * @param str Input bytes
+   * @param expected Expected validity
+   */
+  void assert_valid(const std::string &str, bool expected) {
+    const auto *data = reinterpret_cast<const uint8_t *>(str.data());
+    EXPECT_EQ(Utf8Validator::is_valid_scalar(data, str.size()), expected)
+        << "scalar: " << to_hex(str);
+    EXPECT_EQ(Utf8Validator::is_valid(data, str.size()), expected)
+        << "dispatch: " << to_hex(str);
+    if (Utf8Validator::avx2_supported()) {
+      EXPECT_EQ(Utf8Validator::is_valid_avx2(data, str.size()), expected)
+          << "avx2: " << to_hex(str);
+    }
+  }
+
+  /**
+   * @brief Hex dump for failure messages
+   */
+  static std::string to_hex(const std::string &str) {
+    std::string out;
+    char buff[4]{};
+    for (auto c : str) {
+      snprintf(buff, sizeof(buff), "%02X ", static_cast<uint8_t>(c));
+      out += buff;
+    }
+    return out;
+  }
+};
+
+TEST_F(TestUtf8, TestValidSequences) {
+  assert_valid("", true);
+  assert_valid("Sample text", true);
+  assert_valid("\x7F", true);
+  assert_valid("\xC2\x80", true);          // U+0080
+  assert_valid("\xDF\xBF", true);          // U+07FF
+  assert_valid("\xE0\xA0\x80", true);      // U+0800
+  assert_valid("\xED\x9F\xBF", true);      // U+D7FF
+  assert_valid("\xEE\x80\x80", true);      // U+E000
+  assert_valid("\xEF\xBF\xBF", true);      // U+FFFF
+  assert_valid("\xF0\x90\x80\x80", true);  // U+10000
+  assert_valid("\xF4\x8F\xBF\xBF", true);  // U+10FFFF
+}
+
+TEST_F(TestUtf8, TestInvalidSequences) {
+  assert_valid("\x80", false);              // Lone continuation
+  assert_valid("\xC0\x80", false);          // Overlong 2 bytes
+  assert_valid("\xC1\xBF", false);          // Overlong 2 bytes
+  assert_valid("\xE0\x9F\xBF", false);      // Overlong 3 bytes
+  assert_valid("\xED\xA0\x80", false);      // Surrogate U+D800
+  assert_valid("\xED\xBF\xBF", false);      // Surrogate U+DFFF
+  assert_valid("\xF0\x8F\xBF\xBF", false);  // Overlong 4 bytes
+  assert_valid("\xF4\x90\x80\x80", false);  // U+110000
+  assert_valid("\xF5\x80\x80\x80", false);  // Invalid lead byte
+  assert_valid("\xFF", false);              // Invalid lead byte
+  assert_valid("\xC2", false);              // Truncated
+  assert_valid("\xE0\xA0", false);          // Truncated
+  assert_valid("\xF0\x90\x80", false);      // Truncated
+  assert_valid("\xC2\x41", false);          // Missing continuation
+  assert_valid("\xE0\xA0\x80\x80", false);  // Too long
+}
+
+TEST_F(TestUtf8, TestBlockBoundaries) {
+  // Place sequences across every offset of the 32-byte AVX2 blocks
+  const std::vector<std::string> valid{"\xC2\x80", "\xE0\xA0\x80",
+                                       "\xF0\x90\x80\x80"};
+  const std::vector<std::string> invalid{"\xED\xA0\x80", "\xC2",
+                                         "\xF4\x90\x80\x80", "\x80"};
+  for (size_t offset = 0; offset < 70; offset++) {
+    for (const auto &seq : valid) {
+      assert_valid(std::string(offset, 'a') + seq, true);
+      assert_valid(std::string(offset, 'a') + seq + std::string(40, 'b'),
+                   true);
+    }
+    for (const auto &seq : invalid) {
+      assert_valid(std::string(offset, 'a') + seq, false);
+      assert_valid(std::string(offset, 'a') + seq + std::string(40, 'b'),
+                   false);
+    }
+  }
+}
+
+TEST_F(TestUtf8, TestRandomAgainstScalar) {
+  if (!Utf8Validator::avx2_supported()) {
+    GTEST_SKIP() << "AVX2 not supported";
+  }
+
+  std::mt19937 rng(42);
+  const std::vector<std::string> pieces{
+      "a",        "Sample ", "\xC2\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80",
+      "\xED\xA0", "\x80",    "\xF8",     "\xC0\xAF",     "\xF4\x90"};
+  for (size_t round = 0; round < 2000; round++) {
+    std::string str;
+    const size_t count = rng() % 40;
+    for (size_t i = 0; i < count; i++) {
+      // Mostly valid pieces, occasionally a broken one
+      str += pieces[(rng() % 8 == 0) ? rng() % pieces.size() : rng() % 5];
+    }
+    const auto *data = reinterpret_cast<const uint8_t *>(str.data());
+    ASSERT_EQ(Utf8Validator::is_valid_avx2(data, str.size()),
+              Utf8Validator::is_valid_scalar(data, str.size()))
+        << to_hex(str);
+  }
+}
+
+TEST_F(TestUtf8, TestBytestreamView) {
+  // [length:1][utf-8 string:length][length:1][utf-8 string:length]
+  uint8_t buffer[]{0x05, 'h', 0xC3, 0xA9, 'l', 'o', 0x02, 0xC3, 0x28};
+  qle::Bytestream bs(buffer, sizeof(buffer));
+
+  uint8_t len{0};
+  const uint8_t *str{nullptr};
+  ASSERT_TRUE(bs.get(len));
+  ASSERT_TRUE(bs.get_bytes(str, len));
+  EXPECT_EQ(str, &buffer[1]);
+  EXPECT_TRUE(Utf8Validator::is_valid(str, len));
+
+  qle::Span<const uint8_t> view;
+  ASSERT_TRUE(bs.get(len));
+  ASSERT_TRUE(bs.get_bytes(view, len));
+  EXPECT_EQ(view.Data(), &buffer[7]);
+  EXPECT_FALSE(Utf8Validator::is_valid(view));
+
+  ASSERT_FALSE(bs.get_bytes(str, 1));
+}
+
+}  // namespace
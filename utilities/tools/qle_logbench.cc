@@ -0,0 +1,354 @@
+#include <utilities/clog.h>
+#include <utilities/log.h>
+
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Logger benchmarked
+ */
+enum class Frontend { LOGGER, CLOGGER };
+
+/**
+ * @brief Output of the enabled lines
+ */
+enum class Sink { STDOUT, FILE, ASYNC, MAPPED, SHARDED };
+
+static constexpr Sink cSinks[]{Sink::STDOUT, Sink::FILE, Sink::ASYNC,
+                               Sink::MAPPED, Sink::SHARDED};
+
+static const char *cLoggerName{"qle-logbench"};
+
+/**
+ * @brief Benchmark options
+ */
+struct Options {
+  size_t max_threads{4};          ///< Producer threads, 1 to max_threads
+  size_t calls{100000};           ///< Calls per thread
+  std::string directory{"/tmp"};  ///< Directory of the file sinks
+  const char *output{nullptr};    ///< JSON output, nullptr for stdout
+};
+
+/**
+ * @brief Result of one case
+ */
+struct Result {
+  Frontend frontend;  ///< Logger benchmarked
+  Sink sink;          ///< Output
+  bool enabled;       ///< Level enabled
+  size_t threads;     ///< Producer threads
+  size_t calls;       ///< Total calls
+  double seconds;     ///< Time until the last producer returned
+  uint64_t p50_ns;    ///< Median call latency
+  uint64_t p99_ns;    ///< 99th percentile call latency
+  uint64_t p999_ns;   ///< 99.9th percentile call latency
+  uint64_t max_ns;    ///< Worst call latency
+};
+
+const char *to_string(Frontend frontend) {
+  return (frontend == Frontend::LOGGER) ? "Logger" : "CLogger";
+}
+
+const char *to_string(Sink sink) {
+  switch (sink) {
+    case Sink::STDOUT:
+      return "stdout";
+    case Sink::FILE:
+      return "file";
+    case Sink::ASYNC:
+      return "async";
+    case Sink::MAPPED:
+      return "mapped";
+    case Sink::SHARDED:
+      return "sharded";
+    default:
+      return "";
+  }
+}
+
+/**
+ * @brief Print usage to stderr
+ */
+void usage(const char *program) {
+  fmt::print(stderr,
+             "Usage: {} [--threads N] [--calls N] [--dir DIR] [--output "
+             "FILE]\n"
+             "Measure Logger and CLogger call latency and throughput.\n"
+             "  --threads N    Run 1 to N producer threads (default 4)\n"
+             "  --calls N      Calls per thread (default 100000)\n"
+             "  --dir DIR      Directory of the file sinks (default /tmp)\n"
+             "  --output FILE  Write the JSON report to FILE, not stdout\n",
+             program);
+}
+
+/**
+ * @brief Parse a positive number
+ *
+ * @return bool false if invalid
+ */
+bool parse_count(const char *text, size_t &value) {
+  char *end{nullptr};
+  const unsigned long long parsed = strtoull(text, &end, 10);
+  if ((end == text) || (*end != '\0') || (parsed == 0)) {
+    return false;
+  }
+  value = static_cast<size_t>(parsed);
+  return true;
+}
+
+/**
+ * @brief Remove "<path>" and "<path>.0", "<path>.1", ...
+ */
+void remove_files(const std::string &path) {
+  unlink(path.c_str());
+  for (size_t i = 0; unlink((path + "." + std::to_string(i)).c_str()) == 0;
+       i++) {
+  }
+}
+
+/**
+ * @brief Configure the logger for one case
+ *
+ * @return bool false if the sink could not be opened
+ */
+bool configure(Sink sink, bool enabled, const std::string &path) {
+  const auto level = enabled ? qle::LogLevel::INFO : qle::LogLevel::WARNING;
+  const bool file = (sink == Sink::FILE) || (sink == Sink::ASYNC);
+  qle::LoggerConfig *config =
+      qle::LoggerConfig::create(level, file ? path.c_str() : nullptr);
+  if (!config) {
+    return false;
+  }
+  switch (sink) {
+    case Sink::FILE:
+      return qle::LoggerConfig::logfile() != nullptr;
+    case Sink::ASYNC:
+      return (qle::LoggerConfig::logfile() != nullptr) &&
+             config->start_async();
+    case Sink::MAPPED:
+      return config->open_mapped_file(path.c_str());
+    case Sink::SHARDED:
+      return config->open_sharded_file(path.c_str());
+    default:
+      return true;
+  }
+}
+
+/**
+ * @brief Log \p calls info lines, timing each call
+ *
+ * @param latencies Output latency of each call in nanoseconds
+ */
+void produce(Frontend frontend, size_t calls,
+             std::vector<uint64_t> &latencies) {
+  qle::Logger logger(cLoggerName);
+  qle::CLogger clogger(cLoggerName);
+  for (size_t i = 0; i < calls; i++) {
+    const auto start = Clock::now();
+    if (frontend == Frontend::LOGGER) {
+      logger.info("benchmark line %zu of %s: %.3f", i, cLoggerName, 1.5);
+    } else {
+      clogger.info("benchmark line {} of {}: {:.3f}", i, cLoggerName, 1.5);
+    }
+    const auto end = Clock::now();
+    latencies[i] = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count());
+  }
+}
+
+/**
+ * @brief Get the latency below which \p fraction of the calls fall
+ *
+ * @param sorted Latencies, sorted
+ */
+uint64_t percentile(const std::vector<uint64_t> &sorted, double fraction) {
+  const auto index = static_cast<size_t>(fraction * (sorted.size() - 1));
+  return sorted[index];
+}
+
+/**
+ * @brief Measure the median cost of the two clock reads around a call
+ *
+ * @return uint64_t Nanoseconds included in every latency
+ */
+uint64_t timer_overhead() {
+  std::vector<uint64_t> samples(10000);
+  for (auto &sample : samples) {
+    const auto start = Clock::now();
+    const auto end = Clock::now();
+    sample = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count());
+  }
+  std::sort(samples.begin(), samples.end());
+  return percentile(samples, 0.5);
+}
+
+/**
+ * @brief Run one case with \p threads producers started together
+ */
+bool run(Frontend frontend, Sink sink, bool enabled, size_t threads,
+         const Options &options, Result &result) {
+  const std::string path =
+      options.directory + "/qle-logbench-" + to_string(sink) + ".log";
+  remove_files(path);
+
+  // Lines meant for stdout go to /dev/null; the report keeps its own fd
+  fflush(stdout);
+  const int saved_stdout = dup(STDOUT_FILENO);
+  const int null_fd = open("/dev/null", O_WRONLY);
+  dup2(null_fd, STDOUT_FILENO);
+  close(null_fd);
+
+  bool configured = configure(sink, enabled, path);
+  std::vector<std::vector<uint64_t>> latencies(
+      threads, std::vector<uint64_t>(options.calls));
+  std::vector<Clock::time_point> ends(threads);
+  std::atomic<size_t> ready{0};
+  std::atomic<bool> go{false};
+  Clock::time_point start;
+  if (configured) {
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < threads; t++) {
+      producers.emplace_back([&, t]() {
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) {
+          std::this_thread::yield();
+        }
+        produce(frontend, options.calls, latencies[t]);
+        ends[t] = Clock::now();
+      });
+    }
+    while (ready.load() < threads) {
+      std::this_thread::yield();
+    }
+    start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto &producer : producers) {
+      producer.join();
+    }
+  }
+  qle::LoggerConfig::destroy();
+
+  fflush(stdout);
+  dup2(saved_stdout, STDOUT_FILENO);
+  close(saved_stdout);
+  remove_files(path);
+  if (!configured) {
+    return false;
+  }
+
+  std::vector<uint64_t> all;
+  all.reserve(threads * options.calls);
+  for (const auto &thread_latencies : latencies) {
+    all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+  const auto last_end = *std::max_element(ends.begin(), ends.end());
+
+  result.frontend = frontend;
+  result.sink = sink;
+  result.enabled = enabled;
+  result.threads = threads;
+  result.calls = all.size();
+  result.seconds = std::chrono::duration<double>(last_end - start).count();
+  result.p50_ns = percentile(all, 0.5);
+  result.p99_ns = percentile(all, 0.99);
+  result.p999_ns = percentile(all, 0.999);
+  result.max_ns = all.back();
+  return true;
+}
+
+/**
+ * @brief Write the results as a JSON document
+ */
+void report(FILE *stream, const Options &options,
+            const std::vector<Result> &results) {
+  fmt::print(stream,
+             "{{\n  \"calls_per_thread\": {},\n  \"timer_overhead_ns\": {},"
+             "\n  \"results\": [",
+             options.calls, timer_overhead());
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &result = results[i];
+    const double throughput =
+        (result.seconds > 0) ? result.calls / result.seconds : 0;
+    fmt::print(stream,
+               "{}\n    {{\"logger\": \"{}\", \"sink\": \"{}\", "
+               "\"level\": \"{}\", \"threads\": {}, \"calls\": {}, "
+               "\"seconds\": {:.6f}, \"calls_per_second\": {:.0f}, "
+               "\"p50_ns\": {}, \"p99_ns\": {}, \"p999_ns\": {}, "
+               "\"max_ns\": {}}}",
+               (i == 0) ? "" : ",", to_string(result.frontend),
+               to_string(result.sink),
+               result.enabled ? "enabled" : "disabled", result.threads,
+               result.calls, result.seconds, throughput, result.p50_ns,
+               result.p99_ns, result.p999_ns, result.max_ns);
+  }
+  fmt::print(stream, "\n  ]\n}}\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = (i + 1 < argc);
+    if ((strcmp(argv[i], "--threads") == 0) && has_value &&
+        parse_count(argv[i + 1], options.max_threads)) {
+      i++;
+    } else if ((strcmp(argv[i], "--calls") == 0) && has_value &&
+               parse_count(argv[i + 1], options.calls)) {
+      i++;
+    } else if ((strcmp(argv[i], "--dir") == 0) && has_value) {
+      options.directory = argv[++i];
+    } else if ((strcmp(argv[i], "--output") == 0) && has_value) {
+      options.output = argv[++i];
+    } else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<Result> results;
+  for (const Frontend frontend : {Frontend::LOGGER, Frontend::CLOGGER}) {
+    for (const Sink sink : cSinks) {
+      for (const bool enabled : {false, true}) {
+        for (size_t threads = 1; threads <= options.max_threads; threads++) {
+          Result result{};
+          if (!run(frontend, sink, enabled, threads, options, result)) {
+            fmt::print(stderr, "Cannot open the {} sink in {}\n",
+                       to_string(sink), options.directory);
+            return EXIT_FAILURE;
+          }
+          results.push_back(result);
+        }
+      }
+    }
+  }
+
+  FILE *stream = options.output ? fopen(options.output, "w") : stdout;
+  if (!stream) {
+    fmt::print(stderr, "Cannot open \"{}\"\n", options.output);
+    return EXIT_FAILURE;
+  }
+  report(stream, options, results);
+  if (stream != stdout) {
+    fclose(stream);
+  }
+  return EXIT_SUCCESS;
+}
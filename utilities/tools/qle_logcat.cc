@@ -0,0 +1,102 @@
+#include <utilities/binary_log.h>
+
+#include <fmt/format.h>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+/**
+ * @brief Print usage to stderr
+ */
+void usage(const char *program) {
+  fmt::print(stderr,
+             "Usage: {} [--from NS] [--to NS] [--level LEVEL] [--stats] FILE\n"
+             "Render a binary log file as text.\n"
+             "  --from NS      Skip records before NS nanoseconds since epoch\n"
+             "  --to NS        Skip records after NS nanoseconds since epoch\n"
+             "  --level LEVEL  Skip records below trace, debug, info, warn or "
+             "error\n"
+             "  --stats        Print number of blocks read and skipped\n",
+             program);
+}
+
+/**
+ * @brief Parse a level name as printed in log lines
+ *
+ * @return bool false if unknown
+ */
+bool parse_level(const char *name, qle::LogLevel::Level &level) {
+  for (int i = qle::LogLevel::TRACE; i < qle::LogLevel::DISABLED; i++) {
+    const auto candidate = static_cast<qle::LogLevel::Level>(i);
+    if (strcmp(name, qle::LogLevel::log_level_to_string(candidate)) == 0) {
+      level = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Print a record as "YYYY-MM-DD HH:MM:SS.nnnnnnnnn [level] name: msg"
+ */
+void print_record(const qle::BinaryLogRecord &record) {
+  const auto seconds = static_cast<time_t>(record.timestamp / 1000000000ULL);
+  struct tm utc {};
+  gmtime_r(&seconds, &utc);
+  char date[32]{};
+  strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &utc);
+  fmt::print("{}.{:09} [{}] {}: {}\n", date,
+             record.timestamp % 1000000000ULL,
+             qle::LogLevel::log_level_to_string(record.level), record.logger,
+             record.message);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  qle::BinaryLogFilter filter;
+  bool stats{false};
+  const char *path{nullptr};
+
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = (i + 1 < argc);
+    if ((strcmp(argv[i], "--from") == 0) && has_value) {
+      filter.from = strtoull(argv[++i], nullptr, 10);
+    } else if ((strcmp(argv[i], "--to") == 0) && has_value) {
+      filter.to = strtoull(argv[++i], nullptr, 10);
+    } else if ((strcmp(argv[i], "--level") == 0) && has_value) {
+      if (!parse_level(argv[++i], filter.min_level)) {
+        fmt::print(stderr, "Unknown level \"{}\"\n", argv[i]);
+        return EXIT_FAILURE;
+      }
+    } else if (strcmp(argv[i], "--stats") == 0) {
+      stats = true;
+    } else if ((argv[i][0] != '-') && !path) {
+      path = argv[i];
+    } else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (!path) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  qle::BinaryLogReader reader(filter);
+  if (!reader.open(path)) {
+    fmt::print(stderr, "Cannot read binary log file \"{}\"\n", path);
+    return EXIT_FAILURE;
+  }
+  qle::BinaryLogRecord record;
+  while (reader.next(record)) {
+    print_record(record);
+  }
+  if (stats) {
+    fmt::print(stderr, "Blocks read: {}, skipped: {}\n", reader.blocks_read(),
+               reader.blocks_skipped());
+  }
+  return EXIT_SUCCESS;
+}
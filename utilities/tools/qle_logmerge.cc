@@ -0,0 +1,57 @@
+#include <utilities/log_shard.h>
+
+#include <fmt/format.h>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief Print usage to stderr
+ */
+void usage(const char *program) {
+  fmt::print(stderr,
+             "Usage: {} [--timestamps] PATH\n"
+             "Merge the shards PATH.0, PATH.1, ... of a sharded log file by "
+             "timestamp.\n"
+             "  --timestamps  Keep the nanosecond timestamp of each line\n",
+             program);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  bool timestamps{false};
+  const char *path{nullptr};
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--timestamps") == 0) {
+      timestamps = true;
+    } else if ((argv[i][0] != '-') && !path) {
+      path = argv[i];
+    } else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (!path) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  qle::LogShardMerger merger;
+  if (merger.open(path) == 0) {
+    fmt::print(stderr, "No shard \"{}.0\"\n", path);
+    return EXIT_FAILURE;
+  }
+  uint64_t timestamp{0};
+  std::string line;
+  while (merger.next(timestamp, line)) {
+    if (timestamps) {
+      fmt::print("{} {}\n", timestamp, line);
+    } else {
+      fmt::print("{}\n", line);
+    }
+  }
+  return EXIT_SUCCESS;
+}